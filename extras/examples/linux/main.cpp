@@ -83,6 +83,8 @@
 #include <supla/uptime.h>
 
 #include <linux_mqtt_client.h>
+#include <linux_event_loop.h>
+#include <supla/source/file_watcher.h>
 
 #include <cstdlib>
 #include <iostream>
@@ -181,6 +183,7 @@ int main(int argc, char* argv[]) {
     }
 
     Supla::LinuxFileStorage storage(config->getStateFilesPath());
+    storage.setMemoryMapped(config->isStateFileMemoryMapped());
 
     SuplaDevice.setLastStateLogger(
         new Supla::Device::FileStateLogger(config->getStateFilesPath()));
@@ -189,6 +192,15 @@ int main(int argc, char* argv[]) {
     auto clock = std::make_unique<Supla::LinuxClock>();
     (void)(clock);
 
+    // event loop has to be created before SuplaDevice.begin(), so timers
+    // are handled by it instead of separate threads
+    Supla::Linux::EventLoop eventLoop;
+    eventLoop.addFd(Supla::LinuxMqttClient::topics.getEventFd(),
+                    []() { Supla::LinuxMqttClient::topics.clearEvent(); });
+    eventLoop.addFd(Supla::Source::FileWatcher::Instance()->getFd(), []() {
+      Supla::Source::FileWatcher::Instance()->processEvents();
+    });
+
     SuplaDevice.begin(config->getProtoVersion());
 
     if (SuplaDevice.getCurrentStatus() != STATUS_INITIALIZED) {
@@ -198,9 +210,13 @@ int main(int argc, char* argv[]) {
 
     Supla::LinuxMqttClient::start();
 
-    while (st_app_terminate == 0) {
-      SuplaDevice.iterate();
-      delay(10);
+    if (eventLoop.isInitialized()) {
+      eventLoop.run(&st_app_terminate);
+    } else {
+      while (st_app_terminate == 0) {
+        SuplaDevice.iterate();
+        delay(10);
+      }
     }
     SUPLA_LOG_INFO("Exit");
 
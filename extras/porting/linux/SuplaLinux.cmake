@@ -42,23 +42,31 @@ set(SUPLA_DEVICE_LINUX_SRCS
   ${SUPLA_LINUX_PORT_DIR}/linux_file_state_logger.cpp
   ${SUPLA_LINUX_PORT_DIR}/linux_client.cpp
   ${SUPLA_LINUX_PORT_DIR}/linux_file_storage.cpp
+  ${SUPLA_LINUX_PORT_DIR}/linux_event_loop.cpp
   ${SUPLA_LINUX_PORT_DIR}/linux_mqtt_client.cpp
   ${SUPLA_LINUX_PORT_DIR}/mqtt_client.cpp
+  ${SUPLA_LINUX_PORT_DIR}/mqtt_loop_waiter.cpp
+  ${SUPLA_LINUX_PORT_DIR}/mqtt_topic_store.cpp
 
   ${SUPLA_LINUX_PORT_DIR}/linux_timers.cpp
   ${SUPLA_LINUX_PORT_DIR}/linux_clock.cpp
 
   ${SUPLA_LINUX_PORT_DIR}/supla/custom_channel.cpp
 
+  ${SUPLA_LINUX_PORT_DIR}/supla/source/async.cpp
   ${SUPLA_LINUX_PORT_DIR}/supla/source/cmd.cpp
   ${SUPLA_LINUX_PORT_DIR}/supla/source/file.cpp
+  ${SUPLA_LINUX_PORT_DIR}/supla/source/file_watcher.cpp
   ${SUPLA_LINUX_PORT_DIR}/supla/source/mqtt_src.cpp
+  ${SUPLA_LINUX_PORT_DIR}/supla/source/refresh_pool.cpp
+  ${SUPLA_LINUX_PORT_DIR}/supla/source/source.cpp
 
   ${SUPLA_LINUX_PORT_DIR}/supla/parser/parser.cpp
   ${SUPLA_LINUX_PORT_DIR}/supla/parser/simple.cpp
   ${SUPLA_LINUX_PORT_DIR}/supla/parser/json.cpp
 
   ${SUPLA_LINUX_PORT_DIR}/supla/output/cmd.cpp
+  ${SUPLA_LINUX_PORT_DIR}/supla/output/cmd_executor.cpp
   ${SUPLA_LINUX_PORT_DIR}/supla/output/file.cpp
   ${SUPLA_LINUX_PORT_DIR}/supla/output/mqtt.cpp
 
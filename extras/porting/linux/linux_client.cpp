@@ -32,6 +32,7 @@
 #include <arpa/inet.h>
 
 #include "linux_client.h"
+#include "linux_event_loop.h"
 
 Supla::LinuxClient::LinuxClient() {
 }
@@ -172,6 +173,9 @@ int Supla::LinuxClient::connectImp(const char *server, uint16_t port) {
   SUPLA_LOG_DEBUG("Connected via IP %d.%d.%d.%d", ipArr[0], ipArr[1],
       ipArr[2], ipArr[3]);
 
+  // main loop wakes up when data from server arrives
+  Supla::Linux::EventLoop::AddFd(connectionFd);
+
   return 1;
 }
 
@@ -289,6 +293,7 @@ void Supla::LinuxClient::stop() {
     SSL_free(ssl);
   }
   if (connectionFd >= 0) {
+    Supla::Linux::EventLoop::RemoveFd(connectionFd);
     close(connectionFd);
   }
   connectionFd = -1;
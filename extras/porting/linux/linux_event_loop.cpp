@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) AC SOFTWARE SP. Z O.O
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "linux_event_loop.h"
+
+#include <SuplaDevice.h>
+#include <errno.h>
+#include <supla/log_wrapper.h>
+#include <supla/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <utility>
+
+namespace {
+constexpr int MaxEvents = 16;
+constexpr int FastTimerIntervalMs = 1;
+constexpr uint32_t StatsLogIntervalMs = 5 * 60 * 1000;
+
+uint32_t elapsedUs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+}  // namespace
+
+std::atomic<Supla::Linux::EventLoop *> Supla::Linux::EventLoop::instance =
+    nullptr;
+
+Supla::Linux::EventLoop *Supla::Linux::EventLoop::Instance() {
+  return instance.load();
+}
+
+void Supla::Linux::EventLoop::AddFd(int fd, std::function<void()> onReady) {
+  auto loop = Instance();
+  if (loop) {
+    loop->addFd(fd, std::move(onReady));
+  }
+}
+
+void Supla::Linux::EventLoop::RemoveFd(int fd) {
+  auto loop = Instance();
+  if (loop) {
+    loop->removeFd(fd);
+  }
+}
+
+void Supla::Linux::EventLoop::WakeUp() {
+  auto loop = Instance();
+  if (loop) {
+    loop->wakeUp();
+  }
+}
+
+Supla::Linux::EventLoop::EventLoop() {
+  if (instance.load() != nullptr) {
+    SUPLA_LOG_ERROR("EventLoop: only one instance is allowed");
+    return;
+  }
+
+  epollFd = epoll_create1(EPOLL_CLOEXEC);
+  wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  fastTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (epollFd < 0 || wakeupFd < 0 || timerFd < 0 || fastTimerFd < 0) {
+    SUPLA_LOG_ERROR("EventLoop: initialization failed (errno %d)", errno);
+    return;
+  }
+
+  for (int fd : {wakeupFd, timerFd, fastTimerFd}) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+  }
+  startTimer();
+  lastStatsLogMs = millis();
+  lastIterateTime = std::chrono::steady_clock::now();
+  instance = this;
+}
+
+Supla::Linux::EventLoop::~EventLoop() {
+  EventLoop *self = this;
+  instance.compare_exchange_strong(self, nullptr);
+  for (int fd : {epollFd, wakeupFd, timerFd, fastTimerFd}) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+bool Supla::Linux::EventLoop::isInitialized() const {
+  return instance.load() == this;
+}
+
+void Supla::Linux::EventLoop::setTimerIntervalMs(int intervalMs) {
+  if (intervalMs <= 0) {
+    return;
+  }
+  timerIntervalMs = intervalMs;
+  startTimer();
+}
+
+int Supla::Linux::EventLoop::getTimerIntervalMs() const {
+  return timerIntervalMs;
+}
+
+void Supla::Linux::EventLoop::setIdleIterateIntervalMs(int intervalMs) {
+  if (intervalMs < 0) {
+    intervalMs = 0;
+  }
+  idleIterateIntervalMs = intervalMs;
+}
+
+int Supla::Linux::EventLoop::getIdleIterateIntervalMs() const {
+  return idleIterateIntervalMs;
+}
+
+void Supla::Linux::EventLoop::setFastTimerEnabled(bool enabled) {
+  fastTimerEnabled = enabled;
+  startFastTimer();
+}
+
+bool Supla::Linux::EventLoop::isFastTimerEnabled() const {
+  return fastTimerEnabled;
+}
+
+void Supla::Linux::EventLoop::startTimer() {
+  if (timerFd < 0) {
+    return;
+  }
+  // periodic timer doesn't drift - deadlines are counted from start time
+  struct itimerspec spec = {};
+  spec.it_interval.tv_sec = timerIntervalMs / 1000;
+  spec.it_interval.tv_nsec = (timerIntervalMs % 1000) * 1000000L;
+  spec.it_value = spec.it_interval;
+  timerfd_settime(timerFd, 0, &spec, nullptr);
+}
+
+void Supla::Linux::EventLoop::startFastTimer() {
+  if (fastTimerFd < 0) {
+    return;
+  }
+  // zeroed spec disarms the timer
+  struct itimerspec spec = {};
+  if (fastTimerEnabled) {
+    spec.it_interval.tv_nsec = FastTimerIntervalMs * 1000000L;
+    spec.it_value = spec.it_interval;
+  }
+  timerfd_settime(fastTimerFd, 0, &spec, nullptr);
+}
+
+bool Supla::Linux::EventLoop::addFd(int fd, std::function<void()> onReady) {
+  if (fd < 0 || epollFd < 0) {
+    return false;
+  }
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  // fd closed without removeFd() is already gone from epoll set, so ADD is
+  // tried first even if fd number is known
+  int ret = epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+  if (ret != 0 && errno == EEXIST) {
+    ret = epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+  }
+  if (ret != 0) {
+    SUPLA_LOG_WARNING("EventLoop: failed to add fd %d (errno %d)", fd, errno);
+    return false;
+  }
+  fds[fd] = std::move(onReady);
+  return true;
+}
+
+void Supla::Linux::EventLoop::removeFd(int fd) {
+  auto it = fds.find(fd);
+  if (it == fds.end()) {
+    return;
+  }
+  epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+  fds.erase(it);
+}
+
+void Supla::Linux::EventLoop::wakeUp() {
+  if (wakeupFd >= 0) {
+    uint64_t one = 1;
+    ssize_t ret = write(wakeupFd, &one, sizeof(one));
+    (void)ret;
+  }
+}
+
+void Supla::Linux::EventLoop::runOnce(int timeoutMs) {
+  if (epollFd < 0) {
+    // fallback to previous behavior, timers are handled by Timers threads
+    // because instance isn't set
+    delay(timerIntervalMs);
+    iterate();
+    return;
+  }
+
+  struct epoll_event events[MaxEvents] = {};
+  int count = epoll_wait(epollFd, events, MaxEvents, timeoutMs);
+  if (count < 0) {
+    if (errno != EINTR) {
+      SUPLA_LOG_ERROR("EventLoop: epoll_wait failed (errno %d)", errno);
+      delay(timerIntervalMs);
+    }
+    return;
+  }
+  stats.wakeups++;
+
+  // fast timer ticks alone don't call iterate(), so enabling fast timer
+  // doesn't increase number of iterations. Timer ticks alone call iterate()
+  // only once per idle iterate interval.
+  bool fastTimerOnly = count > 0;
+  bool hasEvents = false;
+  for (int i = 0; i < count; i++) {
+    int fd = events[i].data.fd;
+    if (fd == fastTimerFd) {
+      handleFastTimer();
+      continue;
+    }
+    fastTimerOnly = false;
+    if (fd == timerFd) {
+      handleTimer();
+    } else if (fd == wakeupFd) {
+      hasEvents = true;
+      uint64_t value = 0;
+      ssize_t size = read(wakeupFd, &value, sizeof(value));
+      (void)size;
+    } else {
+      hasEvents = true;
+      stats.fdWakeups++;
+      auto it = fds.find(fd);
+      if (it == fds.end()) {
+        continue;
+      }
+      if (it->second) {
+        // callback may remove fd, so copy is called
+        auto callback = it->second;
+        callback();
+      }
+      if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+        // closed fd would wake up loop all the time, so it is removed until
+        // its owner registers it again
+        removeFd(fd);
+      }
+    }
+  }
+
+  if (fastTimerOnly ||
+      (!hasEvents && std::chrono::steady_clock::now() - lastIterateTime <
+                         std::chrono::milliseconds(idleIterateIntervalMs))) {
+    stats.skippedIterations++;
+    return;
+  }
+  iterate();
+  logStats();
+}
+
+void Supla::Linux::EventLoop::run(
+    const volatile unsigned char *terminate) {
+  while (*terminate == 0) {
+    runOnce();
+  }
+}
+
+uint64_t Supla::Linux::EventLoop::readTimer(int fd) {
+  uint64_t expirations = 0;
+  if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+    return 0;
+  }
+  return expirations;
+}
+
+void Supla::Linux::EventLoop::handleTimer() {
+  uint64_t expirations = readTimer(timerFd);
+  if (expirations == 0) {
+    return;
+  }
+
+  // time since last deadline = interval - time to next deadline
+  struct itimerspec spec = {};
+  if (timerfd_gettime(timerFd, &spec) == 0) {
+    int64_t remainingUs =
+        spec.it_value.tv_sec * 1000000LL + spec.it_value.tv_nsec / 1000;
+    int64_t latencyUs = timerIntervalMs * 1000LL - remainingUs;
+    if (latencyUs > stats.maxTimerLatencyUs) {
+      stats.maxTimerLatencyUs = latencyUs;
+    }
+  }
+
+  // late ticks are coalesced - timer based elements use millis() to
+  // measure time, so calling them in a burst wouldn't help
+  stats.timerTicks++;
+  stats.missedTicks += expirations - 1;
+  onTimerTick();
+  if (!fastTimerEnabled) {
+    onFastTimerTick();
+  }
+}
+
+void Supla::Linux::EventLoop::handleFastTimer() {
+  uint64_t expirations = readTimer(fastTimerFd);
+  if (expirations == 0 || !fastTimerEnabled) {
+    return;
+  }
+  stats.fastTimerTicks++;
+  stats.missedFastTicks += expirations - 1;
+  onFastTimerTick();
+}
+
+void Supla::Linux::EventLoop::iterate() {
+  auto start = std::chrono::steady_clock::now();
+  lastIterateTime = start;
+  onIterate();
+  stats.iterations++;
+  stats.lastIterationUs = elapsedUs(start);
+  if (stats.lastIterationUs > stats.maxIterationUs) {
+    stats.maxIterationUs = stats.lastIterationUs;
+  }
+}
+
+void Supla::Linux::EventLoop::onTimerTick() {
+  SuplaDevice.onTimer();
+}
+
+void Supla::Linux::EventLoop::onFastTimerTick() {
+  SuplaDevice.onFastTimer();
+}
+
+void Supla::Linux::EventLoop::onIterate() {
+  SuplaDevice.iterate();
+}
+
+void Supla::Linux::EventLoop::logStats() {
+  uint32_t now = millis();
+  if (now - lastStatsLogMs < StatsLogIntervalMs) {
+    return;
+  }
+  uint32_t periodMs = now - lastStatsLogMs;
+  lastStatsLogMs = now;
+  uint32_t wakeups = stats.wakeups - lastLoggedStats.wakeups;
+  uint32_t fdWakeups = stats.fdWakeups - lastLoggedStats.fdWakeups;
+  uint32_t iterations = stats.iterations - lastLoggedStats.iterations;
+  SUPLA_LOG_DEBUG(
+      "EventLoop: %u wakeups/s (%u fd), %u iterations/s, missed ticks %u "
+      "(fast %u), iterate max %u us, timer latency max %u us",
+      static_cast<uint32_t>(wakeups * 1000ULL / periodMs),
+      static_cast<uint32_t>(fdWakeups * 1000ULL / periodMs),
+      static_cast<uint32_t>(iterations * 1000ULL / periodMs),
+      stats.missedTicks,
+      stats.missedFastTicks,
+      stats.maxIterationUs,
+      stats.maxTimerLatencyUs);
+  lastLoggedStats = stats;
+}
+
+Supla::Linux::EventLoopStats Supla::Linux::EventLoop::getStats() const {
+  return stats;
+}
+
+void Supla::Linux::EventLoop::resetStats() {
+  stats = {};
+  lastLoggedStats = {};
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) AC SOFTWARE SP. Z O.O
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef EXTRAS_PORTING_LINUX_LINUX_EVENT_LOOP_H_
+#define EXTRAS_PORTING_LINUX_LINUX_EVENT_LOOP_H_
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <map>
+
+namespace Supla {
+namespace Linux {
+
+struct EventLoopStats {
+  uint32_t wakeups = 0;
+  uint32_t fdWakeups = 0;
+  uint32_t timerTicks = 0;
+  uint32_t fastTimerTicks = 0;
+  // timer expirations which were handled late (more than one per wakeup)
+  uint32_t missedTicks = 0;
+  uint32_t missedFastTicks = 0;
+  uint32_t iterations = 0;
+  // wakeups without events on which iterate() wasn't called
+  uint32_t skippedIterations = 0;
+  uint32_t lastIterationUs = 0;
+  uint32_t maxIterationUs = 0;
+  // delay between timer deadline and its handling
+  uint32_t maxTimerLatencyUs = 0;
+};
+
+/**
+ * epoll based main loop of Linux daemon. It replaces
+ * "SuplaDevice.iterate(); delay(10);" loop and timer threads.
+ *
+ * Loop sleeps until one of registered file descriptors (server connection,
+ * MQTT topic store, file watcher, ...) becomes readable, until wakeUp() is
+ * called from other thread, or until timerfd deadline. onTimer() and
+ * onFastTimer() are called from loop thread, so they don't compete with
+ * iterate() for timerAccessMutex.
+ *
+ * iterate() is called after each fd or wakeUp() event. When loop is woken up
+ * only by timers, iterate() is called at most once per idle iterate interval
+ * (100 ms by default), so idle device doesn't run full SuplaDevice.iterate()
+ * on each 10 ms tick.
+ *
+ * By default onFastTimer() is called on each timer tick (every 10 ms), which
+ * is enough for elements which base their timing on millis(). Elements which
+ * sample inputs in onFastTimer() (i.e. ImpulseCounter) require fast timer
+ * (see setFastTimerEnabled()), which wakes up the loop every 1 ms.
+ *
+ * Only one EventLoop may exist. Timers::init() doesn't start timer threads
+ * when EventLoop was created before SuplaDevice.begin().
+ */
+class EventLoop {
+ public:
+  static EventLoop *Instance();
+  // Registers fd in current EventLoop instance (if it exists). Has to be
+  // called from loop thread.
+  static void AddFd(int fd, std::function<void()> onReady = {});
+  static void RemoveFd(int fd);
+  // Thread safe, can be called without EventLoop instance
+  static void WakeUp();
+
+  EventLoop();
+  virtual ~EventLoop();
+
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+
+  bool isInitialized() const;
+
+  // Timer tick interval, default 10 ms
+  void setTimerIntervalMs(int intervalMs);
+  int getTimerIntervalMs() const;
+
+  // Minimal time between iterate() calls on wakeups without fd and wakeUp()
+  // events, 0 - iterate on each timer tick
+  void setIdleIterateIntervalMs(int intervalMs);
+  int getIdleIterateIntervalMs() const;
+
+  // Enables separate 1 ms timer for onFastTimer(). iterate() isn't called
+  // on fast timer ticks. Disabled by default.
+  void setFastTimerEnabled(bool enabled);
+  bool isFastTimerEnabled() const;
+
+  /**
+   * Adds fd (level triggered, EPOLLIN). onReady is called on loop thread
+   * when fd is readable and it should consume the data (otherwise loop will
+   * wake up immediately again). iterate() is called afterwards anyway.
+   * Not thread safe - has to be called from loop thread.
+   */
+  bool addFd(int fd, std::function<void()> onReady = {});
+  void removeFd(int fd);
+
+  // Thread safe
+  void wakeUp();
+
+  // Waits for single event (at most timeoutMs, -1 waits for next timer
+  // tick) and runs timers and iterate
+  void runOnce(int timeoutMs = -1);
+  // Runs loop until *terminate becomes non zero
+  void run(const volatile unsigned char *terminate);
+
+  EventLoopStats getStats() const;
+  void resetStats();
+
+ protected:
+  // By default call SuplaDevice methods. Overridden in tests.
+  virtual void onTimerTick();
+  virtual void onFastTimerTick();
+  virtual void onIterate();
+
+  void startTimer();
+  void startFastTimer();
+  // Returns number of timer expirations since last read
+  uint64_t readTimer(int fd);
+  void handleTimer();
+  void handleFastTimer();
+  void iterate();
+  void logStats();
+
+  static std::atomic<EventLoop *> instance;
+
+  int epollFd = -1;
+  int timerFd = -1;
+  int fastTimerFd = -1;
+  int wakeupFd = -1;
+  int timerIntervalMs = 10;
+  bool fastTimerEnabled = false;
+  int idleIterateIntervalMs = 100;
+  std::chrono::steady_clock::time_point lastIterateTime;
+  std::map<int, std::function<void()>> fds;
+  EventLoopStats stats;
+  EventLoopStats lastLoggedStats;
+  uint32_t lastStatsLogMs = 0;
+};
+
+}  // namespace Linux
+}  // namespace Supla
+
+#endif  // EXTRAS_PORTING_LINUX_LINUX_EVENT_LOOP_H_
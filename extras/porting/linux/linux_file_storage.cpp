@@ -21,10 +21,13 @@
 #include <supla/log_wrapper.h>
 
 #include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <cerrno>
 #include <cstring>
-#include <filesystem>  // NOLINT(build/c++17)
-#include <fstream>
 #include <string>
 
 namespace Supla {
@@ -37,31 +40,158 @@ LinuxFileStorage::LinuxFileStorage(const std::string &path,
 }
 
 LinuxFileStorage::~LinuxFileStorage() {
-  if (data) {
+  if (mappedData) {
+    unmapStateFile();
+  } else if (data) {
     delete[] data;
-    data = nullptr;
   }
+  data = nullptr;
+}
+
+void LinuxFileStorage::setMemoryMapped(bool enable) {
+  memoryMappedRequested = enable;
+}
+
+bool LinuxFileStorage::isMemoryMapped() const {
+  return mappedData != nullptr;
+}
+
+std::string LinuxFileStorage::getStateFilePath() const {
+  return path + "/state.bin";
 }
 
 bool LinuxFileStorage::init() {
   data = new unsigned char[reservedSize];
   memset(data, 0, reservedSize);
 
-  std::string filePath = path + "/state.bin";
+  std::string filePath = getStateFilePath();
   SUPLA_LOG_INFO("Storage state file: %s", filePath.c_str());
 
-  std::ifstream stateFile(filePath, std::ifstream::in | std::ios::binary);
+  off_t fileSize = -1;
+  int fd = open(filePath.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) == 0) {
+      fileSize = fileStat.st_size;
+    }
+    unsigned int bytesRead = 0;
+    while (bytesRead < reservedSize) {
+      ssize_t r = read(fd, data + bytesRead, reservedSize - bytesRead);
+      if (r < 0 && errno == EINTR) {
+        continue;
+      }
+      if (r <= 0) {
+        break;
+      }
+      bytesRead += r;
+    }
+    close(fd);
+  }
 
-  unsigned char c = stateFile.get();
+  if (memoryMappedRequested) {
+    // mapped file has to be exactly reservedSize long
+    if (fileSize != static_cast<off_t>(reservedSize)) {
+      writeFileAtomically(data, reservedSize);
+    }
+    if (mapStateFile()) {
+      delete[] data;
+      data = mappedData;
+    } else {
+      SUPLA_LOG_WARNING(
+          "Storage: failed to mmap state file, using default mode");
+    }
+  }
 
-  for (unsigned int i = 0; stateFile.good() && i < reservedSize; i++) {
-    data[i] = c;
-    c = stateFile.get();
+  return Storage::init();
+}
+
+bool LinuxFileStorage::mapStateFile() {
+  std::string filePath = getStateFilePath();
+  int fd = open(filePath.c_str(), O_RDWR);
+  if (fd < 0) {
+    return false;
   }
 
-  stateFile.close();
+  struct stat fileStat = {};
+  if (fstat(fd, &fileStat) != 0 ||
+      fileStat.st_size != static_cast<off_t>(reservedSize)) {
+    close(fd);
+    return false;
+  }
 
-  return Storage::init();
+  void *ptr =
+      mmap(nullptr, reservedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (ptr == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+
+  mappedFd = fd;
+  mappedData = reinterpret_cast<unsigned char *>(ptr);
+  return true;
+}
+
+void LinuxFileStorage::unmapStateFile() {
+  if (mappedData) {
+    munmap(mappedData, reservedSize);
+    mappedData = nullptr;
+  }
+  if (mappedFd >= 0) {
+    close(mappedFd);
+    mappedFd = -1;
+  }
+}
+
+bool LinuxFileStorage::writeFileAtomically(const unsigned char *buf,
+                                           unsigned int size) {
+  std::string filePath = getStateFilePath();
+  std::string tmpPath = filePath + ".tmp";
+
+  int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    SUPLA_LOG_ERROR("Storage: failed to open %s: %s",
+                    tmpPath.c_str(),
+                    strerror(errno));
+    return false;
+  }
+
+  unsigned int bytesWritten = 0;
+  while (bytesWritten < size) {
+    ssize_t r = write(fd, buf + bytesWritten, size - bytesWritten);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r <= 0) {
+      break;
+    }
+    bytesWritten += r;
+  }
+
+  if (bytesWritten != size || fsync(fd) != 0) {
+    SUPLA_LOG_ERROR("Storage: failed to write %s: %s",
+                    tmpPath.c_str(),
+                    strerror(errno));
+    close(fd);
+    unlink(tmpPath.c_str());
+    return false;
+  }
+  close(fd);
+
+  if (rename(tmpPath.c_str(), filePath.c_str()) != 0) {
+    SUPLA_LOG_ERROR("Storage: failed to rename %s: %s",
+                    tmpPath.c_str(),
+                    strerror(errno));
+    unlink(tmpPath.c_str());
+    return false;
+  }
+
+  // make rename durable
+  int dirFd = open(path.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dirFd >= 0) {
+    fsync(dirFd);
+    close(dirFd);
+  }
+  return true;
 }
 
 int LinuxFileStorage::readStorage(unsigned int offset,
@@ -69,39 +199,57 @@ int LinuxFileStorage::readStorage(unsigned int offset,
                         unsigned int size,
                         bool logs) {
   (void)(logs);
-  for (unsigned int i = 0; i < size; i++) {
-    assert(offset + i < reservedSize && "Too small state Storage");
-    buf[i] = data[offset + i];
-  }
+  assert(offset + size <= reservedSize && "Too small state Storage");
+  memcpy(buf, data + offset, size);
   return size;
 }
 
+bool LinuxFileStorage::isStorageDataEqual(unsigned int offset,
+                                          const unsigned char *buf,
+                                          int size) {
+  assert(offset + size <= reservedSize && "Too small state Storage");
+  return memcmp(data + offset, buf, size) == 0;
+}
+
 int LinuxFileStorage::writeStorage(unsigned int offset,
                          const unsigned char *buf,
                          unsigned int size) {
-  dataChanged = true;
-  for (unsigned int i = 0; i < size; i++) {
-    assert(offset + i < reservedSize && "Too small state Storage");
-    data[offset + i] = buf[i];
+  assert(offset + size <= reservedSize && "Too small state Storage");
+  if (size == 0) {
+    return 0;
   }
+  memcpy(data + offset, buf, size);
+
+  if (!dataChanged) {
+    dirtyBegin = offset;
+    dirtyEnd = offset + size;
+  } else {
+    if (offset < dirtyBegin) {
+      dirtyBegin = offset;
+    }
+    if (offset + size > dirtyEnd) {
+      dirtyEnd = offset + size;
+    }
+  }
+  dataChanged = true;
 
   return size;
 }
 
 void LinuxFileStorage::commit() {
   if (dataChanged) {
-    std::ofstream stateFile(path + "/state.bin",
-        std::ofstream::out | std::ios::binary);
-
-    for (unsigned int i = 0; i < reservedSize; i++) {
-      stateFile << data[i];
+    if (mappedData) {
+      // msync requires page aligned address
+      unsigned int pageSize = sysconf(_SC_PAGESIZE);
+      unsigned int begin = dirtyBegin - dirtyBegin % pageSize;
+      if (msync(mappedData + begin, dirtyEnd - begin, MS_SYNC) != 0) {
+        SUPLA_LOG_ERROR("Storage: msync failed: %s", strerror(errno));
+      }
+    } else {
+      writeFileAtomically(data, reservedSize);
     }
-
-    stateFile.close();
-    // save to a file
   }
   dataChanged = false;
 }
 
 }  // namespace Supla
-
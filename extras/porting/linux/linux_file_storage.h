@@ -34,14 +34,44 @@ class LinuxFileStorage : public Storage {
   bool init() override;
   void commit() override;
 
+  /**
+   * Enables memory mapped mode. It has to be called before init().
+   *
+   * In memory mapped mode state.bin is mmap'ed and commit() flushes (msync)
+   * only the range modified since last commit, instead of rewriting whole
+   * file. If mmap fails, storage falls back to default mode.
+   *
+   * In both modes whole file is rewritten atomically (temporary file,
+   * fsync and rename), so crash during rewrite doesn't corrupt the state.
+   *
+   * @param enable true to enable memory mapped mode
+   */
+  void setMemoryMapped(bool enable);
+  bool isMemoryMapped() const;
+
  protected:
   int readStorage(unsigned int, unsigned char *, unsigned int, bool) override;
   int writeStorage(unsigned int, const unsigned char *, unsigned int) override;
+  // Compares with data kept in memory
+  bool isStorageDataEqual(unsigned int address,
+                          const unsigned char *buf,
+                          int size) override;
+
+  std::string getStateFilePath() const;
+  bool writeFileAtomically(const unsigned char *buf, unsigned int size);
+  bool mapStateFile();
+  void unmapStateFile();
 
   unsigned int reservedSize = 0;
   bool dataChanged = false;
   unsigned char *data = nullptr;
   std::string path;
+
+  bool memoryMappedRequested = false;
+  int mappedFd = -1;
+  unsigned char *mappedData = nullptr;
+  unsigned int dirtyBegin = 0;
+  unsigned int dirtyEnd = 0;
 };
 
 };  // namespace Supla
@@ -29,7 +29,7 @@
 std::shared_ptr<Supla::LinuxMqttClient> Supla::LinuxMqttClient::instance =
     nullptr;
 
-std::unordered_map<std::string, std::string> Supla::LinuxMqttClient::topics;
+Supla::MqttTopicStore Supla::LinuxMqttClient::topics;
 
 Supla::LinuxMqttClient::LinuxMqttClient(
     const Supla::LinuxYamlConfig& yamlConfig)
@@ -82,11 +82,11 @@ std::shared_ptr<Supla::LinuxMqttClient>& Supla::LinuxMqttClient::getInstance(
 
 void Supla::LinuxMqttClient::subscribeTopic(const std::string& topic, int qos) {
   (void)qos;
-  topics[topic] = "";
+  topics.subscribe(topic);
 }
 
 void Supla::LinuxMqttClient::unsubscribeTopic(const std::string& topic) {
-  topics.erase(topic);
+  topics.unsubscribe(topic);
   auto reconnect_state =
       static_cast<reconnect_state_t*>(mq_client->reconnect_state);
   reconnect_state->topics.erase(topic);
@@ -97,7 +97,13 @@ void Supla::LinuxMqttClient::unsubscribeTopic(const std::string& topic) {
 int Supla::LinuxMqttClient::mqttClientInit() {
   SUPLA_LOG_DEBUG("Linux MQTT client init.");
   return mqtt_client_init(
-      host, port, username, password, clientName, topics, publishCallback);
+      host,
+      port,
+      username,
+      password,
+      clientName,
+      topics.getSubscribedTopics(),
+      publishCallback);
 }
 
 void Supla::LinuxMqttClient::publishCallback(void**,
@@ -109,7 +115,7 @@ void Supla::LinuxMqttClient::publishCallback(void**,
   std::string application_message_string(application_message,
                                          published->application_message_size);
 
-  topics[topic_name_string] = application_message_string;
+  topics.update(topic_name_string, application_message_string);
 
   SUPLA_LOG_DEBUG("Linux MQTT client received message from %s: %s",
                   topic_name_string.c_str(),
@@ -129,10 +135,12 @@ enum MQTTErrors Supla::LinuxMqttClient::publish(const std::string& topic,
   if (mq_client->error != MQTTErrors::MQTT_OK) {
     return mq_client->error;
   }
-  return mqtt_publish(mq_client,
-                      topic.c_str(),
-                      static_cast<const void*>(payload.c_str()),
-                      payload.size(),
-                      qos);
+  auto result = mqtt_publish(mq_client,
+                             topic.c_str(),
+                             static_cast<const void*>(payload.c_str()),
+                             payload.size(),
+                             qos);
+  mqtt_client_wakeup();
+  return result;
 }
 
@@ -22,6 +22,7 @@
 #include <linux_yaml_config.h>
 #include <mqtt.h>
 #include <mqtt_pal.h>
+#include <mqtt_topic_store.h>
 #include <yaml-cpp/yaml.h>
 
 #include <memory>
@@ -54,7 +55,8 @@ class LinuxMqttClient {
 
   struct mqtt_client* mq_client = nullptr;
 
-  static std::unordered_map<std::string, std::string> topics;
+  // written by MQTT client thread, read by main loop
+  static MqttTopicStore topics;
 
   bool useSSL = false;
   bool verifyCA = false;
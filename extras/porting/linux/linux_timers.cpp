@@ -17,11 +17,14 @@
 */
 
 #include <SuplaDevice.h>
+#include <supla/element.h>
 #include <supla/log_wrapper.h>
+#include <supla/sensor/impulse_counter.h>
 #include <supla/time.h>
 
 #include <thread>  // NOLINT(build/c++11)
 
+#include "linux_event_loop.h"
 #include "linux_timers.h"
 
 void supla10msTimer() {
@@ -39,6 +42,21 @@ void supla1msTimer() {
 }
 
 void Supla::Linux::Timers::init() {
+  auto loop = Supla::Linux::EventLoop::Instance();
+  if (loop) {
+    SUPLA_LOG_DEBUG("Timers are handled by event loop");
+    // ImpulseCounter samples its input in onFastTimer(), so it requires
+    // 1 ms fast timer. Other elements are fine with regular timer tick.
+    for (auto element = Supla::Element::begin(); element != nullptr;
+         element = element->next()) {
+      if (dynamic_cast<Supla::Sensor::ImpulseCounter *>(element)) {
+        SUPLA_LOG_DEBUG("Enabling 1 ms fast timer");
+        loop->setFastTimerEnabled(true);
+        break;
+      }
+    }
+    return;
+  }
   SUPLA_LOG_DEBUG("Starting linux timers...");
   std::thread standardTimer(supla10msTimer);
   standardTimer.detach();
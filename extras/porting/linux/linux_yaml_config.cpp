@@ -31,6 +31,7 @@
 #include <supla/log_wrapper.h>
 #include <supla/network/ip_address.h>
 #include <supla/output/cmd.h>
+#include <supla/output/cmd_executor.h>
 #include <supla/output/file.h>
 #include <supla/output/mqtt.h>
 #include <supla/output/output.h>
@@ -54,6 +55,7 @@
 #include <supla/sensor/thermometer_parsed.h>
 #include <supla/sensor/weight_parsed.h>
 #include <supla/sensor/wind_parsed.h>
+#include <supla/source/async.h>
 #include <supla/source/cmd.h>
 #include <supla/source/file.h>
 #include <supla/source/mqtt_src.h>
@@ -552,6 +554,15 @@ bool Supla::LinuxYamlConfig::getMqttClientFileCA(char* result) const {
 
 bool Supla::LinuxYamlConfig::loadChannels() {
   try {
+    // commands of Cmd outputs and Cmd* channels are executed asynchronously
+    if (config["cmd_concurrency"]) {
+      Supla::Output::CmdExecutor::SetConcurrency(
+          config["cmd_concurrency"].as<int>());
+    }
+    if (config["cmd_timeout_ms"]) {
+      Supla::Output::CmdExecutor::SetDefaultTimeoutMs(
+          config["cmd_timeout_ms"].as<unsigned int>());
+    }
     if (config["channels"]) {
       auto channels = config["channels"];
       int channelCount = 0;
@@ -1662,7 +1673,11 @@ Supla::Parser::Parser* Supla::LinuxYamlConfig::addParser(
     if (type == "Simple") {
       prs = new Supla::Parser::Simple(src);
     } else if (type == "Json") {
-      prs = new Supla::Parser::Json(src);
+      auto json = new Supla::Parser::Json(src);
+      if (parser["streaming"] && parser["streaming"].as<bool>()) {
+        json->setStreaming(true);
+      }
+      prs = json;
     } else {
       SUPLA_LOG_ERROR("Config: unknown parser type \"%s\"", type.c_str());
       return nullptr;
@@ -1766,14 +1781,23 @@ Supla::Source::Source* Supla::LinuxYamlConfig::addSource(
       if (source["expiration_time_sec"]) {
         expirationTimeSec = source["expiration_time_sec"].as<int>();
       }
-      src = new Supla::Source::File(fileName.c_str(), expirationTimeSec);
+      auto fileSrc =
+          new Supla::Source::File(fileName.c_str(), expirationTimeSec);
+      if (source["watch"] && source["watch"].as<bool>()) {
+        fileSrc->setWatch(true);
+      }
+      src = fileSrc;
     } else if (type == "Cmd") {
       if (!source["command"]) {
         SUPLA_LOG_ERROR("Config: 'command' not defined for 'Cmd' source");
         return nullptr;
       }
       std::string cmd = source["command"].as<std::string>();
-      src = new Supla::Source::Cmd(cmd.c_str());
+      auto cmdSrc = new Supla::Source::Cmd(cmd.c_str());
+      if (source["timeout_ms"]) {
+        cmdSrc->setTimeoutMs(source["timeout_ms"].as<unsigned int>());
+      }
+      src = cmdSrc;
     } else if (type == "MQTT") {
       auto base_state_topic = source["state_topic"].as<std::string>();
       int qos = source["qos"].as<int>(0);
@@ -1799,6 +1823,22 @@ Supla::Source::Source* Supla::LinuxYamlConfig::addSource(
     return nullptr;
   }
 
+  if (source["async"] && source["async"].as<bool>()) {
+    if (source["type"].as<std::string>() == "MQTT") {
+      SUPLA_LOG_WARNING("Config: \"async\" is ignored for MQTT source");
+    } else {
+      unsigned int timeoutMs = source["timeout_ms"].as<unsigned int>(0);
+      if (timeoutMs == 0 && source["type"].as<std::string>() == "Cmd") {
+        // hanging command would hold RefreshPool worker forever
+        SUPLA_LOG_ERROR(
+            "Config: 'timeout_ms' is required for 'Cmd' source with 'async'");
+        delete src;
+        return nullptr;
+      }
+      src = new Supla::Source::Async(src, timeoutMs);
+    }
+  }
+
   sources[sourceCount] = src;
   sourceCount++;
 
@@ -1839,7 +1879,11 @@ Supla::Output::Output* Supla::LinuxYamlConfig::addOutput(
         return nullptr;
       }
       std::string cmd = output["command"].as<std::string>();
-      out = new Supla::Output::Cmd(cmd);
+      auto cmdOut = new Supla::Output::Cmd(cmd);
+      if (output["timeout_ms"]) {
+        cmdOut->setTimeoutMs(output["timeout_ms"].as<unsigned int>());
+      }
+      out = cmdOut;
     } else if (type == "File") {
       std::string fileName = output["file"].as<std::string>();
       out = new Supla::Output::File(fileName.c_str());
@@ -1879,6 +1923,17 @@ std::string Supla::LinuxYamlConfig::getStateFilesPath() {
   return path;
 }
 
+bool Supla::LinuxYamlConfig::isStateFileMemoryMapped() {
+  try {
+    if (config["state_file_mmap"]) {
+      return config["state_file_mmap"].as<bool>();
+    }
+  } catch (const YAML::Exception& ex) {
+    logError(file, ex);
+  }
+  return false;
+}
+
 void Supla::LinuxYamlConfig::loadGuidAuthFromPath(const std::string& path) {
   try {
     std::string file = path + Supla::GuidAuthFileName;
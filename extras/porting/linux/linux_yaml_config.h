@@ -123,6 +123,7 @@ class LinuxYamlConfig : public KeyValue {
   int getProtoVersion();
 
   std::string getStateFilesPath();
+  bool isStateFileMemoryMapped();
 
   bool isMqttSource();
   bool isValidMqttConfig();
@@ -31,9 +31,12 @@
 #include <unordered_map>
 
 #include "linux_mqtt_client.h"
+#include "mqtt_loop_waiter.h"
 
 pthread_t mqtt_deamon_thread = 0;
 
+Supla::MqttLoopWaiter mqtt_loop_waiter;
+
 struct reconnect_state_t* reconnect_state;
 
 int delay_time = 5;
@@ -179,13 +182,88 @@ int open_nb_socket(const char* addr, uint16_t port) {
 }
 #endif
 
+// Upper limit of wait time, so keep alive, ack timeouts and terminate
+// request are handled even when there is no traffic
+#define MQTT_LOOP_MAX_WAIT_MS 1000
+// Lower limit of wait time, so loop doesn't spin when ping is overdue but
+// mqtt_sync didn't queue it
+#define MQTT_LOOP_MIN_WAIT_MS 10
+
+static int mqtt_client_socket_fd(struct mqtt_client* client) {
+#if defined(MQTT_USE_BIO)
+  BIO* bio = reinterpret_cast<BIO*>(client->socketfd);
+  if (bio == nullptr) {
+    return -1;
+  }
+  if (BIO_pending(bio) > 0) {
+    // SSL has already decrypted data buffered - don't wait on socket
+    return -2;
+  }
+  int fd = -1;
+  BIO_get_fd(bio, &fd);
+  return fd;
+#else
+  return client->socketfd;
+#endif
+}
+
+// Returns true if MQTT-C has messages which weren't sent yet
+static bool mqtt_client_has_unsent(struct mqtt_client* client) {
+  bool unsent = false;
+  MQTT_PAL_MUTEX_LOCK(&client->mutex);
+  for (ssize_t i = 0; i < mqtt_mq_length(&client->mq); i++) {
+    if (mqtt_mq_get(&client->mq, i)->state == MQTT_QUEUED_UNSENT) {
+      unsent = true;
+      break;
+    }
+  }
+  MQTT_PAL_MUTEX_UNLOCK(&client->mutex);
+  return unsent;
+}
+
+// Time to the next keep alive ping sent by mqtt_sync
+static int mqtt_client_wait_time_ms(struct mqtt_client* client) {
+  int waitMs = MQTT_LOOP_MAX_WAIT_MS;
+  if (client->error == MQTT_OK && client->keep_alive > 0) {
+    // mqtt_sync sends ping when time (in whole seconds) is greater than
+    // pingTime, so it happens at the beginning of the next second
+    int64_t pingTime = static_cast<int64_t>(client->time_of_last_send) +
+                       client->keep_alive * 3 / 4;
+    int64_t leftMs =
+        (pingTime + 1 - static_cast<int64_t>(MQTT_PAL_TIME())) * 1000;
+    if (leftMs < waitMs) {
+      waitMs = static_cast<int>(leftMs);
+    }
+  }
+  if (waitMs < MQTT_LOOP_MIN_WAIT_MS) {
+    waitMs = MQTT_LOOP_MIN_WAIT_MS;
+  }
+  return waitMs;
+}
+
+void mqtt_client_wakeup() {
+  mqtt_loop_waiter.wakeup();
+}
+
 void* mqtt_client_loop(void* client) {
   (void)client;
   auto& mq_client = Supla::LinuxMqttClient::getInstance()->mq_client;
   SUPLA_LOG_DEBUG("Start MQTT client loop...");
   while (st_app_terminate == 0) {
-    mqtt_sync((struct mqtt_client*)mq_client);
-    delay(100);
+    auto* c = (struct mqtt_client*)mq_client;
+    mqtt_sync(c);
+
+    // Wait for data from broker, for socket to become writable when there
+    // are queued messages, or for wakeup after publish
+    int fd = mqtt_client_socket_fd(c);
+    if (fd == -2) {
+      continue;
+    }
+    if (c->error != MQTT_OK) {
+      fd = -1;
+    }
+    mqtt_loop_waiter.wait(
+        fd, fd >= 0 && mqtt_client_has_unsent(c), mqtt_client_wait_time_ms(c));
   }
   SUPLA_LOG_DEBUG("Stop MQTT client loop.");
   return nullptr;
@@ -261,6 +339,7 @@ void mqtt_client_publish(const char* topic,
 
   mqtt_publish(
       mq_client, topic, (const char*)payload, strlen(payload), publish_flags);
+  mqtt_client_wakeup();
 }
 
 void reconnect_client(struct mqtt_client* client, void** reconnect_state_vptr) {
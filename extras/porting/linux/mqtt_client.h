@@ -68,6 +68,9 @@ void mqtt_client_publish(const char* topic,
                          char retain,
                          char qos);
 
+// Wakes up MQTT client loop, so queued messages are sent right away
+void mqtt_client_wakeup();
+
 void mqtt_client_free();
 
 #endif  // EXTRAS_PORTING_LINUX_MQTT_CLIENT_H_
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) AC SOFTWARE SP. Z O.O
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "mqtt_loop_waiter.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <supla/log_wrapper.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+Supla::MqttLoopWaiter::MqttLoopWaiter() {
+  wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeupFd < 0) {
+    SUPLA_LOG_ERROR("MQTT: failed to create eventfd (errno %d)", errno);
+  }
+}
+
+Supla::MqttLoopWaiter::~MqttLoopWaiter() {
+  if (wakeupFd >= 0) {
+    close(wakeupFd);
+  }
+}
+
+void Supla::MqttLoopWaiter::wakeup() {
+  if (wakeupFd >= 0) {
+    uint64_t one = 1;
+    ssize_t ret = write(wakeupFd, &one, sizeof(one));
+    (void)ret;
+  }
+}
+
+int Supla::MqttLoopWaiter::getWakeupFd() const {
+  return wakeupFd;
+}
+
+Supla::MqttLoopWaiter::Result Supla::MqttLoopWaiter::wait(int socketFd,
+                                                          bool wantWrite,
+                                                          int timeoutMs) {
+  struct pollfd fds[2] = {};
+  fds[0].fd = wakeupFd;
+  fds[0].events = POLLIN;
+  // poll ignores entries with negative fd
+  fds[1].fd = socketFd;
+  fds[1].events = POLLIN | (wantWrite ? POLLOUT : 0);
+
+  int ret = poll(fds, 2, timeoutMs);
+  if (ret < 0) {
+    return errno == EINTR ? Result::Timeout : Result::Error;
+  }
+  if (ret == 0) {
+    return Result::Timeout;
+  }
+
+  if (fds[0].revents & POLLIN) {
+    uint64_t value = 0;
+    ssize_t size = read(wakeupFd, &value, sizeof(value));
+    (void)size;
+  }
+  if (fds[1].revents != 0) {
+    return Result::Socket;
+  }
+  return Result::Wakeup;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) AC SOFTWARE SP. Z O.O
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef EXTRAS_PORTING_LINUX_MQTT_LOOP_WAITER_H_
+#define EXTRAS_PORTING_LINUX_MQTT_LOOP_WAITER_H_
+
+namespace Supla {
+
+/**
+ * Blocks MQTT client thread until broker socket is ready or until other
+ * thread requests wakeup (i.e. after message was queued for publishing).
+ */
+class MqttLoopWaiter {
+ public:
+  enum class Result { Timeout, Socket, Wakeup, Error };
+
+  MqttLoopWaiter();
+  ~MqttLoopWaiter();
+
+  MqttLoopWaiter(const MqttLoopWaiter &) = delete;
+  MqttLoopWaiter &operator=(const MqttLoopWaiter &) = delete;
+
+  // Thread safe
+  void wakeup();
+
+  /**
+   * Waits until socket is readable (or writable, when wantWrite is set),
+   * wakeup() is called or timeout expires. Negative socketFd is ignored.
+   * Pending wakeups are cleared.
+   */
+  Result wait(int socketFd, bool wantWrite, int timeoutMs);
+
+  int getWakeupFd() const;
+
+ protected:
+  int wakeupFd = -1;
+};
+
+}  // namespace Supla
+
+#endif  // EXTRAS_PORTING_LINUX_MQTT_LOOP_WAITER_H_
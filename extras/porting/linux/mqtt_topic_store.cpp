@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) AC SOFTWARE SP. Z O.O
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "mqtt_topic_store.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+
+std::shared_ptr<const std::string> Supla::MqttTopicStore::Entry::getValue()
+    const {
+  return value.load(std::memory_order_acquire);
+}
+
+uint32_t Supla::MqttTopicStore::Entry::getSequence() const {
+  return sequence.load(std::memory_order_acquire);
+}
+
+Supla::MqttTopicStore::MqttTopicStore() {
+  eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+Supla::MqttTopicStore::~MqttTopicStore() {
+  if (eventFd >= 0) {
+    close(eventFd);
+  }
+}
+
+Supla::MqttTopicStore::Entry *Supla::MqttTopicStore::findOrCreate(
+    const std::string &topic) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = entries.find(topic);
+    if (it != entries.end()) {
+      return it->second.get();
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  auto &entry = entries[topic];
+  if (!entry) {
+    entry.reset(new Entry);
+    entry->value.store(std::make_shared<const std::string>());
+  }
+  return entry.get();
+}
+
+const Supla::MqttTopicStore::Entry *Supla::MqttTopicStore::getEntry(
+    const std::string &topic) {
+  return findOrCreate(topic);
+}
+
+void Supla::MqttTopicStore::subscribe(const std::string &topic) {
+  findOrCreate(topic);
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  subscribed.insert(topic);
+}
+
+void Supla::MqttTopicStore::unsubscribe(const std::string &topic) {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  subscribed.erase(topic);
+}
+
+std::unordered_map<std::string, std::string>
+Supla::MqttTopicStore::getSubscribedTopics() const {
+  std::unordered_map<std::string, std::string> result;
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  for (const auto &topic : subscribed) {
+    auto it = entries.find(topic);
+    result[topic] = it != entries.end() ? *it->second->getValue() : "";
+  }
+  return result;
+}
+
+void Supla::MqttTopicStore::update(const std::string &topic,
+                                   const std::string &value) {
+  auto entry = findOrCreate(topic);
+  entry->value.store(std::make_shared<const std::string>(value),
+                     std::memory_order_release);
+  entry->sequence.fetch_add(1, std::memory_order_release);
+  changeCount.fetch_add(1, std::memory_order_release);
+
+  if (eventFd >= 0) {
+    uint64_t one = 1;
+    // counter overflow (EAGAIN) still leaves eventfd readable
+    ssize_t ret = write(eventFd, &one, sizeof(one));
+    (void)ret;
+  }
+}
+
+uint32_t Supla::MqttTopicStore::getChangeCount() const {
+  return changeCount.load(std::memory_order_acquire);
+}
+
+int Supla::MqttTopicStore::getEventFd() const {
+  return eventFd;
+}
+
+void Supla::MqttTopicStore::clearEvent() {
+  if (eventFd >= 0) {
+    uint64_t value = 0;
+    ssize_t ret = read(eventFd, &value, sizeof(value));
+    (void)ret;
+  }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) AC SOFTWARE SP. Z O.O
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef EXTRAS_PORTING_LINUX_MQTT_TOPIC_STORE_H_
+#define EXTRAS_PORTING_LINUX_MQTT_TOPIC_STORE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Supla {
+
+/**
+ * Latest value of each MQTT topic, written from MQTT client thread and read
+ * from main loop.
+ *
+ * Entries are never removed, so readers may keep pointers to them and read
+ * values without looking up the map. Value is an immutable string swapped
+ * atomically, and sequence number is increased after each swap, so readers
+ * can check for changes with a single atomic load.
+ */
+class MqttTopicStore {
+ public:
+  class Entry {
+   public:
+    std::shared_ptr<const std::string> getValue() const;
+    uint32_t getSequence() const;
+
+   protected:
+    friend class MqttTopicStore;
+    std::atomic<std::shared_ptr<const std::string>> value;
+    std::atomic<uint32_t> sequence = 0;
+  };
+
+  MqttTopicStore();
+  ~MqttTopicStore();
+
+  MqttTopicStore(const MqttTopicStore &) = delete;
+  MqttTopicStore &operator=(const MqttTopicStore &) = delete;
+
+  // Returns entry for topic, entry is created when it doesn't exist
+  const Entry *getEntry(const std::string &topic);
+
+  void subscribe(const std::string &topic);
+  void unsubscribe(const std::string &topic);
+  // Returns subscribed topics with their current values
+  std::unordered_map<std::string, std::string> getSubscribedTopics() const;
+
+  // Stores new value of topic. Thread safe.
+  void update(const std::string &topic, const std::string &value);
+
+  // Increased on each update of any topic
+  uint32_t getChangeCount() const;
+
+  // Returns eventfd which becomes readable after update (for poll/epoll in
+  // main loop), -1 if eventfd is not available
+  int getEventFd() const;
+  // Clears eventfd readiness
+  void clearEvent();
+
+ protected:
+  Entry *findOrCreate(const std::string &topic);
+
+  mutable std::shared_mutex mutex;
+  std::unordered_map<std::string, std::unique_ptr<Entry>> entries;
+  std::unordered_set<std::string> subscribed;
+  std::atomic<uint32_t> changeCount = 0;
+  int eventFd = -1;
+};
+
+}  // namespace Supla
+
+#endif  // EXTRAS_PORTING_LINUX_MQTT_TOPIC_STORE_H_
@@ -19,9 +19,9 @@
 #include "cmd_relay.h"
 
 #include <supla/log_wrapper.h>
+#include <supla/output/cmd_executor.h>
 #include <supla/time.h>
 
-#include <cstdio>
 #include <string>
 
 Supla::Control::CmdRelay::CmdRelay(Supla::Parser::Parser *parser,
@@ -30,6 +30,10 @@ Supla::Control::CmdRelay::CmdRelay(Supla::Parser::Parser *parser,
   channel.setFuncList(functions);
 }
 
+Supla::Control::CmdRelay::~CmdRelay() {
+  Supla::Output::CmdExecutor::Instance()->cancel(this);
+}
+
 
 void Supla::Control::CmdRelay::onInit() {
   VirtualRelay::onInit();
@@ -41,8 +45,7 @@ void Supla::Control::CmdRelay::turnOn(_supla_int_t duration) {
   Supla::Control::VirtualRelay::turnOn(duration);
 
   if (cmdOn.length() > 0) {
-    auto p = popen(cmdOn.c_str(), "r");
-    pclose(p);
+    executeCmd(cmdOn, true);
   }
 }
 
@@ -50,11 +53,31 @@ void Supla::Control::CmdRelay::turnOff(_supla_int_t duration) {
   Supla::Control::VirtualRelay::turnOff(duration);
 
   if (cmdOff.length() > 0) {
-    auto p = popen(cmdOff.c_str(), "r");
-    pclose(p);
+    executeCmd(cmdOff, false);
   }
 }
 
+void Supla::Control::CmdRelay::executeCmd(const std::string &cmd, bool on) {
+  // only the newest of not started commands is executed
+  Supla::Output::CmdExecutor::Instance()->execute(
+      this,
+      cmd,
+      Supla::Output::CmdExecutor::Mode::LatestWins,
+      [this, on](const Supla::Output::CmdResult &result) {
+        if (result.isSuccess() || parser ||
+            Supla::Control::VirtualRelay::isOn() != on) {
+          return;
+        }
+        SUPLA_LOG_WARNING("CmdRelay[%d]: command failed, reverting state",
+                          getChannelNumber());
+        if (on) {
+          Supla::Control::VirtualRelay::turnOff();
+        } else {
+          Supla::Control::VirtualRelay::turnOn();
+        }
+      });
+}
+
 void Supla::Control::CmdRelay::setCmdOn(const std::string &newCmdOn) {
   cmdOn = newCmdOn;
 }
@@ -30,6 +30,7 @@ class CmdRelay : public Sensor::SensorParsed<VirtualRelay> {
  public:
   CmdRelay(Supla::Parser::Parser *parser, _supla_int_t functions =
                    (0xFF ^ SUPLA_BIT_FUNC_CONTROLLINGTHEROLLERSHUTTER));
+  ~CmdRelay();
 
   void onInit() override;
   void turnOn(_supla_int_t duration = 0) override;
@@ -43,6 +44,10 @@ class CmdRelay : public Sensor::SensorParsed<VirtualRelay> {
   void setUseOfflineOnInvalidState(bool useOfflineOnInvalidState);
 
  protected:
+  // Command is executed asynchronously. If it fails and relay state isn't
+  // read by parser, state is reverted.
+  void executeCmd(const std::string &cmd, bool on);
+
   std::string cmdOn;
   std::string cmdOff;
   uint32_t lastReadTime = 0;
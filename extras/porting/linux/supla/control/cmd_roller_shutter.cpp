@@ -19,9 +19,9 @@
 #include "cmd_roller_shutter.h"
 
 #include <supla/log_wrapper.h>
+#include <supla/output/cmd_executor.h>
 #include <supla/time.h>
 
-#include <cstdio>
 #include <string>
 
 Supla::Control::CmdRollerShutter::CmdRollerShutter(
@@ -30,31 +30,36 @@ Supla::Control::CmdRollerShutter::CmdRollerShutter(
   addTiltFunctions();
 }
 
+Supla::Control::CmdRollerShutter::~CmdRollerShutter() {
+  Supla::Output::CmdExecutor::Instance()->cancel(this);
+}
+
+void Supla::Control::CmdRollerShutter::executeCmd(const std::string &cmd) {
+  Supla::Output::CmdExecutor::Instance()->execute(
+      this, cmd, Supla::Output::CmdExecutor::Mode::Queue);
+}
+
 void Supla::Control::CmdRollerShutter::relayUpOn() {
   if (cmdUpOn.length() > 0) {
-    auto p = popen(cmdUpOn.c_str(), "r");
-    pclose(p);
+    executeCmd(cmdUpOn);
   }
 }
 
 void Supla::Control::CmdRollerShutter::relayDownOn() {
   if (cmdDownOn.length() > 0) {
-    auto p = popen(cmdDownOn.c_str(), "r");
-    pclose(p);
+    executeCmd(cmdDownOn);
   }
 }
 
 void Supla::Control::CmdRollerShutter::relayUpOff() {
   if (cmdUpOff.length() > 0) {
-    auto p = popen(cmdUpOff.c_str(), "r");
-    pclose(p);
+    executeCmd(cmdUpOff);
   }
 }
 
 void Supla::Control::CmdRollerShutter::relayDownOff() {
   if (cmdDownOff.length() > 0) {
-    auto p = popen(cmdDownOff.c_str(), "r");
-    pclose(p);
+    executeCmd(cmdDownOff);
   }
 }
 
@@ -29,6 +29,7 @@ namespace Control {
 class CmdRollerShutter : public Sensor::SensorParsed<RollerShutter> {
  public:
   explicit CmdRollerShutter(Supla::Parser::Parser *parser);
+  ~CmdRollerShutter();
 
   void relayDownOn() override;
   void relayUpOn() override;
@@ -47,6 +48,9 @@ class CmdRollerShutter : public Sensor::SensorParsed<RollerShutter> {
   void setUseOfflineOnInvalidState(bool useOfflineOnInvalidState);
 
  protected:
+  // Commands are queued, so their order is preserved
+  void executeCmd(const std::string &cmd);
+
   std::string cmdUpOn;
   std::string cmdUpOff;
   std::string cmdDownOn;
@@ -19,15 +19,19 @@
 #include "cmd_valve.h"
 
 #include <supla/log_wrapper.h>
+#include <supla/output/cmd_executor.h>
 #include <supla/time.h>
 
-#include <cstdio>
 #include <string>
 
 Supla::Control::CmdValve::CmdValve(Supla::Parser::Parser *parser)
     : Supla::Sensor::SensorParsed<Supla::Control::ValveBase>(parser) {
 }
 
+Supla::Control::CmdValve::~CmdValve() {
+  Supla::Output::CmdExecutor::Instance()->cancel(this);
+}
+
 
 void Supla::Control::CmdValve::onInit() {
   ValveBase::onInit();
@@ -39,13 +43,13 @@ void Supla::Control::CmdValve::setValueOnDevice(uint8_t openLevel) {
   // we support only open/close at the moment
   if (openLevel > 0) {
     if (cmdOpen.length() > 0) {
-      auto p = popen(cmdOpen.c_str(), "r");
-      pclose(p);
+      Supla::Output::CmdExecutor::Instance()->execute(
+          this, cmdOpen, Supla::Output::CmdExecutor::Mode::LatestWins);
     }
   } else {
     if (cmdClose.length() > 0) {
-      auto p = popen(cmdClose.c_str(), "r");
-      pclose(p);
+      Supla::Output::CmdExecutor::Instance()->execute(
+          this, cmdClose, Supla::Output::CmdExecutor::Mode::LatestWins);
     }
   }
 }
@@ -29,6 +29,7 @@ namespace Control {
 class CmdValve : public Sensor::SensorParsed<ValveBase> {
  public:
   explicit CmdValve(Supla::Parser::Parser *parser);
+  ~CmdValve();
 
   void onInit() override;
 
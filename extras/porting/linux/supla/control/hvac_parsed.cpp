@@ -21,8 +21,8 @@
 #include <supla/log_wrapper.h>
 #include <supla/time.h>
 #include <supla/control/output_interface.h>
+#include <supla/output/cmd_executor.h>
 
-#include <cstdio>
 #include <string>
 
 using Supla::Control::HvacParsed;
@@ -32,6 +32,7 @@ namespace Control {
 class CmdOutput : public OutputInterface {
  public:
   CmdOutput(std::string cmdOn, std::string cmdOff);
+  ~CmdOutput();
 
   int getOutputValue() const override;
   void setOutputValue(int value) override;
@@ -51,6 +52,10 @@ CmdOutput::CmdOutput(std::string cmdOn, std::string cmdOff) :
   cmdOn(cmdOn), cmdOff(cmdOff) {
 }
 
+CmdOutput::~CmdOutput() {
+  Supla::Output::CmdExecutor::Instance()->cancel(this);
+}
+
 int CmdOutput::getOutputValue() const {
   return lastState;
 }
@@ -59,13 +64,13 @@ void CmdOutput::setOutputValue(int value) {
   lastState = value;
   if (value == 1) {
     if (cmdOn.length() > 0) {
-      auto p = popen(cmdOn.c_str(), "r");
-      pclose(p);
+      Supla::Output::CmdExecutor::Instance()->execute(
+          this, cmdOn, Supla::Output::CmdExecutor::Mode::LatestWins);
     }
   } else if (value == 0) {
     if (cmdOff.length() > 0) {
-      auto p = popen(cmdOff.c_str(), "r");
-      pclose(p);
+      Supla::Output::CmdExecutor::Instance()->execute(
+          this, cmdOff, Supla::Output::CmdExecutor::Mode::LatestWins);
     }
   }
 }
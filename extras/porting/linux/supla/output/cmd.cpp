@@ -18,7 +18,6 @@
 
 #include <supla/log_wrapper.h>
 
-#include <cstdio>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -54,21 +53,23 @@ static std::string buildCmd(std::string_view cmdLine, std::string_view arg) {
   return cmd;
 }
 
-static bool execCmd(const std::string& cmd) {
-  SUPLA_LOG_DEBUG("Command: %s", cmd.c_str());
-  FILE* p = popen(cmd.c_str(), "r");
-  if (!p) {
-    SUPLA_LOG_WARNING("Failed to execute command: %s", cmd.c_str());
-    return false;
-  }
-  pclose(p);
-  return true;
-}
-
 Supla::Output::Cmd::Cmd(std::string cmd) : cmdLine(cmd) {
 }
 
 Supla::Output::Cmd::~Cmd() {
+  CmdExecutor::Instance()->cancel(this);
+}
+
+void Supla::Output::Cmd::setTimeoutMs(uint32_t timeoutMs) {
+  this->timeoutMs = timeoutMs;
+}
+
+bool Supla::Output::Cmd::execCmd(const std::string& cmd) {
+  uint32_t timeout =
+      timeoutMs ? timeoutMs : CmdExecutor::GetDefaultTimeoutMs();
+  CmdExecutor::Instance()->execute(
+      this, cmd, CmdExecutor::Mode::Queue, timeout, {});
+  return true;
 }
 
 bool Supla::Output::Cmd::putContent(int payload) {
@@ -17,9 +17,11 @@
 #ifndef EXTRAS_PORTING_LINUX_SUPLA_OUTPUT_CMD_H_
 #define EXTRAS_PORTING_LINUX_SUPLA_OUTPUT_CMD_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "cmd_executor.h"
 #include "output.h"
 
 namespace Supla {
@@ -30,8 +32,15 @@ class Cmd : public Output {
   explicit Cmd(std::string cmd);
   virtual ~Cmd();
 
+  // Commands are executed by CmdExecutor in order of putContent() calls.
+  // 0 - use CmdExecutor default timeout
+  void setTimeoutMs(uint32_t timeoutMs);
+
  protected:
+  bool execCmd(const std::string &cmd);
+
   std::string cmdLine;
+  uint32_t timeoutMs = 0;
 
  private:
   bool putContent(int payload) override;
@@ -0,0 +1,322 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "cmd_executor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux_event_loop.h>
+#include <poll.h>
+#include <signal.h>
+#include <supla/log_wrapper.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <utility>
+
+int Supla::Output::CmdExecutor::concurrency = 4;
+uint32_t Supla::Output::CmdExecutor::defaultTimeoutMs = 0;
+
+Supla::Output::CmdExecutor *Supla::Output::CmdExecutor::Instance() {
+  static CmdExecutor executor;
+  return &executor;
+}
+
+void Supla::Output::CmdExecutor::SetConcurrency(int count) {
+  if (count < 1) {
+    count = 1;
+  }
+  concurrency = count;
+}
+
+void Supla::Output::CmdExecutor::SetDefaultTimeoutMs(uint32_t timeoutMs) {
+  defaultTimeoutMs = timeoutMs;
+}
+
+uint32_t Supla::Output::CmdExecutor::GetDefaultTimeoutMs() {
+  return defaultTimeoutMs;
+}
+
+Supla::Output::CmdResult Supla::Output::CmdExecutor::Run(
+    const std::string &cmd,
+    uint32_t timeoutMs,
+    const std::function<void(pid_t)> &onStarted) {
+  CmdResult result;
+  result.cmd = cmd;
+  auto start = std::chrono::steady_clock::now();
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    SUPLA_LOG_WARNING("Failed to execute command: %s", cmd.c_str());
+    return result;
+  }
+
+  if (pid == 0) {
+    // child: own process group, so whole command tree can be killed
+    setpgid(0, 0);
+    int devNull = open("/dev/null", O_RDWR);
+    if (devNull >= 0) {
+      dup2(devNull, STDIN_FILENO);
+      dup2(devNull, STDOUT_FILENO);
+      close(devNull);
+    }
+    execl("/bin/sh", "sh", "-c", cmd.c_str(), static_cast<char *>(nullptr));
+    _exit(127);
+  }
+  setpgid(pid, pid);
+  if (onStarted) {
+    onStarted(pid);
+  }
+
+  int status = 0;
+  bool exited = false;
+  if (timeoutMs == 0) {
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    exited = true;
+  } else {
+    // pidfd becomes readable when process exits. Without pidfd support
+    // (kernel < 5.3) exit is checked every 10 ms.
+    int pidFd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    auto deadline = start + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+      pid_t ret = waitpid(pid, &status, WNOHANG);
+      if (ret == pid) {
+        exited = true;
+        break;
+      }
+      if (ret < 0 && errno != EINTR) {
+        break;
+      }
+      auto left = std::chrono::ceil<std::chrono::milliseconds>(
+                      deadline - std::chrono::steady_clock::now())
+                      .count();
+      if (left <= 0) {
+        result.timedOut = true;
+        break;
+      }
+      if (pidFd >= 0) {
+        struct pollfd pfd = {pidFd, POLLIN, 0};
+        poll(&pfd, 1, static_cast<int>(left));
+      } else {
+        poll(nullptr, 0, std::min<int>(left, 10));
+      }
+    }
+    if (pidFd >= 0) {
+      close(pidFd);
+    }
+
+    if (result.timedOut) {
+      SUPLA_LOG_WARNING("Command: \"%s\" timeout after %u ms, killing",
+                        cmd.c_str(),
+                        timeoutMs);
+      kill(-pid, SIGKILL);
+      while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+      }
+    }
+  }
+
+  if (exited && WIFEXITED(status)) {
+    result.exitCode = WEXITSTATUS(status);
+  }
+  result.durationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  return result;
+}
+
+Supla::Output::CmdExecutor::CmdExecutor() {
+}
+
+Supla::Output::CmdExecutor::~CmdExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopRequested = true;
+    readyKeys.clear();
+    for (pid_t pid : runningPids) {
+      kill(-pid, SIGKILL);
+    }
+  }
+  cv.notify_all();
+  for (auto &worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void Supla::Output::CmdExecutor::startWorkers() {
+  SUPLA_LOG_DEBUG("CmdExecutor: starting %d workers", concurrency);
+  for (int i = 0; i < concurrency; i++) {
+    workers.emplace_back(&CmdExecutor::workerLoop, this);
+  }
+}
+
+void Supla::Output::CmdExecutor::execute(const void *key,
+                                         const std::string &cmd,
+                                         Mode mode,
+                                         Callback onDone) {
+  execute(key, cmd, mode, defaultTimeoutMs, std::move(onDone));
+}
+
+void Supla::Output::CmdExecutor::execute(const void *key,
+                                         const std::string &cmd,
+                                         Mode mode,
+                                         uint32_t timeoutMs,
+                                         Callback onDone) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (workers.empty()) {
+      startWorkers();
+    }
+    auto &queue = queues[key];
+    // key is in readyKeys when it has pending commands and none is running
+    bool isReady = !queue.running && !queue.pending.empty();
+    if (mode == Mode::LatestWins && !queue.pending.empty()) {
+      stats.superseded += queue.pending.size();
+      queue.pending.clear();
+    }
+    queue.pending.push_back(Job{cmd, timeoutMs, std::move(onDone)});
+    if (queue.running || isReady) {
+      return;
+    }
+    readyKeys.push_back(key);
+  }
+  cv.notify_one();
+}
+
+void Supla::Output::CmdExecutor::cancel(const void *key) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = queues.find(key);
+  if (it != queues.end()) {
+    it->second.pending.clear();
+    if (it->second.running) {
+      it->second.dropRunningResult = true;
+    } else {
+      queues.erase(it);
+    }
+  }
+  readyKeys.erase(std::remove(readyKeys.begin(), readyKeys.end(), key),
+                  readyKeys.end());
+  results.erase(std::remove_if(results.begin(),
+                               results.end(),
+                               [key](const Result &r) { return r.key == key; }),
+                results.end());
+}
+
+void Supla::Output::CmdExecutor::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    cv.wait(lock, [this]() { return stopRequested || !readyKeys.empty(); });
+    if (stopRequested) {
+      return;
+    }
+    const void *key = readyKeys.front();
+    readyKeys.pop_front();
+    auto &queue = queues[key];
+    Job job = std::move(queue.pending.front());
+    queue.pending.pop_front();
+    queue.running = true;
+    running++;
+    stats.maxRunning = std::max(stats.maxRunning, running);
+
+    lock.unlock();
+    SUPLA_LOG_DEBUG("Command: %s", job.cmd.c_str());
+    pid_t pid = 0;
+    CmdResult result = Run(job.cmd, job.timeoutMs, [&](pid_t startedPid) {
+      std::lock_guard<std::mutex> pidLock(mutex);
+      pid = startedPid;
+      if (stopRequested) {
+        kill(-pid, SIGKILL);
+      } else {
+        runningPids.insert(pid);
+      }
+    });
+    if (!result.isSuccess() && !result.timedOut) {
+      SUPLA_LOG_WARNING("Command: \"%s\" failed (exit code %d)",
+                        job.cmd.c_str(),
+                        result.exitCode);
+    }
+    lock.lock();
+
+    runningPids.erase(pid);
+    running--;
+    stats.executed++;
+    stats.maxDurationMs = std::max(stats.maxDurationMs, result.durationMs);
+    if (result.timedOut) {
+      stats.timeouts++;
+    } else if (!result.isSuccess()) {
+      stats.failed++;
+    }
+
+    // entry isn't removed by cancel() while command is running
+    auto it = queues.find(key);
+    it->second.running = false;
+    if (it->second.dropRunningResult) {
+      it->second.dropRunningResult = false;
+    } else {
+      results.push_back(Result{key, std::move(result), std::move(job.onDone)});
+      hasResults = true;
+    }
+    if (!it->second.pending.empty()) {
+      readyKeys.push_back(key);
+      cv.notify_one();
+    } else {
+      queues.erase(it);
+    }
+    idleCv.notify_all();
+
+    // callbacks are called from main loop
+    Supla::Linux::EventLoop::WakeUp();
+  }
+}
+
+void Supla::Output::CmdExecutor::processResults() {
+  if (!hasResults) {
+    return;
+  }
+  std::vector<Result> finished;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished.swap(results);
+    hasResults = false;
+  }
+  for (auto &result : finished) {
+    if (result.onDone) {
+      result.onDone(result.result);
+    }
+  }
+}
+
+void Supla::Output::CmdExecutor::iterateAlways() {
+  processResults();
+}
+
+bool Supla::Output::CmdExecutor::waitForIdle(uint32_t timeoutMs) {
+  std::unique_lock<std::mutex> lock(mutex);
+  return idleCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() {
+    return running == 0 && readyKeys.empty();
+  });
+}
+
+Supla::Output::CmdExecutorStats Supla::Output::CmdExecutor::getStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
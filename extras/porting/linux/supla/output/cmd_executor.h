@@ -0,0 +1,167 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef EXTRAS_PORTING_LINUX_SUPLA_OUTPUT_CMD_EXECUTOR_H_
+#define EXTRAS_PORTING_LINUX_SUPLA_OUTPUT_CMD_EXECUTOR_H_
+
+#include <supla/element.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace Supla {
+namespace Output {
+
+struct CmdResult {
+  std::string cmd;
+  // exit code of shell, -1 if command wasn't started or was killed
+  int exitCode = -1;
+  bool timedOut = false;
+  uint32_t durationMs = 0;
+
+  bool isSuccess() const {
+    return exitCode == 0 && !timedOut;
+  }
+};
+
+struct CmdExecutorStats {
+  uint32_t executed = 0;
+  uint32_t failed = 0;
+  uint32_t timeouts = 0;
+  // pending commands replaced by newer one in LatestWins mode
+  uint32_t superseded = 0;
+  uint32_t maxRunning = 0;
+  uint32_t maxDurationMs = 0;
+};
+
+/**
+ * Executes shell commands of command based outputs (Cmd output, CmdRelay,
+ * CmdRollerShutter, ...) on worker threads, so slow command doesn't block
+ * main loop.
+ *
+ * Commands with the same key (usually channel or output object) are executed
+ * one at a time in order of execute() calls. At most "concurrency" commands
+ * run at the same time. Results are passed to callbacks from iterateAlways(),
+ * so callbacks run on main loop thread and may modify channel state.
+ */
+class CmdExecutor : public Supla::Element {
+ public:
+  enum class Mode {
+    // command is appended to key's queue
+    Queue,
+    // commands of the key which didn't start yet are dropped
+    LatestWins
+  };
+  using Callback = std::function<void(const CmdResult &)>;
+
+  static CmdExecutor *Instance();
+  // Has to be called before first command is executed
+  static void SetConcurrency(int count);
+  // Default timeout used by execute(), 0 - no timeout
+  static void SetDefaultTimeoutMs(uint32_t timeoutMs);
+  static uint32_t GetDefaultTimeoutMs();
+
+  /**
+   * Runs command with "/bin/sh -c" and waits for its exit. After timeout
+   * (if not 0) whole process group of command is killed. Output of command
+   * is discarded. onStarted is called with pid (and process group id) of
+   * started command.
+   */
+  static CmdResult Run(const std::string &cmd,
+                       uint32_t timeoutMs,
+                       const std::function<void(pid_t)> &onStarted = {});
+
+  CmdExecutor();
+  // Kills process groups of running commands, so commands without timeout
+  // don't block exit
+  virtual ~CmdExecutor();
+
+  void execute(const void *key,
+               const std::string &cmd,
+               Mode mode = Mode::Queue,
+               Callback onDone = {});
+  void execute(const void *key,
+               const std::string &cmd,
+               Mode mode,
+               uint32_t timeoutMs,
+               Callback onDone);
+  // Drops pending commands and results of key (i.e. when owner is deleted)
+  void cancel(const void *key);
+
+  // Calls callbacks of finished commands
+  void processResults();
+  void iterateAlways() override;
+
+  // Waits until all commands finished, returns false on timeout
+  bool waitForIdle(uint32_t timeoutMs);
+  CmdExecutorStats getStats();
+
+ protected:
+  struct Job {
+    std::string cmd;
+    uint32_t timeoutMs = 0;
+    Callback onDone;
+  };
+
+  struct KeyQueue {
+    std::deque<Job> pending;
+    bool running = false;
+    // set by cancel() while command is running
+    bool dropRunningResult = false;
+  };
+
+  struct Result {
+    const void *key = nullptr;
+    CmdResult result;
+    Callback onDone;
+  };
+
+  void startWorkers();
+  void workerLoop();
+
+  static int concurrency;
+  static uint32_t defaultTimeoutMs;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::condition_variable idleCv;
+  std::map<const void *, KeyQueue> queues;
+  // keys with pending commands and without running command
+  std::deque<const void *> readyKeys;
+  std::vector<Result> results;
+  std::vector<std::thread> workers;
+  // process groups of running commands
+  std::set<pid_t> runningPids;
+  uint32_t running = 0;
+  std::atomic<bool> hasResults = false;
+  bool stopRequested = false;
+  CmdExecutorStats stats;
+};
+
+}  // namespace Output
+}  // namespace Supla
+
+#endif  // EXTRAS_PORTING_LINUX_SUPLA_OUTPUT_CMD_EXECUTOR_H_
@@ -18,8 +18,178 @@
 
 #include <supla/log_wrapper.h>
 
-#include <stdexcept>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+struct CachedDocument {
+  std::shared_ptr<const Supla::Source::Snapshot> snapshot;
+  std::shared_ptr<const nlohmann::json> json;
+};
+
+std::map<const Supla::Source::Source*, CachedDocument> documentCache;
+Supla::Parser::JsonCacheStats cacheStats;
+
+// SAX handler which follows path of current value in a trie built from
+// compiled keys and extracts only values of matching keys
+class JsonStreamExtractor : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  struct Node {
+    std::map<std::string, size_t> children;
+    // slots of keys which end in this node
+    std::vector<size_t> pointerSlots;
+    std::vector<size_t> plainSlots;
+  };
+
+  using ExtractFn = void (*)(const nlohmann::json*, void*, size_t);
+
+  JsonStreamExtractor(const std::vector<Node>& nodes,
+                      ExtractFn extractFn,
+                      void* extractCtx)
+      : nodes(nodes), extractFn(extractFn), extractCtx(extractCtx) {
+  }
+
+  bool null() override {
+    return scalar(nlohmann::json());
+  }
+  bool boolean(bool val) override {
+    return scalar(nlohmann::json(val));
+  }
+  bool number_integer(number_integer_t val) override {
+    return scalar(nlohmann::json(val));
+  }
+  bool number_unsigned(number_unsigned_t val) override {
+    return scalar(nlohmann::json(val));
+  }
+  bool number_float(number_float_t val, const string_t&) override {
+    return scalar(nlohmann::json(val));
+  }
+  bool string(string_t& val) override {  // NOLINT(runtime/references)
+    int node = nextNode();
+    if (node >= 0 && hasSlots(node)) {
+      nlohmann::json value(std::move(val));
+      assign(node, &value);
+    }
+    return true;
+  }
+  bool binary(binary_t&) override {  // NOLINT(runtime/references)
+    return container(false, false);
+  }
+  bool start_object(std::size_t) override {
+    return container(true, false);
+  }
+  bool key(string_t& val) override {  // NOLINT(runtime/references)
+    stack.back().key = std::move(val);
+    return true;
+  }
+  bool end_object() override {
+    stack.pop_back();
+    return true;
+  }
+  bool start_array(std::size_t) override {
+    return container(true, true);
+  }
+  bool end_array() override {
+    stack.pop_back();
+    return true;
+  }
+  bool parse_error(std::size_t position,
+                   const std::string&,
+                   const nlohmann::detail::exception&) override {
+    SUPLA_LOG_ERROR("JSON parsing error at byte %d",
+                    static_cast<int>(position));
+    return false;
+  }
+
+ protected:
+  struct Frame {
+    int node = -1;
+    bool isArray = false;
+    size_t index = 0;
+    std::string key;
+  };
+
+  // Returns trie node of value which is being parsed, -1 if no key matches
+  // it or any of its children
+  int nextNode() {
+    if (stack.empty()) {
+      return 0;
+    }
+    auto& frame = stack.back();
+    if (frame.isArray) {
+      size_t index = frame.index++;
+      if (frame.node < 0) {
+        return -1;
+      }
+      lastViaArray = true;
+      return findChild(frame.node, std::to_string(index));
+    }
+    if (frame.node < 0) {
+      return -1;
+    }
+    lastViaArray = false;
+    return findChild(frame.node, frame.key);
+  }
+
+  int findChild(int node, const std::string& token) const {
+    const auto& children = nodes[node].children;
+    auto it = children.find(token);
+    return it == children.end() ? -1 : static_cast<int>(it->second);
+  }
+
+  bool hasSlots(int node) const {
+    return !nodes[node].pointerSlots.empty() ||
+           (!lastViaArray && !nodes[node].plainSlots.empty());
+  }
+
+  void assign(int node, const nlohmann::json* value) {
+    for (auto slot : nodes[node].pointerSlots) {
+      extractFn(value, extractCtx, slot);
+    }
+    if (!lastViaArray) {
+      for (auto slot : nodes[node].plainSlots) {
+        extractFn(value, extractCtx, slot);
+      }
+    }
+  }
+
+  bool scalar(const nlohmann::json& value) {
+    int node = nextNode();
+    if (node >= 0 && hasSlots(node)) {
+      assign(node, &value);
+    }
+    return true;
+  }
+
+  bool container(bool push, bool isArray) {
+    int node = nextNode();
+    if (node >= 0 && hasSlots(node)) {
+      // objects and arrays can't be used as values, but key is present
+      nlohmann::json value = isArray ? nlohmann::json::array()
+                                     : nlohmann::json::object();
+      assign(node, &value);
+    }
+    if (push) {
+      Frame frame;
+      frame.node = node;
+      frame.isArray = isArray;
+      stack.push_back(std::move(frame));
+    }
+    return true;
+  }
+
+  const std::vector<Node>& nodes;
+  ExtractFn extractFn = nullptr;
+  void* extractCtx = nullptr;
+  std::vector<Frame> stack;
+  bool lastViaArray = false;
+};
+}  // namespace
 
 Supla::Parser::Json::Json(Supla::Source::Source* src)
     : Supla::Parser::Parser(src) {
@@ -31,128 +201,294 @@ Supla::Parser::Json::~Json() {
 bool Supla::Parser::Json::refreshSource() {
   valid = false;
   if (source) {
-    std::string sourceContent = source->getContent();
+    auto snapshot = source->getSnapshot();
 
-    if (sourceContent.length() == 0) {
+    if (snapshot->content.length() == 0) {
       return valid;
     }
 
-    try {
-      json = nlohmann::json::parse(sourceContent);
-    } catch (nlohmann::json::parse_error& ex) {
-      SUPLA_LOG_ERROR("JSON parsing error at byte %d", ex.byte);
-      SUPLA_LOG_ERROR("JSON Source: \n%s", sourceContent.c_str());
+    if (streaming) {
+      if (snapshot != streamedSnapshot) {
+        streamedSnapshot = snapshot;
+        streamValid = extractFromStream();
+      }
+      valid = streamValid;
       return valid;
     }
 
-    valid = true;
+    json = getDocument(source, snapshot);
+    valid = (json != nullptr);
+    extractAll();
   }
   return valid;
 }
 
-bool Supla::Parser::Json::isValid() {
-  return valid;
+void Supla::Parser::Json::setStreaming(bool streaming) {
+  this->streaming = streaming;
+  json = nullptr;
+  streamedSnapshot = nullptr;
 }
 
-double Supla::Parser::Json::getValue(const std::string& key) {
-  try {
-    const nlohmann::json* valuePtr = nullptr;
+bool Supla::Parser::Json::isStreaming() const {
+  return streaming;
+}
 
-    if (!key.empty() && key[0] == '/') {
-      nlohmann::json::json_pointer ptr(key);
+bool Supla::Parser::Json::extractFromStream() {
+  for (auto& value : values) {
+    value = {};
+  }
+  if (!streamedSnapshot) {
+    return false;
+  }
 
-      if (!json.contains(ptr)) {
-        SUPLA_LOG_ERROR("JSON key \"%s\" not found", key.c_str());
-        valid = false;
-        return 0;
+  std::vector<JsonStreamExtractor::Node> nodes(1);
+  for (size_t slot = 0; slot < compiledKeys.size(); slot++) {
+    const auto& key = compiledKeys[slot];
+    if (key.isMalformed) {
+      continue;
+    }
+    size_t node = 0;
+    for (const auto& token : key.tokens) {
+      auto it = nodes[node].children.find(token);
+      if (it == nodes[node].children.end()) {
+        nodes.emplace_back();
+        it = nodes[node].children.emplace(token, nodes.size() - 1).first;
       }
-
-      valuePtr = &json.at(ptr);
+      node = it->second;
+    }
+    if (key.isPointer) {
+      nodes[node].pointerSlots.push_back(slot);
     } else {
-      if (!json.contains(key)) {
-        SUPLA_LOG_ERROR("JSON key \"%s\" not found", key.c_str());
-        valid = false;
-        return 0;
-      }
+      nodes[node].plainSlots.push_back(slot);
+    }
+  }
 
-      valuePtr = &json.at(key);
+  JsonStreamExtractor extractor(
+      nodes,
+      [](const nlohmann::json* value, void* ctx, size_t slot) {
+        auto parser = static_cast<Json*>(ctx);
+        extract(value, &parser->values[slot]);
+      },
+      this);
+  bool result =
+      nlohmann::json::sax_parse(streamedSnapshot->content, &extractor);
+  if (!result) {
+    for (auto& value : values) {
+      value = {};
     }
+  }
+  return result;
+}
 
-    if (valuePtr->is_number()) {
-      return valuePtr->get<double>();
+std::shared_ptr<const nlohmann::json> Supla::Parser::Json::getDocument(
+    const Supla::Source::Source* source,
+    const std::shared_ptr<const Supla::Source::Snapshot>& snapshot) {
+  auto& cached = documentCache[source];
+  if (cached.snapshot == snapshot) {
+    cacheStats.parsesSaved++;
+    return cached.json;
+  }
+
+  cached.snapshot = snapshot;
+  cached.json = nullptr;
+  cacheStats.parses++;
+  try {
+    cached.json = std::make_shared<const nlohmann::json>(
+        nlohmann::json::parse(snapshot->content));
+  } catch (nlohmann::json::parse_error& ex) {
+    SUPLA_LOG_ERROR("JSON parsing error at byte %d", ex.byte);
+    SUPLA_LOG_ERROR("JSON Source: \n%s", snapshot->content.c_str());
+  }
+  return cached.json;
+}
+
+Supla::Parser::JsonCacheStats Supla::Parser::Json::GetCacheStats() {
+  return cacheStats;
+}
+
+void Supla::Parser::Json::ClearCache() {
+  documentCache.clear();
+  cacheStats = {};
+}
+
+bool Supla::Parser::Json::isValid() {
+  return valid;
+}
+
+void Supla::Parser::Json::addKey(const std::string& key, int index) {
+  Parser::addKey(key, index);
+  getExtracted(key);
+}
+
+Supla::Parser::Json::CompiledKey Supla::Parser::Json::compileKey(
+    const std::string& key) {
+  CompiledKey compiled;
+  if (key.empty() || key[0] != '/') {
+    compiled.tokens.push_back(key);
+    return compiled;
+  }
+
+  compiled.isPointer = true;
+  std::string token;
+  for (size_t i = 1; i <= key.length(); i++) {
+    if (i == key.length() || key[i] == '/') {
+      compiled.tokens.push_back(token);
+      token.clear();
+    } else if (key[i] == '~') {
+      // RFC 6901 escapes: "~0" -> '~', "~1" -> '/'
+      if (i + 1 < key.length() && (key[i + 1] == '0' || key[i + 1] == '1')) {
+        token.push_back(key[i + 1] == '0' ? '~' : '/');
+        i++;
+      } else {
+        compiled.isMalformed = true;
+      }
+    } else {
+      token.push_back(key[i]);
     }
+  }
+  return compiled;
+}
 
-    if (valuePtr->is_string()) {
-      // Try to convert string to double
-      try {
-        return std::stod(valuePtr->get<std::string>());
-      } catch (...) {
-        SUPLA_LOG_ERROR("JSON key \"%s\" string cannot be converted to double",
-                        key.c_str());
-        valid = false;
-        return 0;
+const nlohmann::json* Supla::Parser::Json::resolve(
+    const nlohmann::json& document, const CompiledKey& key) {
+  if (key.isMalformed) {
+    return nullptr;
+  }
+
+  const nlohmann::json* current = &document;
+  for (const auto& token : key.tokens) {
+    if (current->is_object()) {
+      auto it = current->find(token);
+      if (it == current->end()) {
+        return nullptr;
+      }
+      current = &(*it);
+    } else if (key.isPointer && current->is_array()) {
+      // array index: digits only, without leading zeros
+      if (token.empty() || (token.length() > 1 && token[0] == '0') ||
+          token.find_first_not_of("0123456789") != std::string::npos) {
+        return nullptr;
       }
+      size_t index = std::strtoul(token.c_str(), nullptr, 10);
+      if (index >= current->size()) {
+        return nullptr;
+      }
+      current = &(*current)[index];
+    } else {
+      return nullptr;
     }
+  }
+  return current;
+}
 
-    SUPLA_LOG_ERROR("JSON key \"%s\" has invalid data type (double expected)",
-                    key.c_str());
-    valid = false;
-    return 0;
-  } catch (const nlohmann::json::out_of_range&) {
-    SUPLA_LOG_ERROR("JSON key \"%s\" not found", key.c_str());
-    valid = false;
-  } catch (const nlohmann::json::type_error&) {
-    SUPLA_LOG_ERROR("JSON key \"%s\" has invalid data type (double expected)",
-                    key.c_str());
-    valid = false;
-  } catch (const std::exception& ex) {
-    SUPLA_LOG_ERROR("JSON exception during getValue for key \"%s\": %s",
-                    key.c_str(), ex.what());
-    valid = false;
+void Supla::Parser::Json::extract(const nlohmann::json* value,
+                                  ExtractedValue* result) {
+  *result = {};
+  if (value == nullptr) {
+    return;
   }
 
-  return 0;
+  if (value->is_boolean()) {
+    result->type = ValueType::Boolean;
+    result->state = value->get<bool>();
+  } else if (value->is_number()) {
+    result->type = ValueType::Number;
+    result->hasNumber = true;
+    result->number = value->get<double>();
+    // conversion of value out of int range is undefined, so it is clamped
+    if (result->number >= std::numeric_limits<int>::max()) {
+      result->state = std::numeric_limits<int>::max();
+    } else if (result->number <= std::numeric_limits<int>::min()) {
+      result->state = std::numeric_limits<int>::min();
+    } else {
+      result->state = value->get<int>();
+    }
+  } else if (value->is_string()) {
+    result->type = ValueType::String;
+    const auto& str = value->get_ref<const std::string&>();
+    result->state = str;
+    // Try to convert string to double
+    char* end = nullptr;
+    double number = std::strtod(str.c_str(), &end);
+    if (end != str.c_str()) {
+      result->hasNumber = true;
+      result->number = number;
+    }
+  } else {
+    result->type = ValueType::Other;
+  }
 }
 
-std::variant<int, bool, std::string> Supla::Parser::Json::getStateValue(
+void Supla::Parser::Json::extractAll() {
+  for (size_t i = 0; i < compiledKeys.size(); i++) {
+    extract(json ? resolve(*json, compiledKeys[i]) : nullptr, &values[i]);
+  }
+}
+
+const Supla::Parser::Json::ExtractedValue& Supla::Parser::Json::getExtracted(
     const std::string& key) {
-  try {
-    if (key[0] == '/') {
-      return json[nlohmann::json::json_pointer(key)].get<bool>();
-    } else {
-      return json[key].get<bool>();
+  auto slot = keySlots.find(key);
+  if (slot != keySlots.end()) {
+    return values[slot->second];
+  }
+
+  size_t index = compiledKeys.size();
+  keySlots[key] = index;
+  compiledKeys.push_back(compileKey(key));
+  values.emplace_back();
+  if (streaming) {
+    // new key requires another pass over current content
+    extractFromStream();
+  } else {
+    extract(json ? resolve(*json, compiledKeys[index]) : nullptr,
+            &values[index]);
+  }
+  return values[index];
+}
+
+double Supla::Parser::Json::getValue(const std::string& key) {
+  const auto& value = getExtracted(key);
+  switch (value.type) {
+    case ValueType::Missing: {
+      SUPLA_LOG_ERROR("JSON key \"%s\" not found", key.c_str());
+      break;
     }
-  } catch (nlohmann::json::type_error& ex) {
-    try {
-      if (key[0] == '/') {
-        return json[nlohmann::json::json_pointer(key)].get<int>();
-      } else {
-        return json[key].get<int>();
-      }
-    } catch (nlohmann::json::type_error& ex) {
-      try {
-        if (key[0] == '/') {
-          return json[nlohmann::json::json_pointer(key)].get<std::string>();
-        } else {
-          return json[key].get<std::string>();
-        }
-      } catch (nlohmann::json::type_error& ex) {
-        valid = false;
-      } catch (...) {
-        SUPLA_LOG_ERROR("JSON exception during getStateValue for key \"%s\"",
-                        key.c_str());
-        valid = false;
+    case ValueType::Number: {
+      return value.number;
+    }
+    case ValueType::String: {
+      if (value.hasNumber) {
+        return value.number;
       }
-    } catch (...) {
-      SUPLA_LOG_ERROR("JSON exception during getStateValue for key \"%s\"",
+      SUPLA_LOG_ERROR("JSON key \"%s\" string cannot be converted to double",
                       key.c_str());
-      valid = false;
+      break;
+    }
+    default: {
+      SUPLA_LOG_ERROR(
+          "JSON key \"%s\" has invalid data type (double expected)",
+          key.c_str());
+      break;
     }
-  } catch (...) {
-    SUPLA_LOG_ERROR("JSON exception during getStateValue for key \"%s\"",
-                    key.c_str());
-    valid = false;
   }
+  valid = false;
+  return 0;
+}
+
+std::variant<int, bool, std::string> Supla::Parser::Json::getStateValue(
+    const std::string& key) {
+  const auto& value = getExtracted(key);
+  switch (value.type) {
+    case ValueType::Boolean:
+    case ValueType::Number:
+    case ValueType::String: {
+      return value.state;
+    }
+    default: {
+      break;
+    }
+  }
+  valid = false;
   return 0;
 }
 
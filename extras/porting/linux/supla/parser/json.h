@@ -22,7 +22,9 @@
 #include <supla/source/source.h>
 
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <nlohmann/json.hpp>
 
@@ -30,6 +32,12 @@
 
 namespace Supla {
 namespace Parser {
+
+struct JsonCacheStats {
+  uint32_t parses = 0;
+  uint32_t parsesSaved = 0;
+};
+
 class Json : public Parser {
  public:
   explicit Json(Supla::Source::Source *);
@@ -37,6 +45,8 @@ class Json : public Parser {
 
   bool refreshSource() override;
 
+  // Key is compiled once here and its value is extracted on each refresh
+  void addKey(const std::string &key, int index) override;
   double getValue(const std::string &key) override;
   std::variant<int, bool, std::string> getStateValue(
       const std::string &key) override;
@@ -44,11 +54,65 @@ class Json : public Parser {
   bool isBasedOnIndex() override;
   bool isValid() override;
 
+  /**
+   * In streaming mode JSON document isn't built. Content is parsed with SAX
+   * parser and only values of registered keys are extracted, which is faster
+   * and uses much less memory for large sources with a few mapped keys.
+   */
+  void setStreaming(bool streaming);
+  bool isStreaming() const;
+
+  static JsonCacheStats GetCacheStats();
+  static void ClearCache();
+
  protected:
+  /**
+   * Returns document parsed from source snapshot. Document is parsed once
+   * per snapshot and shared between all Json parsers using the same source.
+   * Returns nullptr when snapshot isn't a valid JSON.
+   */
+  static std::shared_ptr<const nlohmann::json> getDocument(
+      const Supla::Source::Source *source,
+      const std::shared_ptr<const Supla::Source::Snapshot> &snapshot);
+
+  // Key split into JSON pointer reference tokens ("/a/b" -> "a", "b").
+  // Key without leading '/' is a single object member name.
+  struct CompiledKey {
+    std::vector<std::string> tokens;
+    bool isPointer = false;
+    bool isMalformed = false;
+  };
+
+  enum class ValueType : uint8_t { Missing, Boolean, Number, String, Other };
+
+  struct ExtractedValue {
+    ValueType type = ValueType::Missing;
+    // number or string converted to number
+    bool hasNumber = false;
+    double number = 0;
+    std::variant<int, bool, std::string> state = 0;
+  };
+
+  static CompiledKey compileKey(const std::string &key);
+  static const nlohmann::json *resolve(const nlohmann::json &document,
+                                       const CompiledKey &key);
+  static void extract(const nlohmann::json *value, ExtractedValue *result);
+  // Returns value extracted from current document, key which wasn't added
+  // with addKey() is compiled on first use
+  const ExtractedValue &getExtracted(const std::string &key);
+  void extractAll();
+  // Extracts values of all compiled keys from snapshot in streaming mode
+  bool extractFromStream();
+
   bool valid = false;
-  std::map<std::string, int> keys;
+  bool streaming = false;
+  bool streamValid = false;
+  std::shared_ptr<const Supla::Source::Snapshot> streamedSnapshot;
 
-  nlohmann::json json;
+  std::shared_ptr<const nlohmann::json> json;
+  std::unordered_map<std::string, size_t> keySlots;
+  std::vector<CompiledKey> compiledKeys;
+  std::vector<ExtractedValue> values;
 };
 };  // namespace Parser
 };  // namespace Supla
@@ -31,6 +31,21 @@ bool Supla::Parser::Parser::isValid() {
 }
 
 bool Supla::Parser::Parser::refreshParserSource() {
+  if (source && source->isEventDriven()) {
+    // Event driven source reports new content by itself, so here we only
+    // request periodic refresh and parse content when it changes
+    if (!lastRefreshTime || millis() - lastRefreshTime > refreshTimeMs) {
+      lastRefreshTime = millis();
+      source->requestRefresh();
+    }
+    uint32_t generation = source->getContentGeneration();
+    if (generation != lastContentGeneration) {
+      lastContentGeneration = generation;
+      return refreshSource();
+    }
+    return true;
+  }
+
   if (!lastRefreshTime || millis() - lastRefreshTime > refreshTimeMs) {
     lastRefreshTime = millis();
     return refreshSource();
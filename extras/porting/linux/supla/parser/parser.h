@@ -50,6 +50,7 @@ class Parser {
   bool valid = false;
   Supla::Source::Source *source = nullptr;
   uint32_t lastRefreshTime = 0;
+  uint32_t lastContentGeneration = 0;
   unsigned int refreshTimeMs = 5 * 1000;  // 5 s
 };
 };  // namespace Parser
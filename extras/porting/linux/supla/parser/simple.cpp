@@ -16,7 +16,8 @@
 
 #include "simple.h"
 
-#include <sstream>
+#include <charconv>
+#include <climits>
 #include <string>
 
 Supla::Parser::Simple::Simple(Supla::Source::Source *src)
@@ -26,80 +27,137 @@ Supla::Parser::Simple::Simple(Supla::Source::Source *src)
 Supla::Parser::Simple::~Simple() {
 }
 
-double Supla::Parser::Simple::getValue(const std::string &key) {
+const Supla::Parser::Simple::Value *Supla::Parser::Simple::getLineValue(
+    const std::string &key) {
   int index = keys[key];
-  if (index < 0 || static_cast<size_t>(index) >= values.size()) {
+  if (index < 0 || static_cast<size_t>(index) >= valueCount) {
     valid = false;
-    return 0;
+    return nullptr;
   }
-  std::variant<int, bool, std::string, double> val = values[index];
-  if (std::holds_alternative<double>(val)) {
-    return std::get<double>(val);
-  } else if (std::holds_alternative<int>(val)) {
-    return static_cast<double>(std::get<int>(val));
-  } else {
-    valid = false;
+  return &values[index];
+}
+
+double Supla::Parser::Simple::getValue(const std::string &key) {
+  auto value = getLineValue(key);
+  if (value == nullptr) {
     return 0;
   }
+  switch (value->type) {
+    case Value::Type::Double:
+      return value->doubleValue;
+    case Value::Type::Int:
+      return static_cast<double>(value->intValue);
+    default:
+      valid = false;
+      return 0;
+  }
 }
 
 std::variant<int, bool, std::string> Supla::Parser::Simple::getStateValue(
     const std::string &key) {
-  int index = keys[key];
-  if (index < 0 || static_cast<size_t>(index) >= values.size()) {
-    valid = false;
+  auto value = getLineValue(key);
+  if (value == nullptr) {
     return 0;
   }
-  std::variant<int, bool, std::string, double> val = values[index];
-  if (std::holds_alternative<int>(val)) {
-    return std::get<int>(val);
-  } else if (std::holds_alternative<bool>(val)) {
-    return std::get<bool>(val);
-  } else if (std::holds_alternative<std::string>(val)) {
-    return std::get<std::string>(val);
-  } else if (std::holds_alternative<double>(val)) {
-    return static_cast<int>(std::get<double>(val));
-  } else {
-    valid = false;
-    return 0;
+  switch (value->type) {
+    case Value::Type::Int:
+      return value->intValue;
+    case Value::Type::Bool:
+      return value->boolValue;
+    case Value::Type::String:
+      return std::string(value->text);
+    case Value::Type::Double:
+      return static_cast<int>(value->doubleValue);
   }
+  valid = false;
+  return 0;
 }
 
 bool Supla::Parser::Simple::refreshSource() {
   if (source) {
-    std::string sourceContent = source->getContent();
+    auto snapshot = source->getSnapshot();
 
-    if (sourceContent.length() == 0) {
+    if (snapshot->content.length() == 0) {
       valid = false;
       return valid;
     }
 
-    std::stringstream ss(sourceContent);
-    std::string line;
-    values.clear();
-
-    std::string strVal;
-    for (int i = 0; std::getline(ss, strVal, '\n'); i++) {
-      try {
-        if (strVal == "true" || strVal == "false") {
-          values[i] = strVal == "true";
-        } else {
-          double dblVal = std::stod(strVal);
-          if (dblVal == static_cast<int>(dblVal)) {
-            values[i] = static_cast<int>(dblVal);
-          } else {
-            values[i] = dblVal;
-          }
-        }
-      } catch (...) {
-        values[i] = strVal;
-      }
+    // values of the same snapshot are already parsed
+    if (snapshot != parsedSnapshot) {
+      parseContent(snapshot->content);
+      parsedSnapshot = std::move(snapshot);
     }
   }
   valid = true;
   return valid;
 }
 
+void Supla::Parser::Simple::parseContent(std::string_view content) {
+  valueCount = 0;
+  size_t pos = 0;
+  while (pos < content.size()) {
+    size_t end = content.find('\n', pos);
+    if (end == std::string_view::npos) {
+      end = content.size();
+    }
+    if (valueCount == values.size()) {
+      values.emplace_back();
+    }
+    parseLine(content.substr(pos, end - pos), &values[valueCount]);
+    valueCount++;
+    pos = end + 1;
+  }
+}
+
+void Supla::Parser::Simple::parseLine(std::string_view line, Value *value) {
+  value->text = line;
+  if (line == "true" || line == "false") {
+    value->type = Value::Type::Bool;
+    value->boolValue = (line == "true");
+    return;
+  }
+
+  // Same rules as std::stod: leading whitespace, sign and hex prefix are
+  // accepted and number may be followed by other characters
+  const char *ptr = line.data();
+  const char *end = line.data() + line.size();
+  while (ptr < end && (*ptr == ' ' || (*ptr >= '\t' && *ptr <= '\r'))) {
+    ptr++;
+  }
+  bool negative = false;
+  if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+    negative = (*ptr == '-');
+    ptr++;
+  }
+
+  double number = 0;
+  std::from_chars_result result = {ptr, std::errc::invalid_argument};
+  if (ptr < end && *ptr != '+' && *ptr != '-') {
+    if (end - ptr > 2 && ptr[0] == '0' && (ptr[1] == 'x' || ptr[1] == 'X')) {
+      result = std::from_chars(ptr + 2, end, number, std::chars_format::hex);
+    }
+    if (result.ec != std::errc()) {
+      result = std::from_chars(ptr, end, number);
+    }
+  }
+  if (result.ec != std::errc()) {
+    value->type = Value::Type::String;
+    return;
+  }
+
+  if (negative) {
+    number = -number;
+  }
+  if (number >= INT_MIN && number <= INT_MAX &&
+      number == static_cast<int>(number)) {
+    value->type = Value::Type::Int;
+    value->intValue = static_cast<int>(number);
+  } else {
+    value->type = Value::Type::Double;
+    value->doubleValue = number;
+  }
+}
+
 bool Supla::Parser::Simple::isBasedOnIndex() {
   return true;
 }
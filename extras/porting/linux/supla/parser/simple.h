@@ -21,8 +21,10 @@
 
 #include <supla/source/source.h>
 
-#include <map>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "parser.h"
@@ -43,7 +45,28 @@ class Simple : public Parser {
       const std::string &key) override;
 
  protected:
-  std::map<int, std::variant<int, bool, std::string, double>> values;
+  struct Value {
+    enum class Type : uint8_t { Int, Bool, Double, String };
+    Type type = Type::String;
+    int intValue = 0;
+    bool boolValue = false;
+    double doubleValue = 0;
+    // points to line in parsedSnapshot
+    std::string_view text;
+  };
+
+  /**
+   * Splits content into lines and converts each line to value. Values point
+   * to content, so it has to outlive them. Values vector is reused, so
+   * parsing doesn't allocate memory once it grew to number of lines.
+   */
+  void parseContent(std::string_view content);
+  static void parseLine(std::string_view line, Value *value);
+  const Value *getLineValue(const std::string &key);
+
+  std::shared_ptr<const Supla::Source::Snapshot> parsedSnapshot;
+  std::vector<Value> values;
+  size_t valueCount = 0;
 };
 };  // namespace Parser
 };  // namespace Supla
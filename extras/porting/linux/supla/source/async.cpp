@@ -0,0 +1,137 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "async.h"
+
+#include <linux_event_loop.h>
+#include <supla/log_wrapper.h>
+
+#include <string>
+#include <utility>
+
+#include "refresh_pool.h"
+
+Supla::Source::Async::Async(Source *source, uint32_t timeoutMs)
+    : source(source), timeoutMs(timeoutMs) {
+}
+
+Supla::Source::Async::~Async() {
+  bool waitForWorker = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    waitForWorker = workerAttached;
+  }
+  if (waitForWorker && !RefreshPool::Instance()->cancel(this)) {
+    std::unique_lock<std::mutex> lock(mutex);
+    refreshDone.wait(lock, [this] { return !workerAttached; });
+  }
+  delete source;
+  source = nullptr;
+}
+
+std::string Supla::Source::Async::getContent() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return content;
+}
+
+bool Supla::Source::Async::isConnected() {
+  return source ? source->isConnected() : false;
+}
+
+bool Supla::Source::Async::isEventDriven() const {
+  return true;
+}
+
+void Supla::Source::Async::requestRefresh() {
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (refreshInProgress) {
+      checkTimeout(now);
+      return;
+    }
+    refreshInProgress = true;
+    workerAttached = true;
+    timeoutReported = false;
+    refreshRequestTime = now;
+  }
+  RefreshPool::Instance()->enqueue(this);
+}
+
+void Supla::Source::Async::checkTimeout(
+    std::chrono::steady_clock::time_point now) {
+  if (timeoutMs == 0 || timeoutReported) {
+    return;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     now - refreshRequestTime)
+                     .count();
+  if (elapsed > timeoutMs) {
+    timeoutReported = true;
+    stats.timeoutCount++;
+    content.clear();
+    generation++;
+    SUPLA_LOG_WARNING("Async source: refresh timeout (%u ms), timeouts: %u",
+                      timeoutMs,
+                      stats.timeoutCount);
+  }
+}
+
+uint32_t Supla::Source::Async::getContentGeneration() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (refreshInProgress) {
+    checkTimeout(std::chrono::steady_clock::now());
+  }
+  return generation;
+}
+
+Supla::Source::RefreshStats Supla::Source::Async::getStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+bool Supla::Source::Async::isRefreshInProgress() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return refreshInProgress;
+}
+
+void Supla::Source::Async::refreshFromWorker() {
+  auto start = std::chrono::steady_clock::now();
+  std::string newContent = source->getContent();
+  auto end = std::chrono::steady_clock::now();
+  uint32_t durationMs =
+      std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+          .count();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  checkTimeout(end);
+  content = std::move(newContent);
+  generation++;
+  refreshInProgress = false;
+  stats.refreshCount++;
+  stats.lastDurationMs = durationMs;
+  if (durationMs > stats.maxDurationMs) {
+    stats.maxDurationMs = durationMs;
+  }
+  // new content is handled without waiting for next timer tick
+  Supla::Linux::EventLoop::WakeUp();
+  // Destructor may run as soon as lock is released, so this object isn't
+  // used afterwards
+  workerAttached = false;
+  refreshDone.notify_all();
+}
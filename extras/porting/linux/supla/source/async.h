@@ -0,0 +1,92 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef EXTRAS_PORTING_LINUX_SUPLA_SOURCE_ASYNC_H_
+#define EXTRAS_PORTING_LINUX_SUPLA_SOURCE_ASYNC_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+
+#include "source.h"
+
+namespace Supla {
+namespace Source {
+
+struct RefreshStats {
+  uint32_t refreshCount = 0;
+  uint32_t timeoutCount = 0;
+  uint32_t lastDurationMs = 0;
+  uint32_t maxDurationMs = 0;
+};
+
+/**
+ * Wrapper which reads content of other source on RefreshPool worker thread,
+ * so slow sources (i.e. Cmd running long script) don't block main loop.
+ *
+ * getContent() returns the newest completed snapshot. If refresh takes longer
+ * than timeoutMs, snapshot is cleared (so parser becomes invalid) until
+ * refresh completes.
+ *
+ * Timeout doesn't stop the refresh - wrapped source has to return by itself
+ * (i.e. Cmd with its own timeout, which kills the command). Source which
+ * never returns holds one RefreshPool worker forever and blocks exit.
+ */
+class Async : public Source {
+ public:
+  // Async takes ownership of source
+  explicit Async(Source *source, uint32_t timeoutMs = 0);
+  virtual ~Async();
+
+  std::string getContent() override;
+  bool isConnected() override;
+  bool isEventDriven() const override;
+  void requestRefresh() override;
+  uint32_t getContentGeneration() override;
+
+  RefreshStats getStats();
+  bool isRefreshInProgress();
+
+  // Called by RefreshPool worker
+  void refreshFromWorker();
+
+ protected:
+  void checkTimeout(std::chrono::steady_clock::time_point now);
+
+  Source *source = nullptr;
+  uint32_t timeoutMs = 0;
+
+  std::mutex mutex;
+  std::condition_variable refreshDone;
+  std::string content;
+  uint32_t generation = 0;
+  bool refreshInProgress = false;
+  // Set while source is queued in or used by RefreshPool worker. Cleared as
+  // the last access of worker to this object, so destructor waits for it.
+  bool workerAttached = false;
+  bool timeoutReported = false;
+  std::chrono::steady_clock::time_point refreshRequestTime;
+  RefreshStats stats;
+};
+
+}  // namespace Source
+}  // namespace Supla
+
+#endif  // EXTRAS_PORTING_LINUX_SUPLA_SOURCE_ASYNC_H_
@@ -18,6 +18,14 @@
 
 #include "cmd.h"
 
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <supla/log_wrapper.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdio>
 #include <string>
 
@@ -27,16 +35,98 @@ Supla::Source::Cmd::Cmd(const char *cmd) : cmdLine(cmd) {
 Supla::Source::Cmd::~Cmd() {
 }
 
+void Supla::Source::Cmd::setTimeoutMs(uint32_t timeoutMs) {
+  this->timeoutMs = timeoutMs;
+}
+
 std::string Supla::Source::Cmd::getContent() {
+  if (timeoutMs > 0) {
+    return getContentWithTimeout();
+  }
+
   auto p = popen(cmdLine.c_str(), "r");
   if (p) {
     std::string content;
-    int c = 0;
-    while ((c = fgetc(p)) != EOF) {
-      content.append(1, static_cast<char>(c));
+    char buf[512];
+    size_t size = 0;
+    while ((size = fread(buf, 1, sizeof(buf), p)) > 0) {
+      content.append(buf, size);
     }
     pclose(p);
     return content;
   }
   return std::string("");
 }
+
+std::string Supla::Source::Cmd::getContentWithTimeout() {
+  int fds[2] = {};
+  if (pipe(fds) != 0) {
+    SUPLA_LOG_ERROR("Cmd: failed to create pipe");
+    return std::string("");
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    SUPLA_LOG_ERROR("Cmd: fork failed");
+    close(fds[0]);
+    close(fds[1]);
+    return std::string("");
+  }
+
+  if (pid == 0) {
+    // child: own process group, so whole command tree can be killed
+    setpgid(0, 0);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+    execl("/bin/sh", "sh", "-c", cmdLine.c_str(), static_cast<char *>(nullptr));
+    _exit(127);
+  }
+
+  setpgid(pid, pid);
+  close(fds[1]);
+
+  std::string content;
+  bool timedOut = false;
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  char buf[512];
+  while (true) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now())
+                    .count();
+    if (left <= 0) {
+      timedOut = true;
+      break;
+    }
+    struct pollfd pfd = {fds[0], POLLIN, 0};
+    int ret = poll(&pfd, 1, static_cast<int>(left));
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      timedOut = (ret == 0);
+      break;
+    }
+    ssize_t size = read(fds[0], buf, sizeof(buf));
+    if (size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (size <= 0) {
+      break;
+    }
+    content.append(buf, size);
+  }
+  close(fds[0]);
+
+  if (timedOut) {
+    SUPLA_LOG_WARNING("Cmd: \"%s\" timeout after %u ms, killing",
+                      cmdLine.c_str(),
+                      timeoutMs);
+    kill(-pid, SIGKILL);
+    content.clear();
+  }
+  while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {
+  }
+  return content;
+}
@@ -33,9 +33,15 @@ class Cmd : public Source {
   explicit Cmd(const char *cmd);
   virtual ~Cmd();
   std::string getContent() override;
+  // When timeout is set, command which runs longer is killed and empty
+  // content is returned. 0 - no timeout
+  void setTimeoutMs(uint32_t timeoutMs);
 
  protected:
+  std::string getContentWithTimeout();
+
   std::string cmdLine;
+  uint32_t timeoutMs = 0;
 };
 };  // namespace Source
 };  // namespace Supla
@@ -16,28 +16,39 @@
  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
+#include <errno.h>
+#include <fcntl.h>
 #include <supla/log_wrapper.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <chrono>  // NOLINT(build/c++11)
-#include <fstream>
-#include <iostream>
 #include <string>
 
 #include "file.h"
+#include "file_watcher.h"
+
+namespace {
+// file is too big - cut it at 10 MB
+constexpr size_t MaxFileSize = 1024 * 1024 * 10;
+}  // namespace
 
 Supla::Source::File::File(const char *filePath, int expirationSec)
     : filePath(filePath), fileExpirationSec(expirationSec) {
 }
 
 Supla::Source::File::~File() {
+  if (watched) {
+    FileWatcher::Instance()->remove(this);
+  }
 }
 
 std::string Supla::Source::File::getContent() {
   std::string result;
-  std::ifstream file;
   try {
-    file.open(filePath);
     auto fileTime = std::filesystem::last_write_time(filePath);
+    contentFileTime = fileTime;
     auto now = std::filesystem::file_time_type::clock::now();
 
     if (fileExpirationSec != 0
@@ -50,21 +61,12 @@ std::string Supla::Source::File::getContent() {
       return result;
     } else {
       fileIsTooOldLog = false;
-      std::string line;
-      while (std::getline(file, line)) {
-        result.append(line).append("\n");
-        if (result.length() > 1024 * 1024 * 10) {
-          // file is too big - cut it at 10 MB
-          break;
-        }
-      }
+      result = readFile();
     }
   } catch (const std::filesystem::filesystem_error &) {
     SUPLA_LOG_ERROR("File: file \"%s\" reading error", filePath.c_str());
   }
 
-  file.close();
-
   if (result.length() < 1 && readFailures < 3) {
     SUPLA_LOG_DEBUG("File: file \"%s\" reading error or empty",
                     filePath.c_str());
@@ -80,3 +82,93 @@ std::string Supla::Source::File::getContent() {
 void Supla::Source::File::setExpirationTime(int timeSec) {
   fileExpirationSec = timeSec;
 }
+
+std::string Supla::Source::File::readFile() const {
+  std::string result;
+  int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return result;
+  }
+
+  // files in /proc or /sys report size 0, so file is read until EOF
+  struct stat st = {};
+  size_t capacity = 4096;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    capacity = static_cast<size_t>(st.st_size) + 1;
+  }
+  if (capacity > MaxFileSize) {
+    capacity = MaxFileSize;
+  }
+  result.resize(capacity);
+
+  size_t length = 0;
+  while (length < MaxFileSize) {
+    if (length == result.size()) {
+      result.resize(std::min(result.size() * 2, MaxFileSize));
+    }
+    ssize_t size = read(fd, &result[length], result.size() - length);
+    if (size < 0 && errno == EINTR) {
+      continue;
+    }
+    if (size <= 0) {
+      break;
+    }
+    length += size;
+  }
+  close(fd);
+  result.resize(length);
+
+  // content is line based, so last line is always terminated
+  if (!result.empty() && result.back() != '\n') {
+    result.append("\n");
+  }
+  return result;
+}
+
+void Supla::Source::File::setWatch(bool watch) {
+  if (watch == watched) {
+    return;
+  }
+  if (!watch) {
+    FileWatcher::Instance()->remove(this);
+    watched = false;
+    return;
+  }
+  watched = FileWatcher::Instance()->add(this, filePath.string());
+  if (!watched) {
+    SUPLA_LOG_WARNING("File: can't watch \"%s\", using periodic refresh",
+                      filePath.c_str());
+    return;
+  }
+  // force initial read
+  generation++;
+}
+
+bool Supla::Source::File::isEventDriven() const {
+  return watched;
+}
+
+void Supla::Source::File::requestRefresh() {
+  if (!watched) {
+    return;
+  }
+  // Cases which are not reported by inotify: previous read failed (file
+  // missing or empty) or file content expired
+  bool expired = fileExpirationSec != 0 && !fileIsTooOldLog &&
+                 contentFileTime + std::chrono::seconds(fileExpirationSec) <
+                     std::filesystem::file_time_type::clock::now();
+  if (readFailures > 0 || expired) {
+    generation++;
+  }
+}
+
+uint32_t Supla::Source::File::getContentGeneration() {
+  if (watched) {
+    FileWatcher::Instance()->processEvents();
+  }
+  return generation;
+}
+
+void Supla::Source::File::onFileChanged() {
+  generation++;
+}
@@ -21,6 +21,7 @@
 
 #include <supla/parser/parser.h>
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string>
 
@@ -37,12 +38,31 @@ class File : public Source {
 
   void setExpirationTime(int timeSec);
 
+  /**
+   * Enables watch mode: file is watched with inotify and it is read again
+   * only when it was modified. Parsers are notified about change on next
+   * iteration instead of waiting for their refresh time.
+   * If watch can't be started, file is polled as before.
+   */
+  void setWatch(bool watch);
+  bool isEventDriven() const override;
+  void requestRefresh() override;
+  uint32_t getContentGeneration() override;
+
+  // Called by FileWatcher
+  void onFileChanged();
+
  protected:
+  std::string readFile() const;
+
   std::filesystem::path filePath;
   int fileExpirationSec = 10 * 60;
   bool fileIsTooOldLog = false;
   std::string prevResult;
   int readFailures = 0;
+  std::filesystem::file_time_type contentFileTime = {};
+  bool watched = false;
+  uint32_t generation = 0;
 };
 };  // namespace Source
 };  // namespace Supla
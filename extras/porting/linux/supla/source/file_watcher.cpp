@@ -0,0 +1,155 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "file_watcher.h"
+
+#include <errno.h>
+#include <supla/log_wrapper.h>
+#include <supla/time.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <string>
+
+#include "file.h"
+
+Supla::Source::FileWatcher *Supla::Source::FileWatcher::Instance() {
+  static FileWatcher watcher;
+  return &watcher;
+}
+
+Supla::Source::FileWatcher::~FileWatcher() {
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
+
+bool Supla::Source::FileWatcher::init() {
+  if (fd >= 0) {
+    return true;
+  }
+  if (initFailed) {
+    return false;
+  }
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    initFailed = true;
+    SUPLA_LOG_ERROR("FileWatcher: inotify init failed (errno %d)", errno);
+    return false;
+  }
+  return true;
+}
+
+int Supla::Source::FileWatcher::getFd() const {
+  return fd;
+}
+
+bool Supla::Source::FileWatcher::add(File *file, const std::string &path) {
+  if (!init()) {
+    return false;
+  }
+
+  std::filesystem::path filePath(path);
+  std::string dir = filePath.parent_path().string();
+  if (dir.empty()) {
+    dir = ".";
+  }
+
+  int wd = inotify_add_watch(fd,
+                             dir.c_str(),
+                             IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO |
+                                 IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+  if (wd < 0) {
+    SUPLA_LOG_ERROR("FileWatcher: failed to watch \"%s\" (errno %d)",
+                    dir.c_str(),
+                    errno);
+    return false;
+  }
+
+  // the same directory returns the same watch descriptor
+  watches[wd].push_back({file, filePath.filename().string()});
+  SUPLA_LOG_DEBUG("FileWatcher: watching \"%s\"", path.c_str());
+  return true;
+}
+
+void Supla::Source::FileWatcher::remove(File *file) {
+  for (auto it = watches.begin(); it != watches.end();) {
+    auto &files = it->second;
+    for (auto fileIt = files.begin(); fileIt != files.end();) {
+      if (fileIt->file == file) {
+        fileIt = files.erase(fileIt);
+      } else {
+        ++fileIt;
+      }
+    }
+    if (files.empty()) {
+      inotify_rm_watch(fd, it->first);
+      it = watches.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void Supla::Source::FileWatcher::processEvents() {
+  if (fd < 0) {
+    return;
+  }
+  uint32_t now = millis();
+  if (processedOnce && now == lastProcessTimestamp) {
+    return;
+  }
+  processedOnce = true;
+  lastProcessTimestamp = now;
+
+  alignas(struct inotify_event) char buf[4096];
+  while (true) {
+    ssize_t size = read(fd, buf, sizeof(buf));
+    if (size <= 0) {
+      // EAGAIN - no more events
+      return;
+    }
+
+    for (char *ptr = buf; ptr < buf + size;) {
+      auto event = reinterpret_cast<struct inotify_event *>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        SUPLA_LOG_WARNING("FileWatcher: event queue overflow");
+        for (auto &watch : watches) {
+          for (auto &watched : watch.second) {
+            watched.file->onFileChanged();
+          }
+        }
+        continue;
+      }
+
+      auto watch = watches.find(event->wd);
+      if (watch == watches.end() || event->len == 0) {
+        continue;
+      }
+      for (auto &watched : watch->second) {
+        if (watched.name == event->name) {
+          watched.file->onFileChanged();
+        }
+      }
+    }
+  }
+}
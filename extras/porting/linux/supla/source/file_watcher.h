@@ -0,0 +1,72 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef EXTRAS_PORTING_LINUX_SUPLA_SOURCE_FILE_WATCHER_H_
+#define EXTRAS_PORTING_LINUX_SUPLA_SOURCE_FILE_WATCHER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Supla {
+namespace Source {
+
+class File;
+
+/**
+ * Watches files with single inotify instance shared by all File sources.
+ * Parent directory is watched (not the file itself), so files replaced with
+ * rename or recreated by writer are still tracked.
+ */
+class FileWatcher {
+ public:
+  static FileWatcher *Instance();
+
+  ~FileWatcher();
+
+  bool add(File *file, const std::string &path);
+  void remove(File *file);
+
+  // Reads pending inotify events and notifies changed files. It doesn't
+  // block. Events are read at most once per millisecond.
+  void processEvents();
+  // Returns inotify file descriptor (for use with poll/epoll), -1 on error
+  int getFd() const;
+
+ protected:
+  FileWatcher() = default;
+  bool init();
+
+  struct WatchedFile {
+    File *file = nullptr;
+    std::string name;
+  };
+
+  int fd = -1;
+  bool initFailed = false;
+  uint32_t lastProcessTimestamp = 0;
+  bool processedOnce = false;
+  // inotify watch descriptor -> files in watched directory
+  std::map<int, std::vector<WatchedFile>> watches;
+};
+
+}  // namespace Source
+}  // namespace Supla
+
+#endif  // EXTRAS_PORTING_LINUX_SUPLA_SOURCE_FILE_WATCHER_H_
@@ -35,6 +35,7 @@ Mqtt::Mqtt(const Supla::LinuxYamlConfig& yamlConfig,
   for (auto& topic : topics) {
     SUPLA_LOG_DEBUG("Mark topic %s to subscribe", topic.c_str());
     client->subscribeTopic(topic, qos);
+    entries.push_back(Supla::LinuxMqttClient::topics.getEntry(topic));
   }
 }
 
@@ -53,18 +54,28 @@ bool Supla::Source::Mqtt::isConnected() {
 
 std::string Supla::Source::Mqtt::getContent() {
   std::string combinedMessages;
-  for (const auto& topic : topics) {
-    if (client->topics.find(topic) != client->topics.end()) {
-      std::string currentMessage = client->topics[topic];
-      if (combinedMessages.empty()) {
-        combinedMessages = currentMessage;
-      } else {
-        combinedMessages += "\n" + currentMessage;
-      }
+  for (const auto* entry : entries) {
+    auto currentMessage = entry->getValue();
+    if (combinedMessages.empty()) {
+      combinedMessages = *currentMessage;
+    } else {
+      combinedMessages += "\n" + *currentMessage;
     }
   }
   latestMessage = combinedMessages;
   return latestMessage;
 }
 
+bool Supla::Source::Mqtt::isEventDriven() const {
+  return true;
+}
+
+uint32_t Supla::Source::Mqtt::getContentGeneration() {
+  uint32_t generation = 0;
+  for (const auto* entry : entries) {
+    generation += entry->getSequence();
+  }
+  return generation;
+}
+
 }  // namespace Supla::Source
@@ -40,10 +40,16 @@ class Mqtt : public Source {
   std::string getContent() override;
   bool isConnected() override;
 
+  // New messages are reported to parsers right away instead of waiting for
+  // parser refresh time
+  bool isEventDriven() const override;
+  uint32_t getContentGeneration() override;
+
  protected:
   std::shared_ptr<Supla::LinuxMqttClient> client;
   std::string latestMessage;
   std::vector<std::string> topics;
+  std::vector<const Supla::MqttTopicStore::Entry *> entries;
   int qos;
 };
 }  // namespace Supla::Source
@@ -0,0 +1,97 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "refresh_pool.h"
+
+#include <supla/log_wrapper.h>
+
+#include <algorithm>
+
+#include "async.h"
+
+int Supla::Source::RefreshPool::workerCount = 4;
+
+Supla::Source::RefreshPool *Supla::Source::RefreshPool::Instance() {
+  static RefreshPool pool;
+  return &pool;
+}
+
+void Supla::Source::RefreshPool::SetWorkerCount(int count) {
+  if (count < 1) {
+    count = 1;
+  }
+  workerCount = count;
+}
+
+Supla::Source::RefreshPool::~RefreshPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopRequested = true;
+    queue.clear();
+  }
+  cv.notify_all();
+  for (auto &worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void Supla::Source::RefreshPool::startWorkers() {
+  SUPLA_LOG_DEBUG("RefreshPool: starting %d workers", workerCount);
+  for (int i = 0; i < workerCount; i++) {
+    workers.emplace_back(&RefreshPool::workerLoop, this);
+  }
+}
+
+void Supla::Source::RefreshPool::enqueue(Async *source) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (workers.empty()) {
+      startWorkers();
+    }
+    queue.push_back(source);
+  }
+  cv.notify_one();
+}
+
+bool Supla::Source::RefreshPool::cancel(Async *source) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = std::find(queue.begin(), queue.end(), source);
+  if (it == queue.end()) {
+    return false;
+  }
+  queue.erase(it);
+  return true;
+}
+
+void Supla::Source::RefreshPool::workerLoop() {
+  while (true) {
+    Async *source = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this] { return stopRequested || !queue.empty(); });
+      if (stopRequested) {
+        return;
+      }
+      source = queue.front();
+      queue.pop_front();
+    }
+    source->refreshFromWorker();
+  }
+}
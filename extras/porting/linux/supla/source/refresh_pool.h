@@ -0,0 +1,67 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef EXTRAS_PORTING_LINUX_SUPLA_SOURCE_REFRESH_POOL_H_
+#define EXTRAS_PORTING_LINUX_SUPLA_SOURCE_REFRESH_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace Supla {
+namespace Source {
+
+class Async;
+
+/**
+ * Fixed size pool of worker threads which refresh Async sources.
+ * Each source is queued at most once, so queue length is bounded by number
+ * of Async sources. Workers are started on first use.
+ */
+class RefreshPool {
+ public:
+  static RefreshPool *Instance();
+  // Has to be called before first Async source refresh
+  static void SetWorkerCount(int count);
+
+  ~RefreshPool();
+
+  void enqueue(Async *source);
+  // Returns true if source was removed from queue before refresh started
+  bool cancel(Async *source);
+
+ protected:
+  RefreshPool() = default;
+  void startWorkers();
+  void workerLoop();
+
+  static int workerCount;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Async *> queue;
+  std::vector<std::thread> workers;
+  bool stopRequested = false;
+};
+
+}  // namespace Source
+}  // namespace Supla
+
+#endif  // EXTRAS_PORTING_LINUX_SUPLA_SOURCE_REFRESH_POOL_H_
@@ -0,0 +1,70 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "source.h"
+
+#include <supla/time.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+std::shared_ptr<const Supla::Source::Snapshot>
+Supla::Source::Source::getSnapshot() {
+  if (isSnapshotValid()) {
+    snapshotStats.readsSaved++;
+    return snapshot;
+  }
+
+  // generation is taken before reading, so content which changes during
+  // read is reported again
+  snapshotContentGeneration = getContentGeneration();
+  std::string content = getContent();
+  snapshotTimestamp = millis();
+  snapshotStats.reads++;
+  if (snapshot && snapshot->content == content) {
+    snapshotStats.readsUnchanged++;
+    return snapshot;
+  }
+
+  auto newSnapshot = std::make_shared<Snapshot>();
+  newSnapshot->content = std::move(content);
+  newSnapshot->generation = snapshot ? snapshot->generation + 1 : 1;
+  snapshot = newSnapshot;
+  return snapshot;
+}
+
+Supla::Source::SnapshotStats Supla::Source::Source::getSnapshotStats() const {
+  return snapshotStats;
+}
+
+void Supla::Source::Source::setSnapshotMaxAgeMs(uint32_t timeMs) {
+  snapshotMaxAgeMs = timeMs;
+}
+
+bool Supla::Source::Source::isSnapshotValid() {
+  if (!snapshot) {
+    return false;
+  }
+  if (isEventDriven()) {
+    // event driven source reports content changes, so it is enough to
+    // check if it changed
+    return snapshotContentGeneration == getContentGeneration();
+  }
+  return millis() - snapshotTimestamp < snapshotMaxAgeMs;
+}
@@ -19,16 +19,67 @@
 #ifndef EXTRAS_PORTING_LINUX_SUPLA_SOURCE_SOURCE_H_
 #define EXTRAS_PORTING_LINUX_SUPLA_SOURCE_SOURCE_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace Supla {
 
 namespace Source {
+
+/**
+ * Immutable copy of source content shared by all parsers which use the same
+ * source. Generation is increased each time content read from source differs
+ * from previous snapshot.
+ */
+struct Snapshot {
+  std::string content;
+  uint32_t generation = 0;
+};
+
+struct SnapshotStats {
+  uint32_t reads = 0;
+  uint32_t readsSaved = 0;
+  // reads which returned the same content as previous snapshot
+  uint32_t readsUnchanged = 0;
+};
+
 class Source {
  public:
   virtual ~Source() {}
+
+  /**
+   * Returns shared snapshot of source content. Source is read again only
+   * when cached snapshot is no longer valid (see isSnapshotValid()), so
+   * source used by many parsers is read once per refresh. When content
+   * read again is the same, previous snapshot is kept, so parsers don't
+   * parse it again.
+   */
+  std::shared_ptr<const Snapshot> getSnapshot();
+  SnapshotStats getSnapshotStats() const;
+  // Time in which cached snapshot is reused by other parsers
+  void setSnapshotMaxAgeMs(uint32_t timeMs);
+
   virtual std::string getContent() = 0;
   virtual bool isConnected() { return true; }
+
+  // Methods below are used by event driven sources, which report content
+  // changes instead of being polled (see Async and File in watch mode).
+  // Parsers read such source only when its content generation changes.
+  virtual bool isEventDriven() const { return false; }
+  // Called by parser every refresh period
+  virtual void requestRefresh() {}
+  // Changed each time new content is available
+  virtual uint32_t getContentGeneration() { return 0; }
+
+ protected:
+  virtual bool isSnapshotValid();
+
+  std::shared_ptr<const Snapshot> snapshot;
+  SnapshotStats snapshotStats;
+  uint32_t snapshotTimestamp = 0;
+  uint32_t snapshotMaxAgeMs = 100;
+  uint32_t snapshotContentGeneration = 0;
 };
 };  // namespace Source
 };  // namespace Supla
@@ -677,3 +677,24 @@ TEST(ButtonTests, MotionSensorClicks) {
   time.advance(500);  // debounce
   button.onTimer();  // #16 on click 4
 }
+
+TEST(ButtonTests, MaxMulticlickValueUsesOnlyOwnActions) {
+  ActionHandlerMock mock1;
+  Supla::Control::Button b1(5, false, false);
+  Supla::Control::Button b2(6, false, false);
+
+  b2.addAction(1, mock1, Supla::ON_CLICK_7);
+  EXPECT_EQ(b1.getMaxMulticlickValue(), 0);
+  EXPECT_EQ(b2.getMaxMulticlickValue(), 7);
+
+  b1.addAction(1, mock1, Supla::ON_CLICK_2);
+  b1.addAction(2, mock1, Supla::ON_LONG_CLICK_4);
+  EXPECT_EQ(b1.getMaxMulticlickValue(), 4);
+
+  b1.disableAction(2, &mock1, Supla::ON_LONG_CLICK_4);
+  EXPECT_EQ(b1.getMaxMulticlickValue(), 2);
+  EXPECT_EQ(b2.getMaxMulticlickValue(), 7);
+
+  b1.enableAction(2, &mock1, Supla::ON_LONG_CLICK_4);
+  EXPECT_EQ(b1.getMaxMulticlickValue(), 4);
+}
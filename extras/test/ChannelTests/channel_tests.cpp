@@ -953,3 +953,83 @@ TEST_F(ChannelTestsFixture, ChannelArbitaryNumbers) {
   // channel number 2 is for "third"
   EXPECT_EQ(Supla::RegisterDevice::getChannelValuePtr(2)[0], 3);
 }
+
+TEST_F(ChannelTestsFixture, ChannelRenumberingUpdatesLookup) {
+  Supla::Channel first(5);
+  Supla::Channel second;
+  Supla::Channel third(2);
+
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(5), &first);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(0), &second);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(2), &third);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(1), nullptr);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(-1), nullptr);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(SUPLA_CHANNELMAXCOUNT),
+            nullptr);
+
+  // move to free number
+  EXPECT_TRUE(first.setChannelNumber(7));
+  EXPECT_EQ(first.getChannelNumber(), 7);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(7), &first);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(5), nullptr);
+  EXPECT_TRUE(Supla::RegisterDevice::isChannelNumberFree(5));
+  EXPECT_FALSE(Supla::RegisterDevice::isChannelNumberFree(7));
+
+  // move to number used by other channel - channels are swapped
+  EXPECT_TRUE(first.setChannelNumber(2));
+  EXPECT_EQ(first.getChannelNumber(), 2);
+  EXPECT_EQ(third.getChannelNumber(), 7);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(2), &first);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(7), &third);
+  EXPECT_EQ(Supla::RegisterDevice::getNextFreeChannelNumber(), 1);
+
+  {
+    Supla::Channel fourth;
+    EXPECT_EQ(fourth.getChannelNumber(), 1);
+    EXPECT_EQ(Supla::Channel::GetByChannelNumber(1), &fourth);
+    // already used number is rejected and channel is not indexed
+    Supla::Channel fifth(7);
+    EXPECT_EQ(fifth.getChannelNumber(), -1);
+    EXPECT_EQ(Supla::Channel::GetByChannelNumber(7), &third);
+  }
+
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(1), nullptr);
+  EXPECT_EQ(Supla::Channel::GetByChannelNumber(7), &third);
+}
+
+TEST_F(ChannelTestsFixture, PendingUpdateQueue) {
+  EXPECT_FALSE(Supla::Channel::IsAnyUpdatePending());
+
+  Supla::Channel first;
+  Supla::Channel second;
+  Supla::Channel third;
+  EXPECT_EQ(Supla::Channel::PendingUpdateBegin(), nullptr);
+
+  third.setNewValue(true);
+  first.setNewValue(true);
+  first.setSendGetConfig();
+
+  // channels are queued once, in order of their first pending update
+  EXPECT_TRUE(Supla::Channel::IsAnyUpdatePending());
+  EXPECT_EQ(Supla::Channel::PendingUpdateBegin(), &third);
+  EXPECT_EQ(third.nextPendingUpdate(), &first);
+  EXPECT_EQ(first.nextPendingUpdate(), nullptr);
+
+  first.clearSendValue();
+  EXPECT_EQ(third.nextPendingUpdate(), &first);
+
+  third.sendUpdate();
+  EXPECT_EQ(Supla::Channel::PendingUpdateBegin(), &first);
+  EXPECT_FALSE(third.isUpdateReady());
+
+  {
+    Supla::Channel fourth;
+    fourth.setNewValue(true);
+    EXPECT_EQ(first.nextPendingUpdate(), &fourth);
+  }
+  EXPECT_EQ(first.nextPendingUpdate(), nullptr);
+
+  first.sendUpdate();
+  EXPECT_FALSE(Supla::Channel::IsAnyUpdatePending());
+  EXPECT_EQ(Supla::Channel::PendingUpdateBegin(), nullptr);
+}
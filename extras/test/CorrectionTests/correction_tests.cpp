@@ -179,3 +179,43 @@ TEST(CorrectionTests, ThermHygroMeterCorrectionTest) {
 
   Supla::Correction::clear();  // cleanup
 }
+
+TEST(CorrectionTests, CorrectionIsCachedInChannel) {
+  Supla::Channel::resetToDefaults();
+  Correction::add(1, 1.5);
+  Correction::add(1, 4.0, true);
+
+  Supla::Channel ch0;
+  Supla::Channel ch1;
+  ch0.setType(SUPLA_CHANNELTYPE_THERMOMETER);
+
+  // correction added before channel was created
+  EXPECT_EQ(ch0.getCorrection(), 0);
+  EXPECT_EQ(ch1.getCorrection(), 1.5);
+  EXPECT_EQ(ch1.getCorrection(true), 4.0);
+
+  // correction added after channel was created
+  Correction::add(0, -2.0);
+  EXPECT_EQ(ch0.getCorrection(), -2.0);
+  ch0.setNewValue(20.0);
+  EXPECT_EQ(ch0.getValueDouble(), 18.0);
+
+  ch0.setCorrection(3.0);
+  EXPECT_EQ(Correction::get(0), 3.0);
+  ch0.setNewValue(20.0);
+  EXPECT_EQ(ch0.getValueDouble(), 23.0);
+
+  // corrections are assigned to channel number, so they follow renumbering
+  ch0.setChannelNumber(1);
+  EXPECT_EQ(ch0.getCorrection(), 1.5);
+  EXPECT_EQ(ch0.getCorrection(true), 4.0);
+  EXPECT_EQ(ch1.getCorrection(), 3.0);
+  EXPECT_EQ(ch1.getCorrection(true), 0);
+
+  Correction::clear();
+  EXPECT_EQ(ch0.getCorrection(), 0);
+  EXPECT_EQ(ch0.getCorrection(true), 0);
+  EXPECT_EQ(ch1.getCorrection(), 0);
+  ch0.setNewValue(20.0);
+  EXPECT_EQ(ch0.getValueDouble(), 20.0);
+}
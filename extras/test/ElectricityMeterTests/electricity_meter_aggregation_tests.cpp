@@ -0,0 +1,230 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+
+#include <gtest/gtest.h>
+#include <simple_time.h>
+#include <supla/channel.h>
+#include <supla/sensor/em_aggregate_measurement.h>
+#include <supla/sensor/electricity_meter.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+
+using Supla::Sensor::EmAggregate;
+using Supla::Sensor::EmAggregateType;
+using Supla::Sensor::EmMeasurement;
+
+namespace {
+
+class EMWithScriptedReadings : public Supla::Sensor::ElectricityMeter {
+ public:
+  void readValuesFromDevice() override {
+    readCount++;
+    for (int i = 0; i < MAX_PHASES; i++) {
+      setVoltage(i, voltage + i);
+      setCurrent(i, current);
+      setPowerActive(i, powerActive);
+      setPowerReactive(i, 0);
+      setPowerApparent(i, powerActive);
+    }
+  }
+
+  TElectricityMeter_ExtendedValue_V3 *getEmValue() {
+    return &emValue;
+  }
+
+  void addSample() {
+    addSampleToAggregator();
+  }
+
+  void applyAggregates() {
+    applyAggregatedValues();
+  }
+
+  uint16_t voltage = 23000;
+  uint32_t current = 1000;
+  int64_t powerActive = 23000000;
+  int readCount = 0;
+};
+
+class EmAggregateMeasurementForTest
+    : public Supla::Sensor::EmAggregateMeasurement {
+ public:
+  using Supla::Sensor::EmAggregateMeasurement::EmAggregateMeasurement;
+  using Supla::Sensor::EmAggregateMeasurement::getValue;
+};
+
+class ElectricityMeterAggregationTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Supla::Channel::resetToDefaults();
+  }
+
+  void TearDown() override {
+    Supla::Channel::resetToDefaults();
+  }
+
+  // Runs iterateAlways() every 10 ms for given time
+  void run(EMWithScriptedReadings *em, int durationMs) {
+    for (int i = 0; i < durationMs; i += 10) {
+      time.advance(10);
+      em->iterateAlways();
+    }
+  }
+
+  SimpleTime time;
+};
+
+}  // namespace
+
+TEST_F(ElectricityMeterAggregationTests, DisabledByDefault) {
+  EMWithScriptedReadings em;
+  EXPECT_EQ(em.getSamplingIntervalMs(), 0);
+
+  run(&em, 12000);
+  // device is read once per refresh rate (5 s)
+  EXPECT_EQ(em.readCount, 3);
+  EmAggregate aggregate;
+  EXPECT_FALSE(em.getAggregate(EmMeasurement::Voltage, 0, &aggregate));
+}
+
+TEST_F(ElectricityMeterAggregationTests, MinMaxMeanOverReportingWindow) {
+  EMWithScriptedReadings em;
+  em.setSamplingIntervalMs(100);
+  EXPECT_EQ(em.getSamplingIntervalMs(), 100);
+
+  // first iteration samples device and starts reporting
+  run(&em, 10);
+  EXPECT_EQ(em.readCount, 1);
+
+  run(&em, 2000);
+  // short voltage spike and current drop between reports
+  em.voltage = 25000;
+  em.current = 0;
+  run(&em, 100);
+  em.voltage = 23000;
+  em.current = 1000;
+  run(&em, 2910);
+  EXPECT_EQ(em.readCount, 51);
+
+  EmAggregate aggregate;
+  ASSERT_TRUE(em.getAggregate(EmMeasurement::Voltage, 0, &aggregate));
+  EXPECT_EQ(aggregate.samples, 50);
+  EXPECT_EQ(aggregate.min, 23000);
+  EXPECT_EQ(aggregate.max, 25000);
+  EXPECT_EQ(aggregate.mean, 23040);
+  ASSERT_TRUE(em.getAggregate(EmMeasurement::Voltage, 2, &aggregate));
+  EXPECT_EQ(aggregate.min, 23002);
+  EXPECT_EQ(aggregate.max, 25002);
+  ASSERT_TRUE(em.getAggregate(EmMeasurement::Current, 1, &aggregate));
+  EXPECT_EQ(aggregate.min, 0);
+  EXPECT_EQ(aggregate.max, 1000);
+  EXPECT_EQ(aggregate.mean, 980);
+  ASSERT_TRUE(em.getAggregate(EmMeasurement::PowerActive, 0, &aggregate));
+  EXPECT_EQ(aggregate.mean, 23000000);
+
+  // mean values are reported in channel value
+  EXPECT_EQ(em.getVoltage(0), 23040);
+  EXPECT_EQ(em.getVoltage(2), 23042);
+  EXPECT_EQ(em.getCurrent(1), 980);
+  EXPECT_EQ(em.getPowerActive(0), 23000000);
+  EXPECT_TRUE(em.getEmValue()->measured_values & EM_VAR_VOLTAGE);
+  EXPECT_TRUE(em.getEmValue()->measured_values & EM_VAR_CURRENT);
+
+  // spike is gone in next window
+  run(&em, 5010);
+  ASSERT_TRUE(em.getAggregate(EmMeasurement::Voltage, 0, &aggregate));
+  EXPECT_EQ(aggregate.min, 23000);
+  EXPECT_EQ(aggregate.max, 23000);
+  EXPECT_EQ(em.getVoltage(0), 23000);
+
+  em.setSamplingIntervalMs(0);
+  EXPECT_FALSE(em.getAggregate(EmMeasurement::Voltage, 0, &aggregate));
+}
+
+TEST_F(ElectricityMeterAggregationTests, GpmChannelWithAggregate) {
+  EMWithScriptedReadings em;
+  EmAggregateMeasurementForTest maxVoltage(
+      &em, EmMeasurement::Voltage, 1, EmAggregateType::Max);
+  EmAggregateMeasurementForTest minPower(
+      &em, EmMeasurement::PowerActive, 0, EmAggregateType::Min);
+  EmAggregateMeasurementForTest meanCurrent(
+      &em, EmMeasurement::Current, 2, EmAggregateType::Mean);
+
+  EXPECT_TRUE(isnan(maxVoltage.getValue()));
+
+  em.setSamplingIntervalMs(500);
+  run(&em, 10);
+  em.voltage = 24000;
+  em.powerActive = 11500000;
+  em.current = 500;
+  run(&em, 500);
+  em.voltage = 23000;
+  em.powerActive = 23000000;
+  em.current = 1000;
+  run(&em, 4510);
+
+  EXPECT_DOUBLE_EQ(maxVoltage.getValue(), 240.01);
+  EXPECT_DOUBLE_EQ(minPower.getValue(), 115);
+  EXPECT_DOUBLE_EQ(meanCurrent.getValue(), 0.95);
+}
+
+TEST_F(ElectricityMeterAggregationTests, NoSamplesAfterReadError) {
+  class EMWithError : public EMWithScriptedReadings {
+   public:
+    void readValuesFromDevice() override {
+      readCount++;
+      resetReadParameters();
+    }
+  } em;
+  em.setSamplingIntervalMs(100);
+  run(&em, 6000);
+  EXPECT_GT(em.readCount, 50);
+  EmAggregate aggregate;
+  EXPECT_FALSE(em.getAggregate(EmMeasurement::Voltage, 0, &aggregate));
+  EXPECT_FALSE(em.getAggregate(EmMeasurement::Current, 0, &aggregate));
+  EXPECT_EQ(em.getVoltage(0), 0);
+}
+
+TEST_F(ElectricityMeterAggregationTests, CpuCostPerSampleBenchmark) {
+  constexpr int SampleCount = 500000;
+  // 10 ms sampling with 5 s reporting window
+  constexpr int SamplesPerWindow = 500;
+  EMWithScriptedReadings em;
+  em.setSamplingIntervalMs(10);
+  em.readValuesFromDevice();
+
+  // device read is excluded, publishing of window is included
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= SampleCount; i++) {
+    em.addSample();
+    if (i % SamplesPerWindow == 0) {
+      em.applyAggregates();
+    }
+  }
+  auto durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  EmAggregate aggregate;
+  ASSERT_TRUE(em.getAggregate(EmMeasurement::PowerApparent, 2, &aggregate));
+  EXPECT_EQ(aggregate.samples, SamplesPerWindow);
+  EXPECT_EQ(aggregate.mean, 23000000);
+
+  RecordProperty("nsPerThreePhaseSample",
+                 std::to_string(durationNs / SampleCount));
+}
@@ -0,0 +1,236 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+
+#include <gtest/gtest.h>
+#include <simple_time.h>
+#include <supla/action_handler.h>
+#include <supla/channel.h>
+#include <supla/events.h>
+#include <supla/sensor/electricity_meter.h>
+
+#include <string>
+
+using Supla::Sensor::EmDeadband;
+using Supla::Sensor::EmDeadbandField;
+
+namespace {
+
+// Meter with 3 phases around 230 V and 5 A with deterministic noise
+class EMWithNoise : public Supla::Sensor::ElectricityMeter {
+ public:
+  void readValuesFromDevice() override {
+    if (error) {
+      resetReadParameters();
+      return;
+    }
+    for (int i = 0; i < MAX_PHASES; i++) {
+      setVoltage(i, voltage + noise(50));
+      setCurrent(i, current + noise(50));
+      setPowerActive(i, static_cast<int64_t>(voltage) * current + noise(50000));
+      setPowerFactor(i, 1000);
+      // 1.15 kW for 1 s
+      energy[i] += 32;
+      setFwdActEnergy(i, energy[i]);
+    }
+    setFreq(5000 + noise(3));
+  }
+
+  // Returns pseudo random value in range [-amplitude, amplitude]
+  int noise(int amplitude) {
+    seed = seed * 1103515245 + 12345;
+    return static_cast<int>((seed >> 16) % (2 * amplitude + 1)) - amplitude;
+  }
+
+  TElectricityMeter_ExtendedValue_V3 getReportedValue() {
+    TElectricityMeter_ExtendedValue_V3 value = {};
+    srpc_evtool_v3_extended2emextended(getChannel()->getExtValue(), &value);
+    return value;
+  }
+
+  uint16_t voltage = 23000;
+  uint32_t current = 5000;
+  uint64_t energy[MAX_PHASES] = {};
+  uint32_t seed = 1;
+  bool error = false;
+};
+
+class ReportCounter : public Supla::ActionHandler {
+ public:
+  void handleAction(int event, int action) override {
+    (void)(event);
+    (void)(action);
+    count++;
+  }
+
+  int count = 0;
+};
+
+class ElectricityMeterDeadbandTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Supla::Channel::resetToDefaults();
+    em.setRefreshRate(1);
+    em.addAction(0, &reports, Supla::ON_CHANGE);
+  }
+
+  void TearDown() override {
+    Supla::Channel::resetToDefaults();
+  }
+
+  void setDeadbands() {
+    em.setDeadband(EmDeadbandField::Voltage, 100);          // 1 V
+    em.setDeadband(EmDeadbandField::Current, 0, 20);        // 2 %
+    em.setDeadband(EmDeadbandField::PowerActive, 0, 20);    // 2 %
+    em.setDeadband(EmDeadbandField::Frequency, 10);         // 0.1 Hz
+    em.setDeadband(EmDeadbandField::Energy, 10000);         // 0.1 kWh
+  }
+
+  // Runs iterateAlways() every 100 ms for given time
+  void run(int durationMs) {
+    for (int i = 0; i < durationMs; i += 100) {
+      time.advance(100);
+      em.iterateAlways();
+    }
+  }
+
+  SimpleTime time;
+  EMWithNoise em;
+  ReportCounter reports;
+};
+
+}  // namespace
+
+TEST(EmDeadbandTests, AbsoluteAndRelativeDeadband) {
+  EmDeadband deadband;
+  // no deadband - any change is significant
+  EXPECT_FALSE(deadband.exceeds(EmDeadbandField::Voltage, 23000, 23000));
+  EXPECT_TRUE(deadband.exceeds(EmDeadbandField::Voltage, 23000, 23001));
+
+  deadband.setDeadband(EmDeadbandField::Voltage, 100, 0);
+  EXPECT_FALSE(deadband.exceeds(EmDeadbandField::Voltage, 23000, 23100));
+  EXPECT_FALSE(deadband.exceeds(EmDeadbandField::Voltage, 23000, 22900));
+  EXPECT_TRUE(deadband.exceeds(EmDeadbandField::Voltage, 23000, 23101));
+  EXPECT_TRUE(deadband.exceeds(EmDeadbandField::Voltage, 23000, 22899));
+
+  // 1 % of reported value
+  deadband.setDeadband(EmDeadbandField::PowerActive, 0, 10);
+  EXPECT_FALSE(
+      deadband.exceeds(EmDeadbandField::PowerActive, -100000000, -99000000));
+  EXPECT_TRUE(
+      deadband.exceeds(EmDeadbandField::PowerActive, -100000000, -98999999));
+  EXPECT_TRUE(deadband.exceeds(EmDeadbandField::PowerActive, 0, 1));
+
+  // both deadbands have to be exceeded
+  deadband.setDeadband(EmDeadbandField::Current, 50, 10);
+  EXPECT_FALSE(deadband.exceeds(EmDeadbandField::Current, 1000, 1040));
+  EXPECT_TRUE(deadband.exceeds(EmDeadbandField::Current, 1000, 1051));
+  EXPECT_FALSE(deadband.exceeds(EmDeadbandField::Current, 10000, 10090));
+  EXPECT_TRUE(deadband.exceeds(EmDeadbandField::Current, 10000, 10101));
+}
+
+TEST_F(ElectricityMeterDeadbandTests, NoisyValuesAreNotReported) {
+  setDeadbands();
+  run(100);
+  EXPECT_EQ(reports.count, 1);
+  auto reported = em.getReportedValue();
+  EXPECT_EQ(reported.m_count, 1);
+
+  // noise is within deadbands, only energy exceeds 0.1 kWh once
+  run(10 * 60 * 1000);
+  EXPECT_EQ(reports.count, 2);
+
+  // voltage step is reported on next refresh
+  em.voltage = 23300;
+  run(1000);
+  EXPECT_EQ(reports.count, 3);
+  reported = em.getReportedValue();
+  EXPECT_GT(reported.m[0].voltage[0], 23200);
+  EXPECT_GT(reported.m[0].voltage[2], 23200);
+
+  // current drop
+  em.current = 4000;
+  run(1000);
+  EXPECT_EQ(reports.count, 4);
+  reported = em.getReportedValue();
+  EXPECT_LT(reported.m[0].current[1], 4100);
+
+  // communication error is always reported
+  em.error = true;
+  run(1000);
+  EXPECT_EQ(reports.count, 5);
+  reported = em.getReportedValue();
+  EXPECT_EQ(reported.m_count, 0);
+}
+
+TEST_F(ElectricityMeterDeadbandTests, ReportIntervals) {
+  setDeadbands();
+  em.setReportIntervalMs(10000, 60000);
+  run(100);
+  EXPECT_EQ(reports.count, 1);
+
+  // changes within deadband are reported every 60 s
+  run(61 * 1000);
+  EXPECT_EQ(reports.count, 2);
+  run(61 * 1000);
+  EXPECT_EQ(reports.count, 3);
+
+  // step is reported after min interval since last report
+  run(2000);
+  em.voltage = 23500;
+  run(1000);
+  EXPECT_EQ(reports.count, 3);
+  run(8500);
+  EXPECT_EQ(reports.count, 4);
+  auto reported = em.getReportedValue();
+  EXPECT_GT(reported.m[0].voltage[0], 23400);
+
+  // registration forces report
+  em.sendDataWithDelay(0);
+  run(100);
+  EXPECT_EQ(reports.count, 5);
+}
+
+TEST_F(ElectricityMeterDeadbandTests, ReportsCountBenchmark) {
+  constexpr int DurationMs = 60 * 60 * 1000;
+  run(DurationMs);
+  int withoutDeadband = reports.count;
+
+  Supla::Channel::resetToDefaults();
+  EMWithNoise filteredEm;
+  ReportCounter filteredReports;
+  filteredEm.setRefreshRate(1);
+  filteredEm.addAction(0, &filteredReports, Supla::ON_CHANGE);
+  filteredEm.setDeadband(EmDeadbandField::Voltage, 100);
+  filteredEm.setDeadband(EmDeadbandField::Current, 0, 20);
+  filteredEm.setDeadband(EmDeadbandField::PowerActive, 0, 20);
+  filteredEm.setDeadband(EmDeadbandField::Frequency, 10);
+  filteredEm.setDeadband(EmDeadbandField::Energy, 10000);
+  filteredEm.setReportIntervalMs(0, 5 * 60 * 1000);
+  for (int i = 0; i < DurationMs; i += 100) {
+    time.advance(100);
+    filteredEm.iterateAlways();
+  }
+  int withDeadband = filteredReports.count;
+
+  // every refresh (1 s, checked every 100 ms) has new noisy values
+  EXPECT_GT(withoutDeadband, DurationMs / 1100 - 10);
+  EXPECT_LT(withDeadband, withoutDeadband / 50);
+
+  RecordProperty("reportsPerHourWithoutDeadband",
+                 std::to_string(withoutDeadband));
+  RecordProperty("reportsPerHourWithDeadband", std::to_string(withDeadband));
+}
@@ -127,6 +127,66 @@ TEST_F(ElementTests, ElementListAdding) {
   EXPECT_EQ(Supla::Element::last(), nullptr);
 }
 
+TEST_F(ElementTests, GetElementByChannelNumberAfterRenumbering) {
+  ElementWithChannel el1;
+  ElementWithChannel el2;
+  Supla::Element noChannel;
+
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(0), &el1);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(1), &el2);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(2), nullptr);
+
+  el2.channel.setChannelNumber(10);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(1), nullptr);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(10), &el2);
+
+  // conflicting number - channels are swapped
+  el1.channel.setChannelNumber(10);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(0), &el2);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(10), &el1);
+
+  {
+    ElementWithChannel el3;
+    EXPECT_EQ(el3.getChannelNumber(), 1);
+    EXPECT_EQ(Supla::Element::getElementByChannelNumber(1), &el3);
+  }
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(1), nullptr);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(0), &el2);
+  EXPECT_EQ(Supla::Element::getElementByChannelNumber(10), &el1);
+}
+
+TEST_F(ElementTests, ElementListWithManyElements) {
+  const int count = 10000;
+  Supla::Element *elements[count] = {};
+  for (int i = 0; i < count; i++) {
+    elements[i] = new Supla::Element;
+    EXPECT_EQ(Supla::Element::last(), elements[i]);
+  }
+  EXPECT_EQ(Supla::Element::begin(), elements[0]);
+
+  // remove every second element, starting from the end
+  for (int i = count - 1; i >= 0; i -= 2) {
+    delete elements[i];
+    elements[i] = nullptr;
+  }
+  EXPECT_EQ(Supla::Element::begin(), elements[0]);
+  EXPECT_EQ(Supla::Element::last(), elements[count - 2]);
+
+  int i = 0;
+  for (auto element = Supla::Element::begin(); element != nullptr;
+       element = element->next()) {
+    EXPECT_EQ(element, elements[i]);
+    i += 2;
+  }
+  EXPECT_EQ(i, count);
+
+  for (i = 0; i < count; i += 2) {
+    delete elements[i];
+  }
+  EXPECT_EQ(Supla::Element::begin(), nullptr);
+  EXPECT_EQ(Supla::Element::last(), nullptr);
+}
+
 TEST_F(ElementTests, NoChannelElementMethods) {
   TimeInterfaceMock time;
   Supla::Element el1;
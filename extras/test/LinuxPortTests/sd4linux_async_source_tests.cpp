@@ -0,0 +1,259 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <simple_time.h>
+#include <supla/parser/parser.h>
+#include <supla/source/async.h>
+#include <supla/source/cmd.h>
+#include <supla/source/source.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <variant>
+
+namespace {
+
+// Source which blocks in getContent() until released by test
+class BlockingSd4linuxSource : public Supla::Source::Source {
+ public:
+  std::string getContent() override {
+    std::unique_lock<std::mutex> lock(mutex);
+    started = true;
+    cv.notify_all();
+    cv.wait(lock, [this] { return released; });
+    released = false;
+    calls++;
+    return content;
+  }
+
+  void release(const std::string &newContent) {
+    std::lock_guard<std::mutex> lock(mutex);
+    content = newContent;
+    released = true;
+    cv.notify_all();
+  }
+
+  bool waitForStart() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(
+        lock, std::chrono::seconds(5), [this] { return started; });
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::string content;
+  bool started = false;
+  bool released = false;
+  int calls = 0;
+};
+
+class SleepingSd4linuxSource : public Supla::Source::Source {
+ public:
+  SleepingSd4linuxSource(std::atomic<bool> *running,
+                         std::atomic<bool> *finished)
+      : running(running), finished(finished) {
+  }
+
+  std::string getContent() override {
+    *running = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    *finished = true;
+    return "done";
+  }
+
+  std::atomic<bool> *running = nullptr;
+  std::atomic<bool> *finished = nullptr;
+};
+
+class ContentSd4linuxParser : public Supla::Parser::Parser {
+ public:
+  explicit ContentSd4linuxParser(Supla::Source::Source *source)
+      : Supla::Parser::Parser(source) {
+  }
+
+  std::string lastContent;
+  int refreshCount = 0;
+
+  double getValue(const std::string &) override {
+    return 0;
+  }
+
+  std::variant<int, bool, std::string> getStateValue(
+      const std::string &) override {
+    return lastContent;
+  }
+
+  bool isBasedOnIndex() override {
+    return false;
+  }
+
+ protected:
+  bool refreshSource() override {
+    refreshCount++;
+    lastContent = source->getContent();
+    valid = !lastContent.empty();
+    return valid;
+  }
+};
+
+bool waitForGeneration(Supla::Source::Source *source, uint32_t generation) {
+  for (int i = 0; i < 500; i++) {
+    if (source->getContentGeneration() == generation) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(Sd4linuxAsyncSourceTests, SlowSourceDoesNotBlockParserRefresh) {
+  SimpleTime time;
+  auto blocking = new BlockingSd4linuxSource;
+  Supla::Source::Async async(blocking);
+  ContentSd4linuxParser parser(&async);
+  parser.setRefreshTime(1000);
+
+  EXPECT_TRUE(async.isEventDriven());
+
+  time.advance(100);
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(parser.refreshParserSource());
+  ASSERT_TRUE(blocking->waitForStart());
+  // source is blocked on worker thread, so main loop keeps going
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_TRUE(async.isRefreshInProgress());
+  EXPECT_EQ(parser.refreshCount, 0);
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(500));
+
+  blocking->release("value 1");
+  ASSERT_TRUE(waitForGeneration(&async, 1));
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(parser.refreshCount, 1);
+  EXPECT_EQ(parser.lastContent, "value 1");
+  EXPECT_TRUE(parser.isValid());
+
+  // no new snapshot and refresh time not elapsed - parser is not refreshed
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(parser.refreshCount, 1);
+  EXPECT_FALSE(async.isRefreshInProgress());
+
+  time.advance(1001);
+  blocking->release("value 2");
+  EXPECT_TRUE(parser.refreshParserSource());
+  ASSERT_TRUE(waitForGeneration(&async, 2));
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(parser.refreshCount, 2);
+  EXPECT_EQ(parser.lastContent, "value 2");
+
+  auto stats = async.getStats();
+  EXPECT_EQ(stats.refreshCount, 2);
+  EXPECT_EQ(stats.timeoutCount, 0);
+  EXPECT_EQ(blocking->calls, 2);
+}
+
+TEST(Sd4linuxAsyncSourceTests, TimeoutInvalidatesSnapshotUntilRefreshEnds) {
+  SimpleTime time;
+  auto blocking = new BlockingSd4linuxSource;
+  Supla::Source::Async async(blocking, 50);
+  ContentSd4linuxParser parser(&async);
+  parser.setRefreshTime(1000);
+
+  time.advance(100);
+  blocking->release("old");
+  EXPECT_TRUE(parser.refreshParserSource());
+  ASSERT_TRUE(waitForGeneration(&async, 1));
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(parser.lastContent, "old");
+
+  time.advance(1001);
+  EXPECT_TRUE(parser.refreshParserSource());
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // timeout clears snapshot, so parser becomes invalid
+  EXPECT_FALSE(parser.refreshParserSource());
+  EXPECT_FALSE(parser.isValid());
+  EXPECT_EQ(async.getStats().timeoutCount, 1);
+
+  // timeout is counted once per refresh
+  time.advance(1001);
+  EXPECT_FALSE(parser.isValid());
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(async.getStats().timeoutCount, 1);
+
+  blocking->release("new");
+  ASSERT_TRUE(waitForGeneration(&async, 3));
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(parser.lastContent, "new");
+
+  auto stats = async.getStats();
+  EXPECT_EQ(stats.refreshCount, 2);
+  EXPECT_GE(stats.lastDurationMs, 50);
+  EXPECT_GE(stats.maxDurationMs, stats.lastDurationMs);
+}
+
+TEST(Sd4linuxAsyncSourceTests, DestructorWaitsForRunningRefresh) {
+  std::atomic<bool> running(false);
+  std::atomic<bool> finished(false);
+  {
+    Supla::Source::Async async(
+        new SleepingSd4linuxSource(&running, &finished));
+    async.requestRefresh();
+    while (!running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_TRUE(finished);
+}
+
+TEST(Sd4linuxAsyncSourceTests, DestructorRacingWithRefreshEnd) {
+  // source is destroyed as soon as refresh result is visible, while worker
+  // may still be finishing refreshFromWorker()
+  for (int i = 0; i < 200; i++) {
+    auto source = new BlockingSd4linuxSource;
+    auto async = new Supla::Source::Async(source);
+    async->requestRefresh();
+    ASSERT_TRUE(source->waitForStart());
+    source->release("x");
+    while (async->isRefreshInProgress()) {
+    }
+    delete async;
+  }
+}
+
+TEST(Sd4linuxCmdSourceTests, CommandOutputIsReturned) {
+  Supla::Source::Cmd cmd("printf 'abc\\n123'");
+  EXPECT_EQ(cmd.getContent(), "abc\n123");
+  cmd.setTimeoutMs(2000);
+  EXPECT_EQ(cmd.getContent(), "abc\n123");
+}
+
+TEST(Sd4linuxCmdSourceTests, CommandIsKilledAfterTimeout) {
+  Supla::Source::Cmd cmd("echo partial; sleep 10; echo never");
+  cmd.setTimeoutMs(100);
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(cmd.getContent(), "");
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
@@ -0,0 +1,270 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <supla/output/cmd.h>
+#include <supla/output/cmd_executor.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Supla::Output::CmdExecutor;
+using Supla::Output::CmdResult;
+
+namespace {
+
+class Sd4linuxCmdExecutorTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = std::filesystem::temp_directory_path() /
+          ("sd4linux_cmd_executor_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    logFile = (dir / "log").string();
+  }
+
+  void TearDown() override {
+    CmdExecutor::SetConcurrency(4);
+    std::filesystem::remove_all(dir);
+  }
+
+  std::string readLog() {
+    std::ifstream file(logFile);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  // appends "text" to log file after delaySec
+  std::string appendCmd(const std::string &text, const char *delaySec = "0") {
+    return std::string("sleep ") + delaySec + "; echo " + text + " >> " +
+           logFile;
+  }
+
+  std::filesystem::path dir;
+  std::string logFile;
+};
+
+int64_t elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+TEST_F(Sd4linuxCmdExecutorTests, RunReportsExitCodeAndKillsOnTimeout) {
+  auto result = CmdExecutor::Run("true", 0);
+  EXPECT_TRUE(result.isSuccess());
+  EXPECT_EQ(result.exitCode, 0);
+
+  result = CmdExecutor::Run("exit 3", 1000);
+  EXPECT_FALSE(result.isSuccess());
+  EXPECT_FALSE(result.timedOut);
+  EXPECT_EQ(result.exitCode, 3);
+
+  // whole process group is killed, including background child
+  auto start = std::chrono::steady_clock::now();
+  result = CmdExecutor::Run("sleep 5 & sleep 5", 100);
+  EXPECT_LT(elapsedMs(start), 2000);
+  EXPECT_TRUE(result.timedOut);
+  EXPECT_FALSE(result.isSuccess());
+  EXPECT_EQ(result.exitCode, -1);
+  EXPECT_GE(result.durationMs, 100u);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, SlowCommandsDontBlockCaller) {
+  CmdExecutor executor;
+  int keys[3] = {};
+  std::vector<CmdResult> results;
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto &key : keys) {
+    executor.execute(&key,
+                     "sleep 0.3",
+                     CmdExecutor::Mode::Queue,
+                     [&](const CmdResult &result) {
+                       results.push_back(result);
+                     });
+  }
+  EXPECT_LT(elapsedMs(start), 100);
+
+  ASSERT_TRUE(executor.waitForIdle(5000));
+  // commands with different keys run in parallel
+  EXPECT_LT(elapsedMs(start), 800);
+  // callbacks are called only from processResults()
+  EXPECT_TRUE(results.empty());
+  executor.iterateAlways();
+  ASSERT_EQ(results.size(), 3u);
+  for (auto &result : results) {
+    EXPECT_TRUE(result.isSuccess());
+    EXPECT_GE(result.durationMs, 300u);
+  }
+  EXPECT_EQ(executor.getStats().executed, 3u);
+  EXPECT_EQ(executor.getStats().maxRunning, 3u);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, CommandsWithSameKeyAreExecutedInOrder) {
+  CmdExecutor executor;
+  int key = 0;
+  // later commands are faster, so wrong order would be visible
+  executor.execute(&key, appendCmd("1", "0.2"));
+  executor.execute(&key, appendCmd("2", "0.1"));
+  executor.execute(&key, appendCmd("3"));
+
+  ASSERT_TRUE(executor.waitForIdle(5000));
+  EXPECT_EQ(readLog(), "1\n2\n3\n");
+  EXPECT_EQ(executor.getStats().maxRunning, 1u);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, LatestWinsDropsNotStartedCommands) {
+  CmdExecutor executor;
+  int key = 0;
+  int callbacks = 0;
+  auto onDone = [&](const CmdResult &) { callbacks++; };
+  executor.execute(
+      &key, appendCmd("first", "0.2"), CmdExecutor::Mode::LatestWins, onDone);
+  // wait until first command is started
+  while (executor.getStats().maxRunning == 0) {
+    usleep(1000);
+  }
+  executor.execute(
+      &key, appendCmd("on"), CmdExecutor::Mode::LatestWins, onDone);
+  executor.execute(
+      &key, appendCmd("off"), CmdExecutor::Mode::LatestWins, onDone);
+  executor.execute(
+      &key, appendCmd("latest"), CmdExecutor::Mode::LatestWins, onDone);
+
+  ASSERT_TRUE(executor.waitForIdle(5000));
+  executor.processResults();
+  // running command isn't interrupted
+  EXPECT_EQ(readLog(), "first\nlatest\n");
+  EXPECT_EQ(callbacks, 2);
+  EXPECT_EQ(executor.getStats().superseded, 2u);
+  EXPECT_EQ(executor.getStats().executed, 2u);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, ConcurrencyIsLimited) {
+  CmdExecutor::SetConcurrency(2);
+  CmdExecutor executor;
+  int keys[6] = {};
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto &key : keys) {
+    executor.execute(&key, "sleep 0.1");
+  }
+  ASSERT_TRUE(executor.waitForIdle(5000));
+
+  EXPECT_EQ(executor.getStats().maxRunning, 2u);
+  EXPECT_EQ(executor.getStats().executed, 6u);
+  // 3 rounds of 2 commands
+  EXPECT_GE(elapsedMs(start), 300);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, TimeoutAndFailureAreReported) {
+  CmdExecutor executor;
+  int key = 0;
+  std::vector<CmdResult> results;
+  auto onDone = [&](const CmdResult &result) { results.push_back(result); };
+
+  executor.execute(&key, "sleep 5", CmdExecutor::Mode::Queue, 100, onDone);
+  executor.execute(&key, "exit 1", CmdExecutor::Mode::Queue, 100, onDone);
+  ASSERT_TRUE(executor.waitForIdle(5000));
+  executor.processResults();
+
+  ASSERT_EQ(results.size(), 2u);
+  EXPECT_TRUE(results[0].timedOut);
+  EXPECT_EQ(results[0].cmd, "sleep 5");
+  EXPECT_EQ(results[1].exitCode, 1);
+  EXPECT_EQ(executor.getStats().timeouts, 1u);
+  EXPECT_EQ(executor.getStats().failed, 1u);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, DestructorKillsCommandsWithoutTimeout) {
+  auto start = std::chrono::steady_clock::now();
+  {
+    CmdExecutor executor;
+    int keys[2] = {};
+    for (auto &key : keys) {
+      executor.execute(
+          &key, "sleep 1000 & sleep 1000", CmdExecutor::Mode::Queue, 0, {});
+    }
+    // commands which are started after destructor was called are killed
+    // right after fork, so it doesn't matter if they already started
+    while (executor.getStats().maxRunning < 2) {
+      usleep(1000);
+    }
+  }
+  EXPECT_LT(elapsedMs(start), 2000);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, CancelDropsPendingCommandsAndResults) {
+  CmdExecutor executor;
+  int key = 0;
+  int callbacks = 0;
+  auto onDone = [&](const CmdResult &) { callbacks++; };
+  executor.execute(
+      &key, appendCmd("first", "0.1"), CmdExecutor::Mode::Queue, onDone);
+  executor.execute(
+      &key, appendCmd("second"), CmdExecutor::Mode::Queue, onDone);
+  while (executor.getStats().maxRunning == 0) {
+    usleep(1000);
+  }
+  executor.cancel(&key);
+
+  ASSERT_TRUE(executor.waitForIdle(5000));
+  executor.processResults();
+  EXPECT_EQ(readLog(), "first\n");
+  EXPECT_EQ(callbacks, 0);
+}
+
+TEST_F(Sd4linuxCmdExecutorTests, BenchmarkCmdOutputVersusBlockingPopen) {
+  const int commandCount = 5;
+  const char *slowCmd = "sleep 0.1";
+
+  // previous implementation: popen/pclose on main loop
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < commandCount; i++) {
+    auto p = popen(slowCmd, "r");
+    pclose(p);
+  }
+  int64_t blockingMs = elapsedMs(start);
+
+  std::vector<std::unique_ptr<Supla::Output::Output>> outputs;
+  for (int i = 0; i < commandCount; i++) {
+    outputs.emplace_back(new Supla::Output::Cmd("sleep 0.1; true"));
+  }
+  start = std::chrono::steady_clock::now();
+  for (auto &output : outputs) {
+    EXPECT_TRUE(output->putContent(1));
+  }
+  int64_t mainLoopBlockedMs = elapsedMs(start);
+  ASSERT_TRUE(CmdExecutor::Instance()->waitForIdle(5000));
+  int64_t completedMs = elapsedMs(start);
+
+  EXPECT_LT(mainLoopBlockedMs, blockingMs);
+
+  RecordProperty("blockingPopenMs", std::to_string(blockingMs));
+  RecordProperty("asyncMainLoopBlockedMs", std::to_string(mainLoopBlockedMs));
+  RecordProperty("asyncAllCompletedMs", std::to_string(completedMs));
+}
@@ -0,0 +1,355 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <linux_event_loop.h>
+#include <simple_time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+namespace {
+
+int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+class EventLoopForTest : public Supla::Linux::EventLoop {
+ public:
+  int timerTicks = 0;
+  int fastTimerTicks = 0;
+  int iterations = 0;
+
+ protected:
+  void onTimerTick() override {
+    timerTicks++;
+  }
+  void onFastTimerTick() override {
+    fastTimerTicks++;
+  }
+  void onIterate() override {
+    iterations++;
+  }
+};
+
+class Pipe {
+ public:
+  Pipe() {
+    EXPECT_EQ(pipe2(fds, O_NONBLOCK | O_CLOEXEC), 0);
+  }
+  ~Pipe() {
+    closeWriteEnd();
+    close(fds[0]);
+  }
+  void closeWriteEnd() {
+    if (fds[1] >= 0) {
+      close(fds[1]);
+      fds[1] = -1;
+    }
+  }
+  void write(int64_t value) {
+    EXPECT_EQ(::write(fds[1], &value, sizeof(value)), sizeof(value));
+  }
+  bool read(int64_t *value) {
+    return ::read(fds[0], value, sizeof(*value)) == sizeof(*value);
+  }
+  int readFd() const {
+    return fds[0];
+  }
+
+ private:
+  int fds[2] = {-1, -1};
+};
+
+}  // namespace
+
+class Sd4linuxEventLoopTests : public ::testing::Test {
+ protected:
+  // EventLoop uses millis() for stats logging
+  SimpleTime time;
+};
+
+TEST_F(Sd4linuxEventLoopTests, SingleInstance) {
+  EXPECT_EQ(Supla::Linux::EventLoop::Instance(), nullptr);
+  {
+    EventLoopForTest loop;
+    EXPECT_TRUE(loop.isInitialized());
+    EXPECT_EQ(Supla::Linux::EventLoop::Instance(), &loop);
+
+    EventLoopForTest second;
+    EXPECT_FALSE(second.isInitialized());
+    EXPECT_EQ(Supla::Linux::EventLoop::Instance(), &loop);
+  }
+  EXPECT_EQ(Supla::Linux::EventLoop::Instance(), nullptr);
+  // no instance - nothing happens
+  Supla::Linux::EventLoop::WakeUp();
+  Supla::Linux::EventLoop::AddFd(0);
+  Supla::Linux::EventLoop::RemoveFd(0);
+}
+
+TEST_F(Sd4linuxEventLoopTests, ReadableFdRunsCallbackAndIterate) {
+  EventLoopForTest loop;
+  loop.setTimerIntervalMs(10000);
+  Pipe pipe;
+  int callbacks = 0;
+  EXPECT_FALSE(loop.addFd(-1));
+  EXPECT_TRUE(loop.addFd(pipe.readFd(), [&]() {
+    int64_t value = 0;
+    while (pipe.read(&value)) {
+      callbacks++;
+    }
+  }));
+
+  pipe.write(1);
+  loop.runOnce(1000);
+  EXPECT_EQ(callbacks, 1);
+  EXPECT_EQ(loop.iterations, 1);
+  EXPECT_EQ(loop.timerTicks, 0);
+  EXPECT_EQ(loop.getStats().fdWakeups, 1);
+
+  // nothing to read - timeout
+  loop.runOnce(10);
+  EXPECT_EQ(callbacks, 1);
+  EXPECT_EQ(loop.getStats().fdWakeups, 1);
+
+  loop.removeFd(pipe.readFd());
+  pipe.write(2);
+  loop.runOnce(10);
+  EXPECT_EQ(callbacks, 1);
+}
+
+TEST_F(Sd4linuxEventLoopTests, ClosedFdIsRemoved) {
+  EventLoopForTest loop;
+  loop.setTimerIntervalMs(10000);
+  Pipe pipe;
+  int callbacks = 0;
+  EXPECT_TRUE(
+      Supla::Linux::EventLoop::Instance()->addFd(pipe.readFd(), [&]() {
+        callbacks++;
+      }));
+
+  pipe.closeWriteEnd();
+  loop.runOnce(1000);
+  EXPECT_EQ(callbacks, 1);
+  // hang up is reported only once
+  loop.runOnce(10);
+  EXPECT_EQ(callbacks, 1);
+  EXPECT_EQ(loop.getStats().fdWakeups, 1);
+}
+
+TEST_F(Sd4linuxEventLoopTests, WakeUpFromOtherThread) {
+  EventLoopForTest loop;
+  loop.setTimerIntervalMs(10000);
+
+  std::thread waker([]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    Supla::Linux::EventLoop::WakeUp();
+  });
+  auto start = nowUs();
+  loop.runOnce(5000);
+  auto durationUs = nowUs() - start;
+  waker.join();
+
+  EXPECT_LT(durationUs, 1000000);
+  EXPECT_EQ(loop.iterations, 1);
+  EXPECT_EQ(loop.timerTicks, 0);
+}
+
+TEST_F(Sd4linuxEventLoopTests, TimerTicks) {
+  EventLoopForTest loop;
+  EXPECT_EQ(loop.getTimerIntervalMs(), 10);
+  EXPECT_EQ(loop.getIdleIterateIntervalMs(), 100);
+  loop.setIdleIterateIntervalMs(0);
+
+  auto start = nowUs();
+  while (nowUs() - start < 200000) {
+    loop.runOnce();
+  }
+  // ~20 ticks, with margin for slow test machines
+  EXPECT_GE(loop.timerTicks, 10);
+  EXPECT_LE(loop.timerTicks, 21);
+  EXPECT_EQ(loop.iterations, loop.getStats().wakeups);
+  EXPECT_EQ(loop.getStats().timerTicks, loop.timerTicks);
+
+  // iterate blocking for longer than timer interval - ticks are coalesced
+  loop.resetStats();
+  loop.timerTicks = 0;
+  std::this_thread::sleep_for(std::chrono::milliseconds(35));
+  loop.runOnce();
+  EXPECT_EQ(loop.timerTicks, 1);
+  EXPECT_GE(loop.getStats().missedTicks, 2);
+}
+
+TEST_F(Sd4linuxEventLoopTests, FastTimer) {
+  EventLoopForTest loop;
+  loop.setTimerIntervalMs(5);
+  loop.setIdleIterateIntervalMs(0);
+  EXPECT_FALSE(loop.isFastTimerEnabled());
+
+  // disabled fast timer - onFastTimer is called on regular timer tick
+  while (loop.timerTicks < 3) {
+    loop.runOnce();
+  }
+  EXPECT_EQ(loop.fastTimerTicks, loop.timerTicks);
+  EXPECT_EQ(loop.getStats().fastTimerTicks, 0);
+
+  loop.setTimerIntervalMs(10000);
+  loop.setFastTimerEnabled(true);
+  EXPECT_TRUE(loop.isFastTimerEnabled());
+  loop.resetStats();
+  loop.timerTicks = 0;
+  loop.fastTimerTicks = 0;
+  loop.iterations = 0;
+  for (int i = 0; i < 5; i++) {
+    loop.runOnce(1000);
+  }
+  // each wakeup is caused by fast timer and it doesn't call iterate
+  EXPECT_EQ(loop.fastTimerTicks, 5);
+  EXPECT_EQ(loop.getStats().fastTimerTicks, 5);
+  EXPECT_EQ(loop.getStats().wakeups, 5);
+  EXPECT_EQ(loop.timerTicks, 0);
+  EXPECT_EQ(loop.iterations, 0);
+
+  loop.setFastTimerEnabled(false);
+  loop.fastTimerTicks = 0;
+  loop.runOnce(20);
+  EXPECT_EQ(loop.fastTimerTicks, 0);
+  EXPECT_EQ(loop.iterations, 1);
+}
+
+TEST_F(Sd4linuxEventLoopTests, IdleTimerTicksSkipIterate) {
+  EventLoopForTest loop;
+  loop.setTimerIntervalMs(5);
+  loop.setIdleIterateIntervalMs(100000);
+  loop.iterations = 0;
+
+  while (loop.timerTicks < 5) {
+    loop.runOnce();
+  }
+  EXPECT_EQ(loop.iterations, 0);
+  EXPECT_EQ(loop.getStats().skippedIterations, loop.getStats().wakeups);
+
+  // wakeUp() is an event, so iterate() is called regardless of interval
+  loop.wakeUp();
+  loop.runOnce();
+  EXPECT_EQ(loop.iterations, 1);
+
+  loop.setIdleIterateIntervalMs(-5);
+  EXPECT_EQ(loop.getIdleIterateIntervalMs(), 0);
+  loop.runOnce();
+  EXPECT_EQ(loop.iterations, 2);
+}
+
+TEST_F(Sd4linuxEventLoopTests, BenchmarkWakeupsAndLatencyVersusDelayLoop) {
+  const int messageCount = 20;
+
+  // Legacy: main thread with iterate() + delay(10), and timer threads
+  // calling onTimer every 10 ms and onFastTimer every 1 ms
+  int64_t legacyLatencyUs = 0;
+  int legacyWakeups = 0;
+  {
+    Pipe pipe;
+    std::atomic<bool> stop(false);
+    std::atomic<int> wakeups(0);
+    auto timerThread = [&](int intervalMs) {
+      while (!stop) {
+        wakeups++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+      }
+    };
+    std::thread timer10(timerThread, 10);
+    std::thread timer1(timerThread, 1);
+
+    std::thread writer([&]() {
+      for (int i = 0; i < messageCount; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(13));
+        pipe.write(nowUs());
+      }
+    });
+    int received = 0;
+    auto start = nowUs();
+    while (received < messageCount || nowUs() - start < 500000) {
+      int64_t timestamp = 0;
+      while (pipe.read(&timestamp)) {
+        legacyLatencyUs += nowUs() - timestamp;
+        received++;
+      }
+      wakeups++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    auto durationUs = nowUs() - start;
+    stop = true;
+    writer.join();
+    timer10.join();
+    timer1.join();
+    legacyLatencyUs /= messageCount;
+    legacyWakeups = wakeups * 1000000LL / durationUs;
+  }
+
+  // Event loop
+  int64_t loopLatencyUs = 0;
+  int loopWakeups = 0;
+  Supla::Linux::EventLoopStats stats;
+  {
+    EventLoopForTest loop;
+    Pipe pipe;
+    int received = 0;
+    loop.addFd(pipe.readFd(), [&]() {
+      int64_t timestamp = 0;
+      while (pipe.read(&timestamp)) {
+        loopLatencyUs += nowUs() - timestamp;
+        received++;
+      }
+    });
+
+    std::thread writer([&]() {
+      for (int i = 0; i < messageCount; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(13));
+        pipe.write(nowUs());
+      }
+    });
+    auto start = nowUs();
+    while (received < messageCount || nowUs() - start < 500000) {
+      loop.runOnce();
+    }
+    auto durationUs = nowUs() - start;
+    writer.join();
+    stats = loop.getStats();
+    loopLatencyUs /= messageCount;
+    loopWakeups = stats.wakeups * 1000000LL / durationUs;
+  }
+
+  // Latency and wakeup rate depend on scheduler, so they are only recorded
+  EXPECT_EQ(stats.iterations + stats.skippedIterations, stats.wakeups);
+  EXPECT_GE(stats.iterations, messageCount);
+  EXPECT_EQ(stats.fastTimerTicks, 0);
+
+  RecordProperty("legacyWakeupsPerSec", std::to_string(legacyWakeups));
+  RecordProperty("legacyAvgLatencyUs", std::to_string(legacyLatencyUs));
+  RecordProperty("eventLoopWakeupsPerSec", std::to_string(loopWakeups));
+  RecordProperty("eventLoopAvgLatencyUs", std::to_string(loopLatencyUs));
+  RecordProperty("eventLoopIterations", std::to_string(stats.iterations));
+  RecordProperty("eventLoopMaxTimerLatencyUs",
+                 std::to_string(stats.maxTimerLatencyUs));
+}
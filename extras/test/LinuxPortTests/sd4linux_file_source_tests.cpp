@@ -0,0 +1,153 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <simple_time.h>
+#include <supla/parser/simple.h>
+#include <supla/source/file.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+class Sd4linuxFileSourceTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir = std::filesystem::temp_directory_path() /
+          ("sd4linux_file_source_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(dir);
+  }
+
+  std::string writeFile(const std::string &name, const std::string &content) {
+    auto path = dir / name;
+    std::ofstream file(path, std::ios::trunc);
+    file << content;
+    return path.string();
+  }
+
+  std::filesystem::path dir;
+};
+
+double processCpuTimeMs() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+}  // namespace
+
+TEST_F(Sd4linuxFileSourceTests, LastLineWithoutNewLineIsTerminated) {
+  auto path = writeFile("value", "1\n2");
+  Supla::Source::File file(path.c_str(), 0);
+  EXPECT_EQ(file.getContent(), "1\n2\n");
+}
+
+TEST_F(Sd4linuxFileSourceTests, WatchedFileIsReadOnlyWhenModified) {
+  SimpleTime time;
+  auto path = writeFile("value", "1\n");
+  Supla::Source::File file(path.c_str(), 0);
+  file.setWatch(true);
+  ASSERT_TRUE(file.isEventDriven());
+
+  Supla::Parser::Simple parser(&file);
+  parser.addKey("v", 0);
+  parser.setRefreshTime(60000);
+
+  time.advance(10);
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_DOUBLE_EQ(parser.getValue("v"), 1);
+
+  for (int i = 0; i < 10; i++) {
+    time.advance(1000);
+    EXPECT_TRUE(parser.refreshParserSource());
+  }
+  EXPECT_EQ(file.getSnapshotStats().reads, 1);
+
+  // change is visible on next iteration, without waiting for refresh time
+  writeFile("value", "2\n");
+  time.advance(10);
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_DOUBLE_EQ(parser.getValue("v"), 2);
+
+  // file replaced by rename
+  auto tmpPath = writeFile("value.tmp", "3\n");
+  std::filesystem::rename(tmpPath, path);
+  time.advance(10);
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_DOUBLE_EQ(parser.getValue("v"), 3);
+
+  // other files in the same directory are ignored
+  uint32_t generation = file.getContentGeneration();
+  writeFile("other", "5\n");
+  time.advance(10);
+  EXPECT_EQ(file.getContentGeneration(), generation);
+}
+
+TEST_F(Sd4linuxFileSourceTests, BenchmarkPollingVersusWatchMode) {
+  const int fileCount = 200;
+  const int periods = 120;
+  std::vector<std::string> paths;
+  for (int i = 0; i < fileCount; i++) {
+    paths.push_back(writeFile("f" + std::to_string(i), "1\n2\n3\n"));
+  }
+
+  double cpuMs[2] = {};
+  for (int watch = 0; watch < 2; watch++) {
+    SimpleTime time;
+    std::vector<std::unique_ptr<Supla::Source::File>> files;
+    std::vector<std::unique_ptr<Supla::Parser::Simple>> parsers;
+    for (auto &path : paths) {
+      files.emplace_back(new Supla::Source::File(path.c_str(), 0));
+      files.back()->setWatch(watch);
+      parsers.emplace_back(new Supla::Parser::Simple(files.back().get()));
+      parsers.back()->addKey("v", 2);
+      parsers.back()->setRefreshTime(1000);
+    }
+
+    double start = processCpuTimeMs();
+    for (int period = 0; period < periods; period++) {
+      // one file is modified every period
+      writeFile("f" + std::to_string(period % fileCount),
+                "1\n2\n" + std::to_string(period) + "\n");
+      // 10 main loop iterations per refresh period
+      for (int loop = 0; loop < 10; loop++) {
+        time.advance(101);
+        for (auto &parser : parsers) {
+          ASSERT_TRUE(parser->refreshParserSource());
+        }
+      }
+    }
+    cpuMs[watch] = processCpuTimeMs() - start;
+
+    EXPECT_DOUBLE_EQ(parsers[(periods - 1) % fileCount]->getValue("v"),
+                     periods - 1);
+  }
+
+  RecordProperty("pollingCpuMs", std::to_string(cpuMs[0]));
+  RecordProperty("watchCpuMs", std::to_string(cpuMs[1]));
+}
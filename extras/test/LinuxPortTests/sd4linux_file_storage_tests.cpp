@@ -0,0 +1,174 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <linux_file_storage.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <filesystem>  // NOLINT(build/c++17)
+#include <string>
+#include <vector>
+
+namespace {
+
+class TestLinuxFileStorage : public Supla::LinuxFileStorage {
+ public:
+  TestLinuxFileStorage(const std::string &path, unsigned int reservedSize)
+      : Supla::LinuxFileStorage(path, 0, reservedSize) {
+  }
+
+  using Supla::LinuxFileStorage::readStorage;
+  using Supla::LinuxFileStorage::updateStorage;
+
+  int writeStorage(unsigned int offset,
+                   const unsigned char *buf,
+                   unsigned int size) override {
+    writeCount++;
+    return Supla::LinuxFileStorage::writeStorage(offset, buf, size);
+  }
+
+  int writeCount = 0;
+};
+
+class Sd4linuxFileStorageTests : public ::testing::TestWithParam<bool> {
+ protected:
+  std::string dir;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/sd4linux_storage_XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    dir = tmpl;
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(dir);
+  }
+
+  uintmax_t stateFileSize() {
+    return std::filesystem::file_size(dir + "/state.bin");
+  }
+};
+
+TEST_P(Sd4linuxFileStorageTests, DataIsKeptBetweenInstances) {
+  const unsigned int size = 1000;
+  const unsigned char pattern[] = {1, 2, 3, 4, 5};
+  {
+    TestLinuxFileStorage storage(dir, size);
+    storage.setMemoryMapped(GetParam());
+    storage.init();
+    EXPECT_EQ(storage.isMemoryMapped(), GetParam());
+    storage.writeStorage(100, pattern, sizeof(pattern));
+    storage.writeStorage(900, pattern, sizeof(pattern));
+    storage.commit();
+  }
+  EXPECT_EQ(stateFileSize(), size);
+  EXPECT_FALSE(std::filesystem::exists(dir + "/state.bin.tmp"));
+
+  // reopen in other mode
+  TestLinuxFileStorage storage(dir, size);
+  storage.setMemoryMapped(!GetParam());
+  storage.init();
+  unsigned char buf[sizeof(pattern)] = {};
+  storage.readStorage(100, buf, sizeof(buf), false);
+  EXPECT_EQ(memcmp(buf, pattern, sizeof(pattern)), 0);
+  storage.readStorage(900, buf, sizeof(buf), false);
+  EXPECT_EQ(memcmp(buf, pattern, sizeof(pattern)), 0);
+  storage.readStorage(500, buf, sizeof(buf), false);
+  EXPECT_EQ(buf[0], 0);
+}
+
+TEST_P(Sd4linuxFileStorageTests, ReservedSizeChangeKeepsExistingData) {
+  const unsigned char pattern[] = {9, 8, 7};
+  {
+    TestLinuxFileStorage storage(dir, 100);
+    storage.setMemoryMapped(GetParam());
+    storage.init();
+    storage.writeStorage(10, pattern, sizeof(pattern));
+    storage.commit();
+  }
+
+  TestLinuxFileStorage storage(dir, 5000);
+  storage.setMemoryMapped(GetParam());
+  storage.init();
+  unsigned char buf[sizeof(pattern)] = {};
+  storage.readStorage(10, buf, sizeof(buf), false);
+  EXPECT_EQ(memcmp(buf, pattern, sizeof(pattern)), 0);
+  if (GetParam()) {
+    // mapped file is resized to reservedSize during init
+    EXPECT_EQ(stateFileSize(), 5000);
+  }
+}
+
+TEST_P(Sd4linuxFileStorageTests, CommitLatencyOfSmallChange) {
+  // Records average commit time of a small change for 64 KiB and 1 MiB
+  // storage (see test XML output)
+  for (unsigned int size : {64u * 1024u, 1024u * 1024u}) {
+    std::filesystem::remove(dir + "/state.bin");
+    TestLinuxFileStorage storage(dir, size);
+    storage.setMemoryMapped(GetParam());
+    storage.init();
+
+    const int commitCount = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < commitCount; i++) {
+      unsigned char value = i;
+      storage.writeStorage(size / 2 + i, &value, 1);
+      storage.commit();
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto avgUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count() /
+        commitCount;
+    RecordProperty("commitUs_" + std::to_string(size / 1024) + "KiB",
+                   std::to_string(avgUs));
+
+    unsigned char buf = 0;
+    storage.readStorage(size / 2 + commitCount - 1, &buf, 1, false);
+    EXPECT_EQ(buf, commitCount - 1);
+    EXPECT_EQ(stateFileSize(), size);
+  }
+}
+
+TEST_P(Sd4linuxFileStorageTests, UpdateComparesWithDataInMemory) {
+  TestLinuxFileStorage storage(dir, 1000);
+  storage.setMemoryMapped(GetParam());
+  storage.init();
+  storage.writeCount = 0;
+
+  std::vector<unsigned char> pattern(200, 0x5A);
+  EXPECT_EQ(storage.updateStorage(500, pattern.data(), pattern.size()), 200);
+  EXPECT_EQ(storage.writeCount, 1);
+  EXPECT_EQ(storage.updateStorage(500, pattern.data(), pattern.size()), 200);
+  EXPECT_EQ(storage.writeCount, 1);
+
+  pattern[150] = 0;
+  EXPECT_EQ(storage.updateStorage(500, pattern.data(), pattern.size()), 200);
+  EXPECT_EQ(storage.writeCount, 2);
+  unsigned char buf = 0xFF;
+  storage.readStorage(650, &buf, 1, false);
+  EXPECT_EQ(buf, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Sd4linuxFileStorageModes,
+                         Sd4linuxFileStorageTests,
+                         ::testing::Bool());
+
+}  // namespace
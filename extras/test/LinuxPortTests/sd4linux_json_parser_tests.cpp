@@ -0,0 +1,391 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <malloc.h>
+#include <simple_time.h>
+#include <supla/parser/json.h>
+#include <supla/source/source.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <limits>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+
+class JsonSd4linuxSource : public Supla::Source::Source {
+ public:
+  std::string getContent() override {
+    calls++;
+    return content;
+  }
+
+  std::string content;
+  int calls = 0;
+};
+
+class Sd4linuxJsonParserTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Supla::Parser::Json::ClearCache();
+  }
+
+  void TearDown() override {
+    Supla::Parser::Json::ClearCache();
+  }
+};
+
+// Inverter status document similar to Fronius/Afore responses
+std::string inverterDocument(int seed) {
+  std::string doc = R"({"Head": {"Status": {"Code": 0, "Reason": ""},)"
+                    R"( "Timestamp": "2024-05-01T12:00:00+02:00"}, "Body": {)"
+                    R"("Data": {"Site": {"Mode": "meter", "P_Grid": )" +
+                    std::to_string(seed) + R"(.5, "P_Load": -1200.25},)"
+                    R"( "Inverters": {"1": {"DT": 1, "P": 3500}}, "Phases": [)";
+  for (int phase = 0; phase < 3; phase++) {
+    doc += phase ? ", " : "";
+    doc += R"({"U": )" + std::to_string(230 + phase + seed % 3) +
+           R"(.1, "I": 5.25, "P": 1200, "Q": -20.5, "S": 1210,)"
+           R"( "PF": 0.98, "F": 50.01, "E_fwd": 123456, "E_rev": 789,)"
+           R"( "E_fwd_r": 100, "E_rev_r": 10, "THD": "3.5"})";
+  }
+  doc += R"(], "Meter": {"Serial": "ABC123", "Enabled": true}}}})";
+  return doc;
+}
+
+std::vector<std::string> inverterKeys() {
+  std::vector<std::string> keys = {"/Body/Data/Site/P_Grid",
+                                   "/Body/Data/Site/P_Load",
+                                   "/Body/Data/Inverters/1/P",
+                                   "/Head/Status/Code"};
+  const char *fields[] = {
+      "U", "I", "P", "Q", "S", "PF", "F", "E_fwd", "E_rev", "E_fwd_r",
+      "E_rev_r", "THD"};
+  for (int phase = 0; phase < 3; phase++) {
+    for (auto field : fields) {
+      keys.push_back("/Body/Data/Phases/" + std::to_string(phase) + "/" +
+                     field);
+    }
+  }
+  return keys;
+}
+
+}  // namespace
+
+TEST_F(Sd4linuxJsonParserTests, ReadsValuesByKeyAndPointer) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  source.content =
+      R"({"temp": 21.5, "str": "12.5", "on": true, "mode": "auto",)"
+      R"( "nested": {"level": 3}})";
+  Supla::Parser::Json parser(&source);
+
+  time.advance(100);
+  ASSERT_TRUE(parser.refreshParserSource());
+  EXPECT_DOUBLE_EQ(parser.getValue("temp"), 21.5);
+  EXPECT_DOUBLE_EQ(parser.getValue("str"), 12.5);
+  EXPECT_DOUBLE_EQ(parser.getValue("/nested/level"), 3);
+  EXPECT_EQ(std::get<bool>(parser.getStateValue("on")), true);
+  EXPECT_EQ(std::get<int>(parser.getStateValue("/nested/level")), 3);
+  EXPECT_EQ(std::get<std::string>(parser.getStateValue("mode")), "auto");
+  EXPECT_TRUE(parser.isValid());
+
+  EXPECT_DOUBLE_EQ(parser.getValue("missing"), 0);
+  EXPECT_FALSE(parser.isValid());
+}
+
+TEST_F(Sd4linuxJsonParserTests, StateOfNumberOutOfIntRangeIsClamped) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  source.content =
+      R"({"big": 1e20, "small": -1e20, "u64": 18446744073709551615,)"
+      R"( "frac": -7.9})";
+  for (bool streaming : {false, true}) {
+    Supla::Parser::Json parser(&source);
+    parser.setStreaming(streaming);
+    for (auto key : {"big", "small", "u64", "frac"}) {
+      parser.addKey(key, -1);
+    }
+
+    time.advance(200);
+    ASSERT_TRUE(parser.refreshParserSource());
+    EXPECT_DOUBLE_EQ(parser.getValue("big"), 1e20);
+    EXPECT_EQ(std::get<int>(parser.getStateValue("big")),
+              std::numeric_limits<int>::max());
+    EXPECT_EQ(std::get<int>(parser.getStateValue("small")),
+              std::numeric_limits<int>::min());
+    EXPECT_EQ(std::get<int>(parser.getStateValue("u64")),
+              std::numeric_limits<int>::max());
+    EXPECT_EQ(std::get<int>(parser.getStateValue("frac")), -7);
+  }
+}
+
+TEST_F(Sd4linuxJsonParserTests, InvalidJsonMakesParserInvalid) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  source.content = "{\"temp\": ";
+  Supla::Parser::Json parser(&source);
+
+  time.advance(100);
+  EXPECT_FALSE(parser.refreshParserSource());
+  EXPECT_FALSE(parser.isValid());
+}
+
+TEST_F(Sd4linuxJsonParserTests, DocumentIsParsedOncePerSnapshot) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  source.content = R"({"a": 1, "b": 2})";
+  std::vector<std::unique_ptr<Supla::Parser::Json>> parsers;
+  for (int i = 0; i < 30; i++) {
+    parsers.emplace_back(new Supla::Parser::Json(&source));
+  }
+
+  for (int period = 0; period < 2; period++) {
+    time.advance(5001);
+    source.content = R"({"a": 1, "b": )" + std::to_string(period) + "}";
+    for (auto &parser : parsers) {
+      ASSERT_TRUE(parser->refreshParserSource());
+      EXPECT_DOUBLE_EQ(parser->getValue("b"), period);
+    }
+  }
+
+  EXPECT_EQ(source.calls, 2);
+  auto stats = Supla::Parser::Json::GetCacheStats();
+  EXPECT_EQ(stats.parses, 2);
+  EXPECT_EQ(stats.parsesSaved, 58);
+  EXPECT_EQ(source.getSnapshotStats().readsSaved, 58);
+}
+
+TEST_F(Sd4linuxJsonParserTests, PointerEscapesAndArrayIndexes) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  source.content =
+      R"({"a/b": 1, "m~n": 2, "arr": [10, 20, {"x": 30}], "01": 4})";
+  Supla::Parser::Json parser(&source);
+  parser.addKey("/a~1b", -1);
+  parser.addKey("/arr/2/x", -1);
+
+  time.advance(100);
+  ASSERT_TRUE(parser.refreshParserSource());
+  EXPECT_DOUBLE_EQ(parser.getValue("/a~1b"), 1);
+  EXPECT_DOUBLE_EQ(parser.getValue("/m~0n"), 2);
+  EXPECT_DOUBLE_EQ(parser.getValue("/arr/1"), 20);
+  EXPECT_DOUBLE_EQ(parser.getValue("/arr/2/x"), 30);
+  EXPECT_DOUBLE_EQ(parser.getValue("/01"), 4);
+  EXPECT_TRUE(parser.isValid());
+
+  // leading zero is not a valid array index
+  EXPECT_DOUBLE_EQ(parser.getValue("/arr/01"), 0);
+  EXPECT_FALSE(parser.isValid());
+
+  time.advance(5001);
+  ASSERT_TRUE(parser.refreshParserSource());
+  EXPECT_DOUBLE_EQ(parser.getValue("/arr/3"), 0);
+  EXPECT_FALSE(parser.isValid());
+
+  time.advance(5001);
+  ASSERT_TRUE(parser.refreshParserSource());
+  // malformed escape
+  EXPECT_DOUBLE_EQ(parser.getValue("/m~2n"), 0);
+  EXPECT_FALSE(parser.isValid());
+}
+
+TEST_F(Sd4linuxJsonParserTests, RegisteredKeysFollowDocumentChanges) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  source.content = R"({"state": true, "power": 10})";
+  Supla::Parser::Json parser(&source);
+  parser.addKey("state", -1);
+  parser.addKey("power", -1);
+
+  time.advance(100);
+  ASSERT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(std::get<bool>(parser.getStateValue("state")), true);
+  EXPECT_DOUBLE_EQ(parser.getValue("power"), 10);
+
+  source.content = R"({"state": "off", "power": "12.5"})";
+  time.advance(5001);
+  ASSERT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(std::get<std::string>(parser.getStateValue("state")), "off");
+  EXPECT_DOUBLE_EQ(parser.getValue("power"), 12.5);
+
+  source.content = R"({"state": null, "power": [1]})";
+  time.advance(5001);
+  ASSERT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(std::get<int>(parser.getStateValue("state")), 0);
+  EXPECT_FALSE(parser.isValid());
+  EXPECT_DOUBLE_EQ(parser.getValue("power"), 0);
+}
+
+TEST_F(Sd4linuxJsonParserTests, BenchmarkInverterDocument) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  auto keys = inverterKeys();
+  ASSERT_GE(keys.size(), 40);
+
+  Supla::Parser::Json parser(&source);
+  for (auto &key : keys) {
+    parser.addKey(key, -1);
+  }
+
+  const int refreshCount = 2000;
+  std::vector<nlohmann::json> documents;
+  for (int i = 0; i < 10; i++) {
+    documents.push_back(nlohmann::json::parse(inverterDocument(i)));
+  }
+
+  // reference: lookup used before keys were compiled
+  double legacySum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < refreshCount; i++) {
+    const auto &doc = documents[i % documents.size()];
+    for (auto &key : keys) {
+      nlohmann::json::json_pointer ptr(key);
+      if (doc.contains(ptr)) {
+        const auto &value = doc.at(ptr);
+        legacySum += value.is_string() ? std::stod(value.get<std::string>())
+                                       : value.get<double>();
+      }
+    }
+  }
+  auto legacyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+  // compiled keys: document is parsed by parser, so parsing is excluded by
+  // measuring it separately
+  double sum = 0;
+  int64_t parseUs = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < refreshCount; i++) {
+    auto parseStart = std::chrono::steady_clock::now();
+    source.content = inverterDocument(i % documents.size());
+    time.advance(5001);
+    ASSERT_TRUE(parser.refreshParserSource());
+    auto parseEnd = std::chrono::steady_clock::now();
+    parseUs += std::chrono::duration_cast<std::chrono::microseconds>(
+                   parseEnd - parseStart)
+                   .count();
+    for (auto &key : keys) {
+      sum += parser.getValue(key);
+    }
+  }
+  auto totalUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  EXPECT_TRUE(parser.isValid());
+  EXPECT_DOUBLE_EQ(sum, legacySum);
+  RecordProperty("keys", std::to_string(keys.size()));
+  RecordProperty("legacyLookupUs", std::to_string(legacyUs));
+  RecordProperty("refreshWithExtractionUs", std::to_string(parseUs));
+  RecordProperty("compiledLookupUs", std::to_string(totalUs - parseUs));
+}
+
+TEST_F(Sd4linuxJsonParserTests, StreamingModeExtractsSameValuesAsDom) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  source.content = inverterDocument(7);
+  auto keys = inverterKeys();
+  keys.push_back("/Body/Data/Meter/Serial");
+  keys.push_back("/Body/Data/Meter/Enabled");
+  keys.push_back("/Body/Data/Meter");
+  keys.push_back("/Body/Data/Phases/3/U");
+  keys.push_back("Head");
+
+  Supla::Parser::Json dom(&source);
+  Supla::Parser::Json stream(&source);
+  stream.setStreaming(true);
+  EXPECT_TRUE(stream.isStreaming());
+  for (auto &key : keys) {
+    dom.addKey(key, -1);
+    stream.addKey(key, -1);
+  }
+
+  time.advance(100);
+  ASSERT_TRUE(dom.refreshParserSource());
+  ASSERT_TRUE(stream.refreshParserSource());
+  for (auto &key : keys) {
+    EXPECT_EQ(dom.getStateValue(key), stream.getStateValue(key)) << key;
+    EXPECT_DOUBLE_EQ(dom.getValue(key), stream.getValue(key)) << key;
+  }
+
+  // key which wasn't registered is extracted on first use
+  EXPECT_DOUBLE_EQ(stream.getValue("/Body/Data/Inverters/1/DT"), 1);
+
+  source.content = "{\"Body\": [";
+  time.advance(5001);
+  EXPECT_FALSE(stream.refreshParserSource());
+  EXPECT_FALSE(stream.isValid());
+}
+
+TEST_F(Sd4linuxJsonParserTests, BenchmarkLargeDocumentDomVersusStreaming) {
+  SimpleTime time;
+  JsonSd4linuxSource source;
+  // ~5 MB energy API dump with a few interesting values at the end
+  source.content = R"({"history": [)";
+  for (int i = 0; i < 40000; i++) {
+    source.content += i ? ", " : "";
+    source.content += R"({"ts": )" + std::to_string(1700000000 + i) +
+                      R"(, "p": )" + std::to_string(i % 5000) +
+                      R"(.5, "e": 123456.75, "src": "inverter-main",)"
+                      R"( "phases": [230.1, 231.2, 229.9]})";
+  }
+  source.content += R"(], "current": {"power": 1234.5, "energy": 98765}})";
+  ASSERT_GT(source.content.size(), 4 * 1024 * 1024);
+
+  std::vector<std::string> keys = {
+      "/current/power", "/current/energy", "/history/39999/p"};
+  int64_t timeUs[2] = {};
+  int64_t heapBytes[2] = {};
+  for (int streaming = 0; streaming < 2; streaming++) {
+    Supla::Parser::Json::ClearCache();
+    Supla::Parser::Json parser(&source);
+    parser.setStreaming(streaming);
+    for (auto &key : keys) {
+      parser.addKey(key, -1);
+    }
+
+    auto heapBefore = mallinfo2().uordblks;
+    auto start = std::chrono::steady_clock::now();
+    time.advance(5001);
+    ASSERT_TRUE(parser.refreshParserSource());
+    timeUs[streaming] = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    // memory kept after refresh (DOM is shared between parsers)
+    heapBytes[streaming] =
+        static_cast<int64_t>(mallinfo2().uordblks) - heapBefore;
+
+    EXPECT_DOUBLE_EQ(parser.getValue("/current/power"), 1234.5);
+    EXPECT_DOUBLE_EQ(parser.getValue("/current/energy"), 98765);
+    EXPECT_DOUBLE_EQ(parser.getValue("/history/39999/p"), 4999.5);
+    EXPECT_TRUE(parser.isValid());
+  }
+  Supla::Parser::Json::ClearCache();
+
+  EXPECT_LT(heapBytes[1], heapBytes[0]);
+  RecordProperty("contentBytes", std::to_string(source.content.size()));
+  RecordProperty("domUs", std::to_string(timeUs[0]));
+  RecordProperty("streamingUs", std::to_string(timeUs[1]));
+  RecordProperty("domHeapBytes", std::to_string(heapBytes[0]));
+  RecordProperty("streamingHeapBytes", std::to_string(heapBytes[1]));
+}
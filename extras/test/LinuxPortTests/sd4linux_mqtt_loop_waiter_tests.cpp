@@ -0,0 +1,207 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <mqtt_loop_waiter.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <deque>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace {
+
+int64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Client side of MQTT loop: "sync" reads all received messages and sends
+// queued ones, like mqtt_sync does. Messages are send timestamps.
+class FakeMqttClient {
+ public:
+  explicit FakeMqttClient(int fd) : fd(fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+
+  void publish(int64_t timestamp) {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(timestamp);
+  }
+
+  bool hasUnsent() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !queue.empty();
+  }
+
+  void sync() {
+    int64_t timestamp = 0;
+    while (read(fd, &timestamp, sizeof(timestamp)) == sizeof(timestamp)) {
+      inboundLatencyUs.push_back(nowUs() - timestamp);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!queue.empty()) {
+      timestamp = queue.front();
+      if (write(fd, &timestamp, sizeof(timestamp)) != sizeof(timestamp)) {
+        break;
+      }
+      queue.pop_front();
+    }
+  }
+
+  int fd = -1;
+  std::mutex mutex;
+  std::deque<int64_t> queue;
+  std::vector<int64_t> inboundLatencyUs;
+};
+
+struct LoopResult {
+  int64_t inboundMaxUs = 0;
+  int64_t inboundAvgUs = 0;
+  int64_t outboundMaxUs = 0;
+  int64_t outboundAvgUs = 0;
+  int idleWakeups = 0;
+};
+
+// Runs client loop in thread with socketpair as broker stand-in
+LoopResult runLoop(bool useWaiter) {
+  const int messageCount = 10;
+  int fds[2] = {};
+  EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  int brokerFd = fds[0];
+  FakeMqttClient client(fds[1]);
+  Supla::MqttLoopWaiter waiter;
+  std::atomic<bool> stop(false);
+  std::atomic<int> iterations(0);
+
+  std::thread loop([&]() {
+    while (!stop) {
+      client.sync();
+      iterations++;
+      if (useWaiter) {
+        waiter.wait(client.fd, client.hasUnsent(), 1000);
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+    }
+  });
+
+  // broker -> client
+  for (int i = 0; i < messageCount; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(17 + i * 3));
+    int64_t timestamp = nowUs();
+    EXPECT_EQ(write(brokerFd, &timestamp, sizeof(timestamp)),
+              sizeof(timestamp));
+  }
+
+  // client -> broker
+  std::vector<int64_t> outboundLatencyUs;
+  for (int i = 0; i < messageCount; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(17 + i * 3));
+    client.publish(nowUs());
+    waiter.wakeup();
+    int64_t timestamp = 0;
+    EXPECT_EQ(read(brokerFd, &timestamp, sizeof(timestamp)),
+              sizeof(timestamp));
+    outboundLatencyUs.push_back(nowUs() - timestamp);
+  }
+
+  // idle
+  int before = iterations;
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  int idleWakeups = iterations - before;
+
+  stop = true;
+  waiter.wakeup();
+  loop.join();
+  close(fds[0]);
+  close(fds[1]);
+
+  EXPECT_EQ(client.inboundLatencyUs.size(), messageCount);
+  LoopResult result;
+  for (auto latency : client.inboundLatencyUs) {
+    result.inboundMaxUs = std::max(result.inboundMaxUs, latency);
+    result.inboundAvgUs += latency / messageCount;
+  }
+  for (auto latency : outboundLatencyUs) {
+    result.outboundMaxUs = std::max(result.outboundMaxUs, latency);
+    result.outboundAvgUs += latency / messageCount;
+  }
+  result.idleWakeups = idleWakeups;
+  return result;
+}
+
+}  // namespace
+
+TEST(Sd4linuxMqttLoopWaiterTests, WaitReturnsOnSocketWakeupAndTimeout) {
+  int fds[2] = {};
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  Supla::MqttLoopWaiter waiter;
+  ASSERT_GE(waiter.getWakeupFd(), 0);
+
+  EXPECT_EQ(waiter.wait(fds[1], false, 10),
+            Supla::MqttLoopWaiter::Result::Timeout);
+
+  waiter.wakeup();
+  waiter.wakeup();
+  EXPECT_EQ(waiter.wait(fds[1], false, 1000),
+            Supla::MqttLoopWaiter::Result::Wakeup);
+  // pending wakeups were cleared
+  EXPECT_EQ(waiter.wait(fds[1], false, 10),
+            Supla::MqttLoopWaiter::Result::Timeout);
+
+  char c = 'x';
+  ASSERT_EQ(write(fds[0], &c, 1), 1);
+  EXPECT_EQ(waiter.wait(fds[1], false, 1000),
+            Supla::MqttLoopWaiter::Result::Socket);
+  ASSERT_EQ(read(fds[1], &c, 1), 1);
+
+  // socket is writable
+  EXPECT_EQ(waiter.wait(fds[1], true, 1000),
+            Supla::MqttLoopWaiter::Result::Socket);
+  // negative socket is ignored
+  EXPECT_EQ(waiter.wait(-1, true, 10), Supla::MqttLoopWaiter::Result::Timeout);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(Sd4linuxMqttLoopWaiterTests, BenchmarkLatencyVersusPolling) {
+  auto polling = runLoop(false);
+  auto waiting = runLoop(true);
+
+  // Results depend on scheduler, so they are only recorded. Wakeup behaviour
+  // is checked in WaitReturnsOnSocketWakeupAndTimeout.
+  RecordProperty("pollingInboundAvgUs", std::to_string(polling.inboundAvgUs));
+  RecordProperty("pollingInboundMaxUs", std::to_string(polling.inboundMaxUs));
+  RecordProperty("pollingOutboundAvgUs",
+                 std::to_string(polling.outboundAvgUs));
+  RecordProperty("pollingIdleWakeups", std::to_string(polling.idleWakeups));
+  RecordProperty("waiterInboundAvgUs", std::to_string(waiting.inboundAvgUs));
+  RecordProperty("waiterInboundMaxUs", std::to_string(waiting.inboundMaxUs));
+  RecordProperty("waiterOutboundAvgUs", std::to_string(waiting.outboundAvgUs));
+  RecordProperty("waiterIdleWakeups", std::to_string(waiting.idleWakeups));
+}
@@ -0,0 +1,166 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <mqtt_topic_store.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace {
+
+bool isReadable(int fd) {
+  struct pollfd pfd = {fd, POLLIN, 0};
+  return poll(&pfd, 1, 0) == 1;
+}
+
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+TEST(Sd4linuxMqttTopicStoreTests, UpdateChangesValueAndSequence) {
+  Supla::MqttTopicStore store;
+  store.subscribe("home/temp");
+  store.subscribe("home/hum");
+  store.unsubscribe("home/hum");
+
+  auto entry = store.getEntry("home/temp");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(*entry->getValue(), "");
+  EXPECT_EQ(entry->getSequence(), 0);
+  EXPECT_EQ(store.getEntry("home/temp"), entry);
+
+  auto subscribed = store.getSubscribedTopics();
+  EXPECT_EQ(subscribed.size(), 1);
+  EXPECT_EQ(subscribed.count("home/temp"), 1);
+
+  ASSERT_GE(store.getEventFd(), 0);
+  EXPECT_FALSE(isReadable(store.getEventFd()));
+
+  auto oldValue = entry->getValue();
+  store.update("home/temp", "21.5");
+  EXPECT_EQ(*entry->getValue(), "21.5");
+  EXPECT_EQ(entry->getSequence(), 1);
+  EXPECT_EQ(store.getChangeCount(), 1);
+  // reader keeps its copy after update
+  EXPECT_EQ(*oldValue, "");
+
+  EXPECT_TRUE(isReadable(store.getEventFd()));
+  store.clearEvent();
+  EXPECT_FALSE(isReadable(store.getEventFd()));
+
+  // message for topic which wasn't requested is stored as well
+  store.update("other", "1");
+  EXPECT_EQ(*store.getEntry("other")->getValue(), "1");
+  EXPECT_EQ(store.getChangeCount(), 2);
+}
+
+TEST(Sd4linuxMqttTopicStoreTests, StressConcurrentUpdatesAndReads) {
+  Supla::MqttTopicStore store;
+  const int topicCount = 8;
+  const int messageCount = 100000;
+  std::vector<const Supla::MqttTopicStore::Entry *> entries;
+  for (int i = 0; i < topicCount; i++) {
+    entries.push_back(store.getEntry("topic/" + std::to_string(i)));
+  }
+
+  // message: "<topic>:<number>:<send time ns>:<padding>", padding length
+  // depends on number, so torn reads would be detected
+  auto start = std::chrono::steady_clock::now();
+  std::thread writer([&store]() {
+    for (int i = 0; i < messageCount; i++) {
+      int topic = i % topicCount;
+      std::string msg = std::to_string(topic) + ":" + std::to_string(i) +
+                        ":" + std::to_string(nowNs()) + ":" +
+                        std::string(i % 64, 'x');
+      store.update("topic/" + std::to_string(topic), msg);
+      if (i % 1000 == 0) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<int> lastNumber(topicCount, -1);
+  uint32_t lastGeneration = 0;
+  int changesSeen = 0;
+  int64_t maxLatencyNs = 0;
+  int64_t totalLatencyNs = 0;
+  int64_t valuesSeen = 0;
+  while (lastNumber[(messageCount - 1) % topicCount] !=
+         messageCount - 1) {
+    uint32_t generation = 0;
+    for (auto entry : entries) {
+      generation += entry->getSequence();
+    }
+    if (generation == lastGeneration) {
+      std::this_thread::yield();
+      continue;
+    }
+    lastGeneration = generation;
+    changesSeen++;
+
+    for (int topic = 0; topic < topicCount; topic++) {
+      auto value = entries[topic]->getValue();
+      if (value->empty()) {
+        continue;
+      }
+      int parsedTopic = 0;
+      int number = 0;
+      long long sentNs = 0;  // NOLINT(runtime/int)
+      int padStart = 0;
+      ASSERT_EQ(sscanf(value->c_str(), "%d:%d:%lld:%n", &parsedTopic, &number,
+                       &sentNs, &padStart),
+                3);
+      ASSERT_EQ(parsedTopic, topic);
+      ASSERT_EQ(value->size() - padStart, number % 64);
+      ASSERT_GE(number, lastNumber[topic]);
+      if (number != lastNumber[topic]) {
+        int64_t latency = nowNs() - sentNs;
+        maxLatencyNs = std::max(maxLatencyNs, latency);
+        totalLatencyNs += latency;
+        valuesSeen++;
+        lastNumber[topic] = number;
+      }
+    }
+  }
+  writer.join();
+  auto durationUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  for (int topic = 0; topic < topicCount; topic++) {
+    EXPECT_EQ(lastNumber[topic], messageCount - topicCount + topic);
+  }
+  EXPECT_EQ(store.getChangeCount(), messageCount);
+
+  RecordProperty("messagesPerSecond",
+                 std::to_string(messageCount * 1000000LL /
+                                std::max<int64_t>(durationUs, 1)));
+  RecordProperty("readerWakeups", std::to_string(changesSeen));
+  RecordProperty("maxLatencyUs", std::to_string(maxLatencyNs / 1000));
+  RecordProperty("avgLatencyUs",
+                 std::to_string(totalLatencyNs / valuesSeen / 1000));
+}
@@ -0,0 +1,262 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <simple_time.h>
+#include <supla/parser/simple.h>
+#include <supla/source/source.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <variant>
+
+namespace {
+std::atomic<bool> countAllocations(false);
+std::atomic<uint32_t> allocationCount(0);
+}  // namespace
+
+// Counts allocations of whole test binary while countAllocations is set
+void *operator new(std::size_t size) {
+  if (countAllocations) {
+    allocationCount++;
+  }
+  void *ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+class StaticSd4linuxSource : public Supla::Source::Source {
+ public:
+  std::string getContent() override {
+    return content;
+  }
+
+  std::string content;
+};
+
+class SimpleParserForTest : public Supla::Parser::Simple {
+ public:
+  explicit SimpleParserForTest(Supla::Source::Source *source)
+      : Simple(source) {
+  }
+  using Simple::parseContent;
+};
+
+// Previous implementation of Simple::refreshSource()
+void legacyParse(
+    const std::string &content,
+    std::map<int, std::variant<int, bool, std::string, double>> *values) {
+  std::stringstream ss(content);
+  values->clear();
+  std::string strVal;
+  for (int i = 0; std::getline(ss, strVal, '\n'); i++) {
+    try {
+      if (strVal == "true" || strVal == "false") {
+        (*values)[i] = strVal == "true";
+      } else {
+        double dblVal = std::stod(strVal);
+        if (dblVal == static_cast<int>(dblVal)) {
+          (*values)[i] = static_cast<int>(dblVal);
+        } else {
+          (*values)[i] = dblVal;
+        }
+      }
+    } catch (...) {
+      (*values)[i] = strVal;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(Sd4linuxSimpleParserTests, LinesAreConvertedToValues) {
+  SimpleTime time;
+  StaticSd4linuxSource source;
+  source.content =
+      "12\n"
+      "-3.5\n"
+      "true\n"
+      "false\n"
+      "text\n"
+      "\n"
+      "  +7\n"
+      "0x1A\n"
+      "21.5 C\n"
+      "1e10\n"
+      "--5\n"
+      "last";
+  Supla::Parser::Simple parser(&source);
+  for (int i = 0; i < 13; i++) {
+    parser.addKey(std::to_string(i), i);
+  }
+
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_TRUE(parser.isValid());
+  EXPECT_EQ(parser.getValue("0"), 12);
+  EXPECT_EQ(std::get<int>(parser.getStateValue("0")), 12);
+  EXPECT_DOUBLE_EQ(parser.getValue("1"), -3.5);
+  EXPECT_EQ(std::get<int>(parser.getStateValue("1")), -3);
+  EXPECT_EQ(std::get<bool>(parser.getStateValue("2")), true);
+  EXPECT_EQ(std::get<bool>(parser.getStateValue("3")), false);
+  EXPECT_EQ(std::get<std::string>(parser.getStateValue("4")), "text");
+  EXPECT_EQ(std::get<std::string>(parser.getStateValue("5")), "");
+  EXPECT_EQ(parser.getValue("6"), 7);
+  EXPECT_EQ(parser.getValue("7"), 26);
+  // number followed by other text, like std::stod
+  EXPECT_DOUBLE_EQ(parser.getValue("8"), 21.5);
+  EXPECT_DOUBLE_EQ(parser.getValue("9"), 1e10);
+  EXPECT_EQ(std::get<std::string>(parser.getStateValue("10")), "--5");
+  EXPECT_EQ(std::get<std::string>(parser.getStateValue("11")), "last");
+  EXPECT_TRUE(parser.isValid());
+
+  // index out of range
+  parser.getValue("12");
+  EXPECT_FALSE(parser.isValid());
+
+  // text isn't a number
+  EXPECT_TRUE(parser.refreshParserSource());
+  parser.getValue("4");
+  EXPECT_FALSE(parser.isValid());
+}
+
+TEST(Sd4linuxSimpleParserTests, MatchesLegacyParser) {
+  std::string content = "1\n2.25\nfalse\nabc\n-0\n 3\n\n4.0\n1e-3\nnan\n9x";
+  SimpleParserForTest parser(nullptr);
+  parser.parseContent(content);
+  std::map<int, std::variant<int, bool, std::string, double>> legacy;
+  legacyParse(content, &legacy);
+
+  for (auto &entry : legacy) {
+    std::string key = std::to_string(entry.first);
+    parser.addKey(key, entry.first);
+    if (std::holds_alternative<double>(entry.second) &&
+        std::isnan(std::get<double>(entry.second))) {
+      EXPECT_TRUE(std::isnan(parser.getValue(key)));
+      continue;
+    }
+    std::variant<int, bool, std::string> expected;
+    if (std::holds_alternative<double>(entry.second)) {
+      EXPECT_DOUBLE_EQ(parser.getValue(key), std::get<double>(entry.second))
+          << key;
+      expected = static_cast<int>(std::get<double>(entry.second));
+    } else if (std::holds_alternative<int>(entry.second)) {
+      expected = std::get<int>(entry.second);
+    } else if (std::holds_alternative<bool>(entry.second)) {
+      expected = std::get<bool>(entry.second);
+    } else {
+      expected = std::get<std::string>(entry.second);
+    }
+    EXPECT_EQ(parser.getStateValue(key), expected) << key;
+  }
+}
+
+TEST(Sd4linuxSimpleParserTests, SameSnapshotIsNotParsedAgain) {
+  SimpleTime time;
+  StaticSd4linuxSource source;
+  source.content = "1\n2\n";
+  Supla::Parser::Simple parser(&source);
+  parser.addKey("a", 1);
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(parser.getValue("a"), 2);
+
+  time.advance(10000);
+  source.content = "3\n4\n";
+  EXPECT_TRUE(parser.refreshParserSource());
+  EXPECT_EQ(parser.getValue("a"), 4);
+}
+
+TEST(Sd4linuxSimpleParserTests, BenchmarkAllocationsPerRefresh) {
+  const int lineCount = 100;
+  const int refreshCount = 2000;
+  std::string content;
+  for (int i = 0; i < lineCount; i++) {
+    switch (i % 4) {
+      case 0:
+        content += std::to_string(i) + "\n";
+        break;
+      case 1:
+        content += std::to_string(i) + ".25\n";
+        break;
+      case 2:
+        content += (i % 8 == 2) ? "true\n" : "false\n";
+        break;
+      default:
+        content += "state_" + std::to_string(i) + "\n";
+        break;
+    }
+  }
+
+  std::map<int, std::variant<int, bool, std::string, double>> legacyValues;
+  allocationCount = 0;
+  countAllocations = true;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < refreshCount; i++) {
+    legacyParse(content, &legacyValues);
+  }
+  auto legacyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  countAllocations = false;
+  uint32_t legacyAllocations = allocationCount / refreshCount;
+
+  SimpleParserForTest parser(nullptr);
+  // first parse grows values vector
+  parser.parseContent(content);
+  allocationCount = 0;
+  countAllocations = true;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < refreshCount; i++) {
+    parser.parseContent(content);
+  }
+  auto simpleUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  countAllocations = false;
+  uint32_t simpleAllocations = allocationCount;
+
+  EXPECT_EQ(simpleAllocations, 0u);
+  EXPECT_GT(legacyAllocations, 0u);
+
+  // Timings depend on machine load, so they are only recorded
+  RecordProperty("legacyAllocationsPerRefresh",
+                 std::to_string(legacyAllocations / refreshCount));
+  RecordProperty("legacyUsPerRefresh",
+                 std::to_string(legacyUs / refreshCount));
+  RecordProperty("simpleAllocationsPerRefresh",
+                 std::to_string(simpleAllocations / refreshCount));
+  RecordProperty("simpleNsPerRefresh",
+                 std::to_string(simpleUs * 1000 / refreshCount));
+}
@@ -0,0 +1,165 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <simple_time.h>
+#include <supla/parser/simple.h>
+#include <supla/source/file.h>
+#include <supla/source/source.h>
+#include <unistd.h>
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+class CountingSd4linuxSource : public Supla::Source::Source {
+ public:
+  std::string getContent() override {
+    calls++;
+    return content;
+  }
+
+  std::string content = "1\n2\n";
+  int calls = 0;
+};
+
+class Sd4linuxSourceSnapshotTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path = std::filesystem::temp_directory_path() /
+           ("sd4linux_snapshot_" + std::to_string(getpid()));
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(path);
+  }
+
+  void writeFile(const std::string &content) {
+    std::ofstream file(path, std::ios::trunc);
+    file << content;
+  }
+
+  std::filesystem::path path;
+};
+
+}  // namespace
+
+TEST_F(Sd4linuxSourceSnapshotTests, SnapshotIsSharedWithinMaxAge) {
+  SimpleTime time;
+  CountingSd4linuxSource source;
+
+  auto first = source.getSnapshot();
+  auto second = source.getSnapshot();
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first->content, "1\n2\n");
+  EXPECT_EQ(first->generation, 1);
+  EXPECT_EQ(source.calls, 1);
+
+  time.advance(100);
+  source.content = "3\n";
+  auto third = source.getSnapshot();
+  EXPECT_NE(first, third);
+  EXPECT_EQ(third->content, "3\n");
+  EXPECT_EQ(third->generation, 2);
+  // previous snapshot is immutable
+  EXPECT_EQ(first->content, "1\n2\n");
+
+  auto stats = source.getSnapshotStats();
+  EXPECT_EQ(stats.reads, 2);
+  EXPECT_EQ(stats.readsSaved, 1);
+}
+
+TEST_F(Sd4linuxSourceSnapshotTests, ParsersSharingSourceReadItOnce) {
+  SimpleTime time;
+  CountingSd4linuxSource source;
+  std::vector<std::unique_ptr<Supla::Parser::Simple>> parsers;
+  for (int i = 0; i < 30; i++) {
+    parsers.emplace_back(new Supla::Parser::Simple(&source));
+    parsers.back()->addKey("v", 1);
+  }
+
+  for (int period = 0; period < 3; period++) {
+    time.advance(5001);
+    for (auto &parser : parsers) {
+      EXPECT_TRUE(parser->refreshParserSource());
+      EXPECT_DOUBLE_EQ(parser->getValue("v"), 2);
+    }
+  }
+
+  EXPECT_EQ(source.calls, 3);
+  auto stats = source.getSnapshotStats();
+  EXPECT_EQ(stats.reads, 3);
+  EXPECT_EQ(stats.readsSaved, 87);
+}
+
+TEST_F(Sd4linuxSourceSnapshotTests, UnchangedFileContentKeepsSnapshot) {
+  SimpleTime time;
+  writeFile("10\n");
+  Supla::Source::File file(path.c_str(), 0);
+
+  auto first = file.getSnapshot();
+  EXPECT_EQ(first->content, "10\n");
+
+  // file is read again after snapshot max age, but the same content keeps
+  // previous snapshot
+  time.advance(10000);
+  EXPECT_EQ(file.getSnapshot(), first);
+
+  // same size rewrite is detected even when mtime didn't change
+  auto fileTime = std::filesystem::last_write_time(path);
+  writeFile("20\n");
+  std::filesystem::last_write_time(path, fileTime);
+  time.advance(10000);
+  auto second = file.getSnapshot();
+  EXPECT_NE(second, first);
+  EXPECT_EQ(second->content, "20\n");
+  EXPECT_EQ(second->generation, 2);
+
+  auto stats = file.getSnapshotStats();
+  EXPECT_EQ(stats.reads, 3);
+  EXPECT_EQ(stats.readsSaved, 0);
+  EXPECT_EQ(stats.readsUnchanged, 1);
+}
+
+TEST_F(Sd4linuxSourceSnapshotTests, ProcFileIsReadEachRefresh) {
+  // files in /proc report size 0 and don't update mtime
+  if (!std::filesystem::exists("/proc/uptime")) {
+    GTEST_SKIP() << "/proc/uptime is not available";
+  }
+  SimpleTime time;
+  Supla::Source::File file("/proc/uptime", 0);
+  Supla::Parser::Simple parser(&file);
+  parser.addKey("uptime", 0);
+  parser.setRefreshTime(1000);
+
+  time.advance(10);
+  ASSERT_TRUE(parser.refreshParserSource());
+  double first = parser.getValue("uptime");
+  EXPECT_GT(first, 0);
+
+  // /proc/uptime has 10 ms resolution
+  usleep(50000);
+  time.advance(1001);
+  ASSERT_TRUE(parser.refreshParserSource());
+  EXPECT_GT(parser.getValue("uptime"), first);
+  EXPECT_EQ(file.getSnapshotStats().reads, 2);
+}
@@ -180,3 +180,66 @@ TEST(LocalActionTests, FourItemsTestsWithCalls) {
   delete b3;
   delete b4;
 }
+
+TEST(LocalActionTests, InterleavedEventsKeepOrderAndDeleteHandlers) {
+  ::testing::InSequence seq;
+  auto b1 = new Supla::LocalAction;
+  auto b2 = new Supla::LocalAction;
+  ActionHandlerMock mock1;
+  ActionHandlerMock mock2;
+
+  int event1 = 11;
+  int event2 = 12;
+
+  b1->addAction(1, mock1, event1);
+  b2->addAction(1, mock2, event1);
+  b1->addAction(2, mock2, event2);
+  b1->addAction(3, mock2, event1);
+  b1->addAction(4, mock1, event2);
+  b1->addAction(5, mock1, event1);
+
+  // handlers are called in the order they were added
+  EXPECT_CALL(mock1, handleAction(event1, 1));
+  EXPECT_CALL(mock2, handleAction(event1, 3));
+  EXPECT_CALL(mock1, handleAction(event1, 5));
+  b1->runAction(event1);
+
+  EXPECT_CALL(mock2, handleAction(event2, 2));
+  EXPECT_CALL(mock1, handleAction(event2, 4));
+  b1->runAction(event2);
+
+  EXPECT_EQ(b1->getHandlerForFirstClient(event1)->action, 1);
+  EXPECT_EQ(b1->getHandlerForClient(&mock2, event1)->action, 3);
+  EXPECT_EQ(b1->getHandlerForClient(&mock2, event2)->action, 2);
+  EXPECT_EQ(b2->getHandlerForClient(&mock1, event1), nullptr);
+
+  b1->disableOtherClients(mock2, event1);
+  EXPECT_CALL(mock2, handleAction(event1, 3));
+  b1->runAction(event1);
+  b1->enableOtherClients(mock2, event1);
+
+  b1->disableAction(-1, &mock1, -1);
+  EXPECT_CALL(mock2, handleAction(event1, 3));
+  b1->runAction(event1);
+  b1->enableAction(-1, &mock1, -1);
+
+  // mock1 handlers are removed from both triggers
+  Supla::LocalAction::DeleteActionsHandledBy(&mock1);
+  EXPECT_EQ(b1->getHandlerForClient(&mock1, event1), nullptr);
+  EXPECT_EQ(b1->getHandlerForClient(&mock1, event2), nullptr);
+  EXPECT_CALL(mock2, handleAction(event1, 3));
+  b1->runAction(event1);
+  EXPECT_CALL(mock2, handleAction(event2, 2));
+  b1->runAction(event2);
+
+  // nullified handlers stay on the list, but are not called
+  Supla::LocalAction::NullifyActionsHandledBy(&mock2);
+  b1->runAction(event1);
+  b2->runAction(event1);
+  EXPECT_TRUE(b1->isEventAlreadyUsed(event1, false));
+
+  delete b1;
+  EXPECT_TRUE(b2->isEventAlreadyUsed(event1, false));
+  delete b2;
+  EXPECT_EQ(Supla::LocalAction::getClientListPtr(), nullptr);
+}
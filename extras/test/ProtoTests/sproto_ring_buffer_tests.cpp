@@ -0,0 +1,169 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <supla-common/proto.h>
+
+#include <random>
+#include <vector>
+
+class SprotoRingBufferTests : public ::testing::Test {
+ protected:
+  void *spd = nullptr;
+
+  void SetUp() override {
+    spd = sproto_init();
+    ASSERT_NE(spd, nullptr);
+  }
+
+  void TearDown() override {
+    sproto_free(spd);
+  }
+
+  // Returns serialized packet (with end tag) as it is received from network
+  std::vector<char> makePacket(uint32_t callId, uint32_t dataSize, char fill) {
+    TSuplaDataPacket sdp = {};
+    sproto_sdp_init(spd, &sdp);
+    std::vector<char> data(dataSize, fill);
+    EXPECT_EQ(sproto_set_data(&sdp, data.data(), dataSize, callId),
+              SUPLA_RESULT_TRUE);
+
+    size_t headerSize = sizeof(TSuplaDataPacket) - SUPLA_MAX_DATA_SIZE;
+    auto ptr = reinterpret_cast<char *>(&sdp);
+    std::vector<char> result(ptr, ptr + headerSize + dataSize);
+    result.insert(result.end(), sproto_tag, sproto_tag + SUPLA_TAG_SIZE);
+    return result;
+  }
+};
+
+TEST_F(SprotoRingBufferTests, PacketSplitIntoSingleBytes) {
+  auto packet = makePacket(123, 40, 'x');
+  TSuplaDataPacket sdp = {};
+
+  for (size_t i = 0; i < packet.size(); i++) {
+    EXPECT_EQ(sproto_pop_in_sdp(spd, &sdp), SUPLA_RESULT_FALSE);
+    ASSERT_EQ(sproto_in_buffer_append(spd, &packet[i], 1), SUPLA_RESULT_TRUE);
+  }
+
+  ASSERT_EQ(sproto_pop_in_sdp(spd, &sdp), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(sdp.call_id, 123);
+  EXPECT_EQ(sdp.data_size, 40);
+  EXPECT_EQ(sdp.data[0], 'x');
+  EXPECT_EQ(sdp.data[39], 'x');
+  EXPECT_EQ(sproto_in_dataexists(spd), SUPLA_RESULT_FALSE);
+  EXPECT_EQ(sproto_pop_in_sdp(spd, &sdp), SUPLA_RESULT_FALSE);
+}
+
+TEST_F(SprotoRingBufferTests, AppendAboveCapacityFails) {
+  std::vector<char> data(SPROTO_IN_RING_BUFFER_SIZE, 0);
+  EXPECT_EQ(sproto_in_buffer_append(spd, data.data(), data.size() + 1),
+            SUPLA_RESULT_BUFFER_OVERFLOW);
+  EXPECT_EQ(sproto_in_buffer_append(spd, data.data(), data.size() - 1),
+            SUPLA_RESULT_TRUE);
+  EXPECT_EQ(sproto_in_buffer_append(spd, data.data(), 2),
+            SUPLA_RESULT_BUFFER_OVERFLOW);
+}
+
+TEST_F(SprotoRingBufferTests, GarbageIsDroppedAndNextPacketIsReceived) {
+  char garbage[] = "NOT A SUPLA PACKET";
+  TSuplaDataPacket sdp = {};
+
+  ASSERT_EQ(sproto_in_buffer_append(spd, garbage, sizeof(garbage)),
+            SUPLA_RESULT_TRUE);
+  EXPECT_EQ(sproto_pop_in_sdp(spd, &sdp), SUPLA_RESULT_DATA_ERROR);
+  EXPECT_EQ(sproto_in_dataexists(spd), SUPLA_RESULT_FALSE);
+
+  auto packet = makePacket(5, 10, 'a');
+  // broken end tag
+  packet.back() = 'X';
+  ASSERT_EQ(sproto_in_buffer_append(spd, packet.data(), packet.size()),
+            SUPLA_RESULT_TRUE);
+  EXPECT_EQ(sproto_pop_in_sdp(spd, &sdp), SUPLA_RESULT_DATA_ERROR);
+
+  packet = makePacket(6, 10, 'b');
+  ASSERT_EQ(sproto_in_buffer_append(spd, packet.data(), packet.size()),
+            SUPLA_RESULT_TRUE);
+  EXPECT_EQ(sproto_pop_in_sdp(spd, &sdp), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(sdp.call_id, 6);
+}
+
+TEST_F(SprotoRingBufferTests, UnsupportedVersionIsReported) {
+  auto packet = makePacket(5, 10, 'a');
+  packet[SUPLA_TAG_SIZE] = SUPLA_PROTO_VERSION + 1;
+  TSuplaDataPacket sdp = {};
+
+  ASSERT_EQ(sproto_in_buffer_append(spd, packet.data(), packet.size()),
+            SUPLA_RESULT_TRUE);
+  EXPECT_EQ(sproto_pop_in_sdp(spd, &sdp), SUPLA_RESULT_VERSION_ERROR);
+  EXPECT_EQ(sdp.version, SUPLA_PROTO_VERSION + 1);
+}
+
+TEST_F(SprotoRingBufferTests, RandomlySplitAndConcatenatedStream) {
+  // Stream of packets with random sizes is fed in random chunks, so packets
+  // are split, concatenated and wrapped around the end of ring buffer
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<uint32_t> dataSizeDist(0, SUPLA_MAX_DATA_SIZE);
+  std::uniform_int_distribution<size_t> chunkSizeDist(1, 700);
+
+  const uint32_t packetCount = 3000;
+  std::vector<char> stream;
+  std::vector<uint32_t> dataSizes;
+  for (uint32_t i = 0; i < packetCount; i++) {
+    dataSizes.push_back(dataSizeDist(rng));
+    auto packet = makePacket(i, dataSizes.back(), static_cast<char>(i));
+    stream.insert(stream.end(), packet.begin(), packet.end());
+  }
+
+  size_t streamPos = 0;
+  size_t buffered = 0;
+  uint32_t received = 0;
+  TSuplaDataPacket sdp = {};
+
+  while (received < packetCount) {
+    size_t chunk = chunkSizeDist(rng);
+    if (chunk > stream.size() - streamPos) {
+      chunk = stream.size() - streamPos;
+    }
+    if (chunk > SPROTO_IN_RING_BUFFER_SIZE - buffered) {
+      chunk = SPROTO_IN_RING_BUFFER_SIZE - buffered;
+    }
+    if (chunk > 0) {
+      ASSERT_EQ(sproto_in_buffer_append(spd, &stream[streamPos], chunk),
+                SUPLA_RESULT_TRUE);
+      streamPos += chunk;
+      buffered += chunk;
+    }
+
+    char result;
+    while ((result = sproto_pop_in_sdp(spd, &sdp)) == SUPLA_RESULT_TRUE) {
+      ASSERT_LT(received, packetCount);
+      ASSERT_EQ(sdp.call_id, received);
+      ASSERT_EQ(sdp.data_size, dataSizes[received]);
+      for (uint32_t i = 0; i < sdp.data_size; i++) {
+        ASSERT_EQ(sdp.data[i], static_cast<char>(received));
+      }
+      buffered -= sizeof(TSuplaDataPacket) - SUPLA_MAX_DATA_SIZE +
+                  sdp.data_size + SUPLA_TAG_SIZE;
+      received++;
+    }
+    ASSERT_EQ(result, SUPLA_RESULT_FALSE);
+  }
+
+  EXPECT_EQ(streamPos, stream.size());
+  EXPECT_EQ(sproto_in_dataexists(spd), SUPLA_RESULT_FALSE);
+}
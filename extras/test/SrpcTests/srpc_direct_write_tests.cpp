@@ -0,0 +1,56 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <supla-common/proto.h>
+#include <supla-common/srpc.h>
+
+#include "srpc_test_pipe.h"
+
+// SRPC is built here with SRPC_WITHOUT_OUT_QUEUE, so packets are written
+// directly from the async call, using out_packet_buffer to append the end tag.
+TEST(SrpcDirectWriteTests, PacketWithEndTagIsWrittenInOneCall) {
+  SrpcTestPipe pipe;
+  auto device = pipe.device.srpc;
+  auto server = pipe.server.srpc;
+
+  const int packetSize = sizeof(TSuplaDataPacket) - SUPLA_MAX_DATA_SIZE +
+                         sizeof(TDCS_SuplaPingServer) + SUPLA_TAG_SIZE;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NE(srpc_dcs_async_ping_server(device), 0);
+    ASSERT_EQ(pipe.device.writeSizes.size(), i + 1);
+    EXPECT_EQ(pipe.device.writeSizes[i], packetSize);
+  }
+  EXPECT_EQ(srpc_out_queue_item_count(device), 0);
+
+  // out queue stats are zeroed when out queue is disabled
+  TsrpcQueueStats outStats = {};
+  outStats.push_count = 1;
+  srpc_get_queue_stats(device, nullptr, &outStats);
+  EXPECT_EQ(outStats.push_count, 0);
+  EXPECT_EQ(outStats.malloc_count, 0);
+
+  // written packets are valid for the receiving side
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(srpc_iterate(server), SUPLA_RESULT_TRUE);
+  }
+  ASSERT_EQ(pipe.server.receivedCalls.size(), 3);
+  for (auto callId : pipe.server.receivedCalls) {
+    EXPECT_EQ(callId, SUPLA_DCS_CALL_PING_SERVER);
+  }
+}
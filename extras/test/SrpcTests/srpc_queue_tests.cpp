@@ -0,0 +1,204 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <supla-common/proto.h>
+#include <supla-common/srpc.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+
+#include "srpc_test_pipe.h"
+
+// SRPC is built here in its default (server/client) configuration, so in
+// and out queues are enabled. SRPC_QUEUE_SIZE is 10 in this configuration.
+// The same tests are built with SRPC_QUEUE_WITHOUT_POOL, where each queued
+// packet is allocated separately.
+const int QueueSize = 10;
+
+#ifdef SRPC_QUEUE_WITHOUT_POOL
+const bool PoolUsed = false;
+#else
+const bool PoolUsed = true;
+#endif
+
+// expected number of mallocs (or frees) for given number of queued packets
+unsigned expectedAllocs(unsigned packets) {
+  return PoolUsed ? (packets > 0 ? 1 : 0) : packets;
+}
+
+TEST(SrpcQueueTests, OutQueuePushPopAndStats) {
+  SrpcTestPipe pipe;
+  auto device = pipe.device.srpc;
+
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NE(srpc_dcs_async_ping_server(device), 0);
+  }
+  EXPECT_EQ(srpc_out_queue_item_count(device), 3);
+  // nothing is written until srpc_iterate is called
+  EXPECT_TRUE(pipe.device.writeSizes.empty());
+
+  TsrpcQueueStats inStats = {};
+  TsrpcQueueStats outStats = {};
+  srpc_get_queue_stats(device, &inStats, &outStats);
+  EXPECT_EQ(outStats.push_count, 3);
+  EXPECT_EQ(outStats.pop_count, 0);
+  EXPECT_EQ(outStats.max_item_count, 3);
+  // whole pool is allocated on first push
+  EXPECT_EQ(outStats.malloc_count, expectedAllocs(3));
+  EXPECT_EQ(outStats.free_count, 0);
+  EXPECT_EQ(inStats.push_count, 0);
+  EXPECT_EQ(inStats.malloc_count, 0);
+
+  // each iteration sends one queued packet
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(srpc_iterate(device), SUPLA_RESULT_TRUE);
+  }
+  EXPECT_EQ(srpc_out_queue_item_count(device), 0);
+  EXPECT_EQ(pipe.device.writeSizes.size(), 3);
+
+  srpc_get_queue_stats(device, nullptr, &outStats);
+  EXPECT_EQ(outStats.push_count, 3);
+  EXPECT_EQ(outStats.pop_count, 3);
+  EXPECT_EQ(outStats.malloc_count, expectedAllocs(3));
+  // pool is released only in srpc_free
+  EXPECT_EQ(outStats.free_count, PoolUsed ? 0 : 3);
+}
+
+TEST(SrpcQueueTests, OutQueueOverflow) {
+  SrpcTestPipe pipe;
+  auto device = pipe.device.srpc;
+
+  for (int i = 0; i < QueueSize; i++) {
+    EXPECT_NE(srpc_dcs_async_ping_server(device), 0);
+  }
+  EXPECT_EQ(srpc_dcs_async_ping_server(device), 0);
+  EXPECT_EQ(srpc_out_queue_item_count(device), QueueSize);
+
+  TsrpcQueueStats outStats = {};
+  srpc_get_queue_stats(device, nullptr, &outStats);
+  EXPECT_EQ(outStats.push_count, QueueSize);
+  EXPECT_EQ(outStats.push_fail_count, 1);
+  EXPECT_EQ(outStats.max_item_count, QueueSize);
+
+  // queue has room again after one packet is sent
+  EXPECT_EQ(srpc_iterate(device), SUPLA_RESULT_TRUE);
+  EXPECT_NE(srpc_dcs_async_ping_server(device), 0);
+  srpc_get_queue_stats(device, nullptr, &outStats);
+  EXPECT_EQ(outStats.push_count, QueueSize + 1);
+  EXPECT_EQ(outStats.pop_count, 1);
+  EXPECT_EQ(outStats.malloc_count, expectedAllocs(QueueSize + 1));
+}
+
+TEST(SrpcQueueTests, InQueueKeepsReceivedCallsUntilGetData) {
+  SrpcTestPipe pipe;
+  auto device = pipe.device.srpc;
+  auto server = pipe.server.srpc;
+
+  EXPECT_NE(srpc_dcs_async_ping_server(device), 0);
+  EXPECT_NE(srpc_dcs_async_get_user_localtime(device), 0);
+  EXPECT_EQ(srpc_iterate(device), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(srpc_iterate(device), SUPLA_RESULT_TRUE);
+
+  // server reads both packets in one data read, so second one is taken from
+  // proto input buffer in the next iteration
+  EXPECT_EQ(srpc_iterate(server), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(srpc_iterate(server), SUPLA_RESULT_TRUE);
+  ASSERT_EQ(pipe.server.receivedCalls.size(), 2);
+  EXPECT_EQ(pipe.server.receivedCalls[0], SUPLA_DCS_CALL_PING_SERVER);
+  EXPECT_EQ(pipe.server.receivedCalls[1], SUPLA_DCS_CALL_GET_USER_LOCALTIME);
+
+  TsrpcQueueStats inStats = {};
+  srpc_get_queue_stats(server, &inStats, nullptr);
+  EXPECT_EQ(inStats.push_count, 2);
+  EXPECT_EQ(inStats.pop_count, 0);
+  EXPECT_EQ(inStats.max_item_count, 2);
+
+  TsrpcReceivedData rd = {};
+  ASSERT_EQ(srpc_getdata(server, &rd, 0), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(rd.call_id, SUPLA_DCS_CALL_PING_SERVER);
+  EXPECT_NE(rd.data.dcs_ping, nullptr);
+  srpc_rd_free(&rd);
+
+  ASSERT_EQ(srpc_getdata(server, &rd, 0), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(rd.call_id, SUPLA_DCS_CALL_GET_USER_LOCALTIME);
+  srpc_rd_free(&rd);
+
+  EXPECT_EQ(srpc_getdata(server, &rd, 0), SUPLA_RESULT_FALSE);
+
+  srpc_get_queue_stats(server, &inStats, nullptr);
+  EXPECT_EQ(inStats.push_count, 2);
+  EXPECT_EQ(inStats.pop_count, 2);
+  EXPECT_EQ(inStats.malloc_count, expectedAllocs(2));
+}
+
+TEST(SrpcQueueTests, PopByRrIdKeepsOrderOfOtherPackets) {
+  SrpcTestPipe pipe;
+  auto device = pipe.device.srpc;
+  auto server = pipe.server.srpc;
+
+  _supla_int_t rrIds[3] = {};
+  for (int i = 0; i < 3; i++) {
+    rrIds[i] = srpc_dcs_async_ping_server(device);
+    EXPECT_NE(rrIds[i], 0);
+  }
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(srpc_iterate(device), SUPLA_RESULT_TRUE);
+  }
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(srpc_iterate(server), SUPLA_RESULT_TRUE);
+  }
+
+  TsrpcReceivedData rd = {};
+  ASSERT_EQ(srpc_getdata(server, &rd, rrIds[1]), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(rd.rr_id, rrIds[1]);
+  srpc_rd_free(&rd);
+  ASSERT_EQ(srpc_getdata(server, &rd, 0), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(rd.rr_id, rrIds[0]);
+  srpc_rd_free(&rd);
+  ASSERT_EQ(srpc_getdata(server, &rd, 0), SUPLA_RESULT_TRUE);
+  EXPECT_EQ(rd.rr_id, rrIds[2]);
+  srpc_rd_free(&rd);
+}
+
+TEST(SrpcQueueTests, PushIterateBenchmark) {
+  const int Cycles = 100000;
+  SrpcTestPipe pipe;
+  auto device = pipe.device.srpc;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < Cycles; i++) {
+    srpc_dcs_async_ping_server(device);
+    srpc_iterate(device);
+    pipe.device.out->clear();
+  }
+  auto durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  TsrpcQueueStats outStats = {};
+  srpc_get_queue_stats(device, nullptr, &outStats);
+  EXPECT_EQ(outStats.push_count, Cycles);
+  EXPECT_EQ(outStats.pop_count, Cycles);
+  EXPECT_EQ(outStats.push_fail_count, 0);
+  EXPECT_EQ(outStats.malloc_count, expectedAllocs(Cycles));
+  EXPECT_EQ(outStats.free_count, PoolUsed ? 0 : Cycles);
+
+  RecordProperty("nsPerPushIterateCycle", std::to_string(durationNs / Cycles));
+  RecordProperty("outQueueMallocs", std::to_string(outStats.malloc_count));
+}
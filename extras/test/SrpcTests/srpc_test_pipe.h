@@ -0,0 +1,107 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef EXTRAS_TEST_SRPCTESTS_SRPC_TEST_PIPE_H_
+#define EXTRAS_TEST_SRPCTESTS_SRPC_TEST_PIPE_H_
+
+#include <supla-common/srpc.h>
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+// Two SRPC instances connected with in-memory byte streams. Data written by
+// "device" is read by "server" and vice versa.
+class SrpcTestPipe {
+ public:
+  struct Endpoint {
+    std::deque<char> *in = nullptr;
+    std::deque<char> *out = nullptr;
+    std::vector<int> writeSizes;
+    std::vector<unsigned _supla_int_t> receivedCalls;
+    void *srpc = nullptr;
+  };
+
+  SrpcTestPipe() {
+    device.in = &serverToDevice;
+    device.out = &deviceToServer;
+    server.in = &deviceToServer;
+    server.out = &serverToDevice;
+    device.srpc = init(&device);
+    server.srpc = init(&server);
+  }
+
+  ~SrpcTestPipe() {
+    srpc_free(device.srpc);
+    srpc_free(server.srpc);
+  }
+
+  static _supla_int_t dataRead(void *buf, _supla_int_t count, void *params) {
+    auto endpoint = reinterpret_cast<Endpoint *>(params);
+    if (endpoint->in->empty()) {
+      // no data, but connection is still open
+      return -1;
+    }
+    _supla_int_t size = 0;
+    char *ptr = reinterpret_cast<char *>(buf);
+    while (size < count && !endpoint->in->empty()) {
+      ptr[size++] = endpoint->in->front();
+      endpoint->in->pop_front();
+    }
+    return size;
+  }
+
+  static _supla_int_t dataWrite(void *buf, _supla_int_t count, void *params) {
+    auto endpoint = reinterpret_cast<Endpoint *>(params);
+    char *ptr = reinterpret_cast<char *>(buf);
+    endpoint->out->insert(endpoint->out->end(), ptr, ptr + count);
+    endpoint->writeSizes.push_back(count);
+    return count;
+  }
+
+  static void onRemoteCallReceived(void *srpc,
+                                   unsigned _supla_int_t rr_id,
+                                   unsigned _supla_int_t call_id,
+                                   void *params,
+                                   unsigned char proto_version) {
+    (void)(srpc);
+    (void)(rr_id);
+    (void)(proto_version);
+    auto endpoint = reinterpret_cast<Endpoint *>(params);
+    endpoint->receivedCalls.push_back(call_id);
+  }
+
+  Endpoint device;
+  Endpoint server;
+
+ private:
+  void *init(Endpoint *endpoint) {
+    TsrpcParams params;
+    srpc_params_init(&params);
+    params.data_read = &SrpcTestPipe::dataRead;
+    params.data_write = &SrpcTestPipe::dataWrite;
+    params.on_remote_call_received = &SrpcTestPipe::onRemoteCallReceived;
+    params.user_params = endpoint;
+    return srpc_init(&params);
+  }
+
+  std::deque<char> deviceToServer;
+  std::deque<char> serverToDevice;
+};
+
+#endif  // EXTRAS_TEST_SRPCTESTS_SRPC_TEST_PIPE_H_
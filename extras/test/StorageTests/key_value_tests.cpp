@@ -22,6 +22,10 @@
 #include <supla-common/proto.h>
 #include <stdio.h>
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
 #include "supla/storage/config.h"
 
 class KeyValueTest : public Supla::KeyValue {
@@ -542,3 +546,56 @@ TEST(KeyValueTests, addEraseAddTest) {
   EXPECT_TRUE(kvStorage.getInt32("key100", &result32));
   EXPECT_EQ(result32, 5000);
 }
+
+TEST(KeyValueTests, loadManyKeysFromMemory) {
+  const int keyCount = 2000;
+  const size_t bufferSize = 64 * 1024;
+  std::vector<uint8_t> buffer(bufferSize);
+  size_t dataSize = 0;
+
+  {
+    KeyValueTest kvStorage;
+    char key[SUPLA_CONFIG_MAX_KEY_SIZE] = {};
+    for (int i = 0; i < keyCount; i++) {
+      Supla::Config::generateKey(key, i, "param");
+      EXPECT_TRUE(kvStorage.setUInt32(key, i * 3));
+    }
+    dataSize = kvStorage.serializeToMemory(buffer.data(), bufferSize);
+    EXPECT_GT(dataSize, 0);
+  }
+
+  KeyValueTest kvStorage;
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(kvStorage.initFromMemory(buffer.data(), dataSize));
+
+  char key[SUPLA_CONFIG_MAX_KEY_SIZE] = {};
+  uint32_t value = 0;
+  for (int i = 0; i < keyCount; i++) {
+    Supla::Config::generateKey(key, i, "param");
+    ASSERT_TRUE(kvStorage.getUInt32(key, &value));
+    EXPECT_EQ(value, i * 3);
+  }
+  auto end = std::chrono::steady_clock::now();
+  RecordProperty(
+      "loadAndReadUs",
+      std::to_string(
+          std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+              .count()));
+
+  EXPECT_FALSE(kvStorage.getUInt32("missing", &value));
+
+  // serialization keeps order of elements
+  std::vector<uint8_t> buffer2(bufferSize);
+  EXPECT_EQ(kvStorage.serializeToMemory(buffer2.data(), bufferSize), dataSize);
+  EXPECT_EQ(memcmp(buffer.data(), buffer2.data(), dataSize), 0);
+
+  // erase every second key
+  for (int i = 0; i < keyCount; i += 2) {
+    Supla::Config::generateKey(key, i, "param");
+    EXPECT_TRUE(kvStorage.eraseKey(key));
+  }
+  for (int i = 0; i < keyCount; i++) {
+    Supla::Config::generateKey(key, i, "param");
+    EXPECT_EQ(kvStorage.getUInt32(key, &value), i % 2 == 1);
+  }
+}
@@ -0,0 +1,275 @@
+/*
+   Copyright (C) AC SOFTWARE SP. Z O.O
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+   */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <storage_mock.h>
+#include <supla/channel_element.h>
+#include <supla/crc16.h>
+#include <supla/storage/storage.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int SectionDataOffset =
+    sizeof(Supla::Preamble) + sizeof(Supla::SectionPreamble);
+
+class CountingStorageSimulator : public StorageMockSimulator {
+ public:
+  int readStorage(unsigned int offset,
+                  unsigned char *data,
+                  unsigned int size,
+                  bool log) override {
+    bytesRead += size;
+    return StorageMockSimulator::readStorage(offset, data, size, log);
+  }
+
+  int writeStorage(unsigned int offset,
+                   const unsigned char *data,
+                   unsigned int size) override {
+    bytesWritten += size;
+    return StorageMockSimulator::writeStorage(offset, data, size);
+  }
+
+  void resetCounters() {
+    bytesRead = 0;
+    bytesWritten = 0;
+  }
+
+  // Checks if CRC in section preamble matches stored section data
+  bool isSectionCrcValid() {
+    auto preamble = getSectionPreamble();
+    uint16_t crc = calculateCrc16(storageSimulatorData + SectionDataOffset,
+                                  preamble->size);
+    return preamble->crc1 == crc && preamble->crc2 == crc;
+  }
+
+  int bytesRead = 0;
+  int bytesWritten = 0;
+};
+
+class ElementWithTrackedState : public Supla::ChannelElement {
+ public:
+  explicit ElementWithTrackedState(bool tracking = true, int size = 16)
+      : data(size, 0) {
+    if (tracking) {
+      enableStateChangeTracking();
+    }
+  }
+
+  void setByte(int index, uint8_t value) {
+    data[index] = value;
+    markStateChanged();
+  }
+
+  void resize(int size) {
+    data.resize(size, 0);
+    markStateChanged();
+  }
+
+  void onSaveState() override {
+    saveCount++;
+    Supla::Storage::WriteState(data.data(), data.size());
+  }
+
+  void onLoadState() override {
+    Supla::Storage::ReadState(data.data(), data.size());
+  }
+
+  std::vector<uint8_t> data;
+  int saveCount = 0;
+};
+
+class StorageStateIncrementalTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    EXPECT_CALL(storage, commit()).Times(::testing::AnyNumber());
+    ASSERT_TRUE(Supla::Storage::Init());
+  }
+
+  CountingStorageSimulator storage;
+};
+
+}  // namespace
+
+TEST_F(StorageStateIncrementalTests, unchangedElementIsNotSavedAgain) {
+  ElementWithTrackedState el1;
+  ElementWithTrackedState el2;
+  ElementWithTrackedState untracked(false);
+
+  ASSERT_FALSE(Supla::Storage::IsStateStorageValid());
+  // size check calls onSaveState() on all elements
+  el1.saveCount = 0;
+  el2.saveCount = 0;
+  untracked.saveCount = 0;
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(el1.saveCount, 1);
+  EXPECT_EQ(el2.saveCount, 1);
+  EXPECT_EQ(untracked.saveCount, 1);
+  EXPECT_TRUE(storage.isSectionCrcValid());
+
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(el1.saveCount, 1);
+  EXPECT_EQ(el2.saveCount, 1);
+  // element without tracking is always saved
+  EXPECT_EQ(untracked.saveCount, 2);
+
+  el2.setByte(3, 0x55);
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(el1.saveCount, 1);
+  EXPECT_EQ(el2.saveCount, 2);
+  EXPECT_EQ(untracked.saveCount, 3);
+  EXPECT_TRUE(storage.isSectionCrcValid());
+  EXPECT_EQ(storage.storageSimulatorData[SectionDataOffset + 16 + 3], 0x55);
+
+  el1.setByte(0, 0x11);
+  untracked.data[15] = 0x22;
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(el1.saveCount, 2);
+  EXPECT_EQ(el2.saveCount, 2);
+  EXPECT_TRUE(storage.isSectionCrcValid());
+  EXPECT_EQ(storage.getSectionPreamble()->size, 48);
+
+  el1.data[0] = 0;
+  el2.data[3] = 0;
+  untracked.data[15] = 0;
+  Supla::Storage::LoadStateStorage();
+  EXPECT_EQ(el1.data[0], 0x11);
+  EXPECT_EQ(el2.data[3], 0x55);
+  EXPECT_EQ(untracked.data[15], 0x22);
+}
+
+TEST_F(StorageStateIncrementalTests, elementsAfterResizedStateAreRewritten) {
+  ElementWithTrackedState el1;
+  ElementWithTrackedState el2;
+  ElementWithTrackedState el3;
+  el3.setByte(0, 0x33);
+
+  ASSERT_FALSE(Supla::Storage::IsStateStorageValid());
+  el1.saveCount = 0;
+  el2.saveCount = 0;
+  el3.saveCount = 0;
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(storage.getSectionPreamble()->size, 48);
+
+  // el2 state doesn't fit in section, so section is rewritten on next save
+  // and el3 state is moved
+  el2.resize(20);
+  el2.setByte(19, 0x22);
+  Supla::Storage::WriteStateStorage();
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(el1.saveCount, 2);
+  EXPECT_EQ(el2.saveCount, 3);
+  EXPECT_EQ(el3.saveCount, 3);
+  EXPECT_EQ(storage.getSectionPreamble()->size, 52);
+  EXPECT_TRUE(storage.isSectionCrcValid());
+  EXPECT_EQ(storage.storageSimulatorData[SectionDataOffset + 36], 0x33);
+
+  // all segments are at their new offsets now
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(el1.saveCount, 2);
+  EXPECT_EQ(el2.saveCount, 3);
+  EXPECT_EQ(el3.saveCount, 3);
+  EXPECT_TRUE(storage.isSectionCrcValid());
+
+  el3.data[0] = 0;
+  el2.data[19] = 0;
+  Supla::Storage::LoadStateStorage();
+  EXPECT_EQ(el2.data[19], 0x22);
+  EXPECT_EQ(el3.data[0], 0x33);
+}
+
+TEST_F(StorageStateIncrementalTests, channelNumbersAreKeptForSkippedElements) {
+  storage.enableChannelNumbers();
+  ElementWithTrackedState el1;
+  ElementWithTrackedState el2;
+
+  ASSERT_FALSE(Supla::Storage::IsStateStorageValid());
+  el1.saveCount = 0;
+  el2.saveCount = 0;
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(storage.getSectionPreamble()->size, 34);
+
+  el2.setByte(5, 0x25);
+  Supla::Storage::WriteStateStorage();
+  EXPECT_EQ(el1.saveCount, 1);
+  EXPECT_EQ(el2.saveCount, 2);
+  EXPECT_TRUE(storage.isSectionCrcValid());
+  EXPECT_EQ(storage.storageSimulatorData[SectionDataOffset + 17],
+            el2.getChannelNumber());
+
+  el2.data[5] = 0;
+  Supla::Storage::LoadStateStorage();
+  EXPECT_EQ(el2.data[5], 0x25);
+}
+
+TEST_F(StorageStateIncrementalTests, bytesWrittenPerSaveBenchmark) {
+  constexpr int ElementCount = 40;
+  constexpr int SaveCount = 100;
+
+  auto run = [this](bool tracking, int *bytesRead, int *bytesWritten,
+                    int *saveCalls) {
+    std::vector<std::unique_ptr<ElementWithTrackedState>> elements;
+    for (int i = 0; i < ElementCount; i++) {
+      elements.push_back(
+          std::make_unique<ElementWithTrackedState>(tracking, 32));
+    }
+    Supla::Storage::IsStateStorageValid();
+    Supla::Storage::WriteStateStorage();
+
+    storage.resetCounters();
+    for (auto &element : elements) {
+      element->saveCount = 0;
+    }
+    // one element changes between saves
+    for (int i = 0; i < SaveCount; i++) {
+      elements[i % ElementCount]->setByte(i % 32, static_cast<uint8_t>(i + 1));
+      Supla::Storage::WriteStateStorage();
+    }
+    EXPECT_TRUE(storage.isSectionCrcValid());
+
+    *bytesRead = storage.bytesRead / SaveCount;
+    *bytesWritten = storage.bytesWritten / SaveCount;
+    *saveCalls = 0;
+    for (auto &element : elements) {
+      *saveCalls += element->saveCount;
+    }
+    *saveCalls /= SaveCount;
+  };
+
+  int fullRead = 0, fullWritten = 0, fullCalls = 0;
+  run(false, &fullRead, &fullWritten, &fullCalls);
+  int incRead = 0, incWritten = 0, incCalls = 0;
+  run(true, &incRead, &incWritten, &incCalls);
+
+  EXPECT_EQ(fullCalls, ElementCount);
+  EXPECT_EQ(incCalls, 1);
+  EXPECT_LT(incRead, fullRead);
+  EXPECT_LE(incWritten, fullWritten);
+
+  RecordProperty("fullSaveBytesRead", std::to_string(fullRead));
+  RecordProperty("fullSaveBytesWritten", std::to_string(fullWritten));
+  RecordProperty("fullSaveElementCalls", std::to_string(fullCalls));
+  RecordProperty("incrementalSaveBytesRead", std::to_string(incRead));
+  RecordProperty("incrementalSaveBytesWritten", std::to_string(incWritten));
+  RecordProperty("incrementalSaveElementCalls", std::to_string(incCalls));
+}
@@ -0,0 +1,157 @@
+/*
+   Copyright (C) AC SOFTWARE SP. Z O.O
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+   */
+
+
+#include <gtest/gtest.h>
+#include <supla/element.h>
+#include <supla/storage/storage.h>
+#include <string.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<bool> countAllocations(false);
+std::atomic<uint32_t> allocationCount(0);
+}  // namespace
+
+// Counts allocations of whole test binary while countAllocations is set
+void *operator new(std::size_t size) {
+  if (countAllocations) {
+    allocationCount++;
+  }
+  void *ptr = std::malloc(size ? size : 1);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace {
+
+// Storage in RAM without gmock, which allocates on each mocked call
+class UpdateStorageSimulator : public Supla::Storage {
+ public:
+  using Supla::Storage::updateStorage;
+
+  int readStorage(unsigned int offset,
+                  unsigned char *buf,
+                  unsigned int size,
+                  bool) override {
+    memcpy(buf, storageData + offset, size);
+    return size;
+  }
+
+  int writeStorage(unsigned int offset,
+                   const unsigned char *buf,
+                   unsigned int size) override {
+    writeCount++;
+    memcpy(storageData + offset, buf, size);
+    return size;
+  }
+
+  void commit() override {
+  }
+
+  unsigned char storageData[4096] = {};
+  int writeCount = 0;
+};
+
+class ElementWithLargeState : public Supla::Element {
+ public:
+  void onSaveState() override {
+    Supla::Storage::WriteState(data, sizeof(data));
+  }
+
+  void onLoadState() override {
+    Supla::Storage::ReadState(data, sizeof(data));
+  }
+
+  unsigned char data[300] = {};
+};
+
+}  // namespace
+
+TEST(StorageUpdateTests, updateWritesOnlyWhenDataDiffers) {
+  UpdateStorageSimulator storage;
+  std::vector<unsigned char> buf(100);
+  for (int i = 0; i < 100; i++) {
+    buf[i] = i + 1;
+  }
+
+  EXPECT_EQ(storage.updateStorage(100, buf.data(), 100), 100);
+  EXPECT_EQ(storage.writeCount, 1);
+  EXPECT_EQ(memcmp(storage.storageData + 100, buf.data(), 100), 0);
+
+  EXPECT_EQ(storage.updateStorage(100, buf.data(), 100), 100);
+  EXPECT_EQ(storage.writeCount, 1);
+
+  // difference in last chunk
+  buf[99] = 0;
+  EXPECT_EQ(storage.updateStorage(100, buf.data(), 100), 100);
+  EXPECT_EQ(storage.writeCount, 2);
+  EXPECT_EQ(storage.storageData[199], 0);
+
+  // difference in first byte
+  buf[0] = 0;
+  EXPECT_EQ(storage.updateStorage(100, buf.data(), 100), 100);
+  EXPECT_EQ(storage.writeCount, 3);
+
+  EXPECT_EQ(storage.updateStorage(100, buf.data(), 0), 0);
+  EXPECT_EQ(storage.writeCount, 3);
+}
+
+TEST(StorageUpdateTests, stateSaveDoesntAllocate) {
+  UpdateStorageSimulator storage;
+  ElementWithLargeState el1;
+  ElementWithLargeState el2;
+
+  EXPECT_TRUE(Supla::Storage::Init());
+  ASSERT_FALSE(Supla::Storage::IsStateStorageValid());
+  // first save allocates state segments table
+  Supla::Storage::WriteStateStorage();
+
+  constexpr int SaveCount = 50;
+  allocationCount = 0;
+  countAllocations = true;
+  for (int i = 0; i < SaveCount; i++) {
+    el1.data[i] = i;
+    el2.data[299 - i] = i;
+    Supla::Storage::WriteStateStorage();
+  }
+  countAllocations = false;
+
+  RecordProperty("allocationsPerSave",
+                 std::to_string(allocationCount / SaveCount));
+  EXPECT_EQ(allocationCount, 0);
+
+  memset(el1.data, 0, sizeof(el1.data));
+  Supla::Storage::LoadStateStorage();
+  EXPECT_EQ(el1.data[SaveCount - 1], SaveCount - 1);
+}
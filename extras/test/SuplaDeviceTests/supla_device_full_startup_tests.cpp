@@ -19,6 +19,7 @@
 #include <SuplaDevice.h>
 #include <arduino_mock.h>
 #include <board_mock.h>
+#include <channel_element_mock.h>
 #include <config_mock.h>
 #include <element_mock.h>
 #include <gmock/gmock.h>
@@ -290,6 +291,231 @@ TEST_F(SuplaDeviceTestsFullStartup, SuccessfulStartup) {
   EXPECT_EQ(sd.getCurrentStatus(), STATUS_REGISTERED_AND_READY);
 }
 
+class IterateConnectedPolicyTests
+    : public SuplaDeviceTestsFullStartup,
+      public ::testing::WithParamInterface<Supla::IterateConnectedPolicy> {};
+
+TEST_P(IterateConnectedPolicyTests, ElementsSendingUpdates) {
+  bool isConnected = false;
+  EXPECT_CALL(net, isReady()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*client, connected()).WillRepeatedly(ReturnPointee(&isConnected));
+  EXPECT_CALL(*client, connectImp(_, _))
+      .WillRepeatedly(DoAll(Assign(&isConnected, true), Return(1)));
+
+  EXPECT_CALL(net, setup()).Times(1);
+  EXPECT_CALL(net, iterate()).Times(AtLeast(1));
+  EXPECT_CALL(srpc, srpc_iterate(_)).WillRepeatedly(Return(SUPLA_RESULT_TRUE));
+  EXPECT_CALL(srpc, srpc_params_init(_));
+  int dummy;
+  EXPECT_CALL(srpc, srpc_init(_)).WillOnce(Return(&dummy));
+  EXPECT_CALL(srpc, srpc_set_proto_version(&dummy, defaultProtoVersion));
+  EXPECT_CALL(srpc, srpc_ds_async_registerdevice_in_chunks(_, _))
+      .WillOnce(Return(1));
+  EXPECT_CALL(srpc, srpc_dcs_async_set_activity_timeout(_, _)).Times(1);
+  EXPECT_CALL(srpc, srpc_dcs_async_ping_server(_)).Times(AtLeast(0));
+
+  EXPECT_CALL(el1, iterateAlways()).Times(AtLeast(1));
+  EXPECT_CALL(el2, iterateAlways()).Times(AtLeast(1));
+  EXPECT_CALL(el1, onRegistered(_));
+  EXPECT_CALL(el2, onRegistered(_));
+
+  // Both elements send something in each call. In default mode each
+  // iteration ends on element which sent data, so el1, el2 and Clock (which
+  // is last on the list) are handled in separate iterations.
+  int expectedCalls =
+      GetParam() == Supla::IterateConnectedPolicy::AllElementsPerIteration
+          ? 30
+          : 10;
+  EXPECT_CALL(el1, iterateConnected())
+      .Times(expectedCalls)
+      .WillRepeatedly(Return(false));
+  EXPECT_CALL(el2, iterateConnected())
+      .Times(expectedCalls)
+      .WillRepeatedly(Return(false));
+
+  sd.setIterateConnectedPolicy(GetParam());
+  for (int i = 0; i < 5; i++) {
+    sd.iterate();
+    time.advance(1000);
+  }
+
+  TSD_SuplaRegisterDeviceResult register_device_result{};
+  register_device_result.result_code = SUPLA_RESULTCODE_TRUE;
+  register_device_result.activity_timeout = 45;
+  register_device_result.version = 20;
+  register_device_result.version_min = 1;
+
+  sd.getSrpcLayer()->onRegisterResult(&register_device_result);
+  time.advance(100);
+  EXPECT_EQ(sd.getCurrentStatus(), STATUS_REGISTERED_AND_READY);
+
+  for (int i = 0; i < 30; i++) {
+    sd.iterate();
+    time.advance(1000);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SuplaDeviceTestsFullStartup,
+    IterateConnectedPolicyTests,
+    ::testing::Values(
+        Supla::IterateConnectedPolicy::OneElementUpdatePerIteration,
+        Supla::IterateConnectedPolicy::AllElementsPerIteration));
+
+// Channel element which, like in-tree sensors, only sends channel updates from
+// iterateConnected()
+class NotPolledChannelElementMock : public ChannelElementMock {
+ public:
+  NotPolledChannelElementMock() {
+    setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
+  }
+};
+
+TEST(IterateConnectedPollingTests, ChannelElementIsPolledByDefault) {
+  Supla::Channel::resetToDefaults();
+  {
+    ChannelElementMock element;
+    Supla::Sensor::ThermHygroPressMeter sensor;
+    EXPECT_TRUE(element.isIterateConnectedPolled());
+    EXPECT_FALSE(sensor.isIterateConnectedPolled());
+  }
+  Supla::Channel::resetToDefaults();
+}
+
+class PendingChannelsIterationTests : public SuplaDeviceTestsFullStartup {
+ protected:
+  NotPolledChannelElementMock ch1;
+  NotPolledChannelElementMock ch2;
+
+  void SetUp() override {
+    EXPECT_CALL(ch1, onInit());
+    EXPECT_CALL(ch2, onInit());
+    SuplaDeviceTestsFullStartup::SetUp();
+    ch1.getChannel()->setType(SUPLA_CHANNELTYPE_RELAY);
+    ch2.getChannel()->setType(SUPLA_CHANNELTYPE_RELAY);
+  }
+
+  void connectAndRegister() {
+    EXPECT_CALL(net, isReady()).WillRepeatedly(Return(true));
+    EXPECT_CALL(*client, connected())
+        .WillRepeatedly(ReturnPointee(&isConnected));
+    EXPECT_CALL(*client, connectImp(_, _))
+        .WillRepeatedly(DoAll(Assign(&isConnected, true), Return(1)));
+
+    EXPECT_CALL(net, setup()).Times(1);
+    EXPECT_CALL(net, iterate()).Times(AtLeast(1));
+    EXPECT_CALL(srpc, srpc_iterate(_))
+        .WillRepeatedly(Return(SUPLA_RESULT_TRUE));
+    EXPECT_CALL(srpc, srpc_params_init(_));
+    EXPECT_CALL(srpc, srpc_init(_)).WillOnce(Return(&dummy));
+    EXPECT_CALL(srpc, srpc_set_proto_version(&dummy, defaultProtoVersion));
+    EXPECT_CALL(srpc, srpc_ds_async_registerdevice_in_chunks(_, _))
+        .WillOnce(Return(1));
+    EXPECT_CALL(srpc, srpc_dcs_async_set_activity_timeout(_, _)).Times(1);
+    EXPECT_CALL(srpc, srpc_dcs_async_ping_server(_)).Times(AtLeast(0));
+
+    EXPECT_CALL(el1, iterateAlways()).Times(AtLeast(1));
+    EXPECT_CALL(el2, iterateAlways()).Times(AtLeast(1));
+    EXPECT_CALL(ch1, iterateAlways()).Times(AtLeast(1));
+    EXPECT_CALL(ch2, iterateAlways()).Times(AtLeast(1));
+    EXPECT_CALL(el1, onRegistered(_));
+    EXPECT_CALL(el2, onRegistered(_));
+    EXPECT_CALL(ch1, onRegistered(_));
+    EXPECT_CALL(ch2, onRegistered(_));
+    // polled elements don't send anything
+    EXPECT_CALL(el1, iterateConnected()).WillRepeatedly(Return(true));
+    EXPECT_CALL(el2, iterateConnected()).WillRepeatedly(Return(true));
+
+    for (int i = 0; i < 5; i++) {
+      sd.iterate();
+      time.advance(1000);
+    }
+
+    TSD_SuplaRegisterDeviceResult register_device_result{};
+    register_device_result.result_code = SUPLA_RESULTCODE_TRUE;
+    register_device_result.activity_timeout = 45;
+    register_device_result.version = 20;
+    register_device_result.version_min = 1;
+
+    sd.getSrpcLayer()->onRegisterResult(&register_device_result);
+    time.advance(100);
+    EXPECT_EQ(sd.getCurrentStatus(), STATUS_REGISTERED_AND_READY);
+    ch1.getChannel()->clearSendValue();
+    ch2.getChannel()->clearSendValue();
+  }
+
+  void setNewValue(ChannelElementMock *element) {
+    auto channel = element->getChannel();
+    channel->setNewValue(!channel->getValueBool());
+  }
+
+  bool isConnected = false;
+  int dummy = 0;
+};
+
+TEST_F(PendingChannelsIterationTests, OnlyOwnersOfPendingChannelsAreIterated) {
+  EXPECT_CALL(ch1, iterateConnected()).Times(0);
+  EXPECT_CALL(ch2, iterateConnected())
+      .Times(1)
+      .WillOnce([this]() {
+        ch2.getChannel()->clearSendValue();
+        return false;
+      });
+  connectAndRegister();
+  EXPECT_FALSE(ch1.isIterateConnectedPolled());
+  EXPECT_TRUE(el1.isIterateConnectedPolled());
+
+  for (int i = 0; i < 5; i++) {
+    sd.iterate();
+    time.advance(1000);
+  }
+  EXPECT_FALSE(Supla::Element::IsAnyUpdatePending());
+
+  setNewValue(&ch2);
+  EXPECT_EQ(Supla::Element::GetOwnerOfChannelNumber(
+                ch2.getChannel()->getChannelNumber()),
+            &ch2);
+  for (int i = 0; i < 5; i++) {
+    sd.iterate();
+    time.advance(1000);
+  }
+  EXPECT_FALSE(Supla::Channel::IsAnyUpdatePending());
+}
+
+TEST_F(PendingChannelsIterationTests, PendingChannelsAreIteratedRoundRobin) {
+  // Both elements send something, but their channels stay queued. With
+  // default policy only one of them is handled in each iteration.
+  int ch1Calls = 0;
+  int ch2Calls = 0;
+  EXPECT_CALL(ch1, iterateConnected()).WillRepeatedly([&ch1Calls]() {
+    ch1Calls++;
+    return false;
+  });
+  EXPECT_CALL(ch2, iterateConnected()).WillRepeatedly([&ch2Calls]() {
+    ch2Calls++;
+    return false;
+  });
+  connectAndRegister();
+
+  setNewValue(&ch1);
+  setNewValue(&ch2);
+  for (int i = 0; i < 30; i++) {
+    sd.iterate();
+    time.advance(1000);
+  }
+  EXPECT_EQ(ch1Calls, 15);
+  EXPECT_EQ(ch2Calls, 15);
+
+  sd.setIterateConnectedPolicy(
+      Supla::IterateConnectedPolicy::AllElementsPerIteration);
+  for (int i = 0; i < 10; i++) {
+    sd.iterate();
+    time.advance(100);
+  }
+  EXPECT_EQ(ch1Calls, 25);
+  EXPECT_EQ(ch2Calls, 25);
+}
+
 TEST_F(SuplaDeviceTestsFullStartupNoClient,
        NoNetworkShouldCallSetupAgainAndResetDev) {
   EXPECT_CALL(net, isReady()).WillRepeatedly(Return(false));
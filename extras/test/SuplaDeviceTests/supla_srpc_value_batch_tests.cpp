@@ -0,0 +1,216 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <network_client_mock.h>
+#include <simple_time.h>
+#include <srpc_mock.h>
+#include <supla/protocol/supla_srpc.h>
+
+#include <vector>
+
+using ::testing::_;
+using ::testing::ElementsAreArray;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class SuplaSrpcBatchLayer : public Supla::Protocol::SuplaSrpc {
+ public:
+  SuplaSrpcBatchLayer() : Supla::Protocol::SuplaSrpc(nullptr) {
+  }
+
+  void setRegisteredAndReady(void *srpcPtr) {
+    srpc = srpcPtr;
+    registered = 1;
+  }
+
+  void setDisconnected() {
+    registered = 0;
+    srpc = nullptr;
+  }
+};
+
+class SuplaSrpcValueBatchTests : public ::testing::Test {
+ protected:
+  SimpleTime time;
+  SrpcMock srpcMock;
+  SuplaSrpcBatchLayer layer;
+  NetworkClientMock *client = nullptr;
+  int dummySrpc = 0;
+
+  void SetUp() override {
+    client = new NetworkClientMock;  // deleted by SuplaSrpc
+    layer.client = client;
+    layer.setRegisteredAndReady(&dummySrpc);
+    layer.setValueBatching(true);
+  }
+
+  void TearDown() override {
+    layer.setDisconnected();
+  }
+};
+
+TEST_F(SuplaSrpcValueBatchTests, LastValuePerChannelWinsAndOrderIsKept) {
+  std::vector<char> value1 = {1, 0, 0, 0, 0, 0, 0, 0};
+  std::vector<char> value2 = {2, 0, 0, 0, 0, 0, 0, 0};
+  std::vector<char> value3 = {3, 0, 0, 0, 0, 0, 0, 0};
+
+  EXPECT_TRUE(layer.isValueBatchingEnabled());
+
+  layer.sendChannelValueChanged(
+      3, reinterpret_cast<int8_t *>(value1.data()), 0, 0);
+  time.advance(10);
+  layer.sendChannelValueChanged(
+      1, reinterpret_cast<int8_t *>(value2.data()), 1, 0);
+  time.advance(10);
+  layer.sendChannelValueChanged(
+      3, reinterpret_cast<int8_t *>(value3.data()), 0, 60);
+  time.advance(30);
+
+  {
+    InSequence seq;
+    EXPECT_CALL(srpcMock,
+                valueChanged(_, 3, ElementsAreArray(value3), 0, 60));
+    EXPECT_CALL(srpcMock,
+                valueChanged(_, 1, ElementsAreArray(value2), 1, 0));
+  }
+
+  layer.flushValueBatch();
+  // nothing left to send
+  layer.flushValueBatch();
+
+  auto stats = layer.getValueBatchStats();
+  EXPECT_EQ(stats.queued, 3);
+  EXPECT_EQ(stats.coalesced, 1);
+  EXPECT_EQ(stats.sent, 2);
+  EXPECT_EQ(stats.flushes, 1);
+  EXPECT_EQ(stats.maxLatencyMs, 50);
+  EXPECT_EQ(stats.totalLatencyMs, 90);
+
+  layer.resetValueBatchStats();
+  EXPECT_EQ(layer.getValueBatchStats().queued, 0);
+}
+
+TEST_F(SuplaSrpcValueBatchTests, FlushIsCoalescedIntoFewClientWrites) {
+  // each value is written by SRPC as packet followed by a separate tag
+  const int packetSize = 30;
+  const int tagSize = 5;
+  const int channelCount = 100;
+  char packet[packetSize] = {};
+  char tag[tagSize] = {};
+  int bytesWritten = 0;
+
+  EXPECT_CALL(srpcMock, valueChanged(_, _, _, _, _))
+      .Times(channelCount)
+      .WillRepeatedly(Invoke([&](void *, unsigned char, std::vector<char>,
+                                 unsigned char, unsigned _supla_int_t) {
+        Supla::dataWrite(packet, packetSize, &layer);
+        Supla::dataWrite(tag, tagSize, &layer);
+        return 0;
+      }));
+
+  // 29 values fit in one 1024 B buffer, so 100 values need 4 writes
+  EXPECT_CALL(*client, writeImp(_, _))
+      .Times(4)
+      .WillRepeatedly(Invoke([&](const uint8_t *, size_t size) {
+        EXPECT_LE(size, SUPLA_SRPC_VALUE_BATCH_BUFFER_SIZE);
+        bytesWritten += size;
+        return size;
+      }));
+
+  int8_t value[SUPLA_CHANNELVALUE_SIZE] = {};
+  for (int i = 0; i < channelCount; i++) {
+    layer.sendChannelValueChanged(i, value, 0, 0);
+  }
+  layer.flushValueBatch();
+
+  EXPECT_EQ(bytesWritten, channelCount * (packetSize + tagSize));
+  auto stats = layer.getValueBatchStats();
+  EXPECT_EQ(stats.sent, channelCount);
+  EXPECT_EQ(stats.socketWrites, 4);
+  EXPECT_EQ(stats.flushes, 1);
+}
+
+TEST_F(SuplaSrpcValueBatchTests, DisconnectDropsBatchedValues) {
+  int8_t value[SUPLA_CHANNELVALUE_SIZE] = {};
+  EXPECT_CALL(srpcMock, valueChanged(_, _, _, _, _)).Times(0);
+
+  layer.sendChannelValueChanged(5, value, 0, 0);
+  layer.setDisconnected();
+  layer.flushValueBatch();
+
+  // after reconnection batch is empty
+  layer.setRegisteredAndReady(&dummySrpc);
+  layer.flushValueBatch();
+  EXPECT_EQ(layer.getValueBatchStats().sent, 0);
+}
+
+TEST_F(SuplaSrpcValueBatchTests, ChannelOutOfBatchRangeIsSentImmediately) {
+  int8_t value[SUPLA_CHANNELVALUE_SIZE] = {};
+  EXPECT_CALL(srpcMock, valueChanged(_, 200, _, 0, 0));
+
+  layer.sendChannelValueChanged(200, value, 0, 0);
+  EXPECT_EQ(layer.getValueBatchStats().queued, 0);
+}
+
+TEST_F(SuplaSrpcValueBatchTests, DisablingBatchingFlushesValues) {
+  int8_t value[SUPLA_CHANNELVALUE_SIZE] = {};
+  EXPECT_CALL(srpcMock, valueChanged(_, 7, _, 0, 0)).Times(2);
+
+  layer.sendChannelValueChanged(7, value, 0, 0);
+  layer.setValueBatching(false);
+  EXPECT_FALSE(layer.isValueBatchingEnabled());
+
+  // without batching value is sent immediately
+  layer.sendChannelValueChanged(7, value, 0, 0);
+}
+
+TEST_F(SuplaSrpcValueBatchTests, StoredValueIsSentBeforeOtherChannelMessages) {
+  std::vector<char> value1 = {1, 0, 0, 0, 0, 0, 0, 0};
+  std::vector<char> value2 = {2, 0, 0, 0, 0, 0, 0, 0};
+  std::vector<char> value3 = {3, 0, 0, 0, 0, 0, 0, 0};
+  TSuplaChannelExtendedValue extValue = {};
+
+  {
+    InSequence seq;
+    EXPECT_CALL(srpcMock, valueChanged(_, 2, ElementsAreArray(value2), 0, 0));
+    EXPECT_CALL(srpcMock, extendedValueChanged(2, &extValue));
+    EXPECT_CALL(srpcMock, valueChanged(_, 4, ElementsAreArray(value3), 0, 0));
+    EXPECT_CALL(srpcMock, actionTrigger(4, 1));
+    EXPECT_CALL(srpcMock, actionTrigger(3, 1));
+    EXPECT_CALL(srpcMock, valueChanged(_, 1, ElementsAreArray(value1), 0, 0));
+  }
+
+  layer.sendChannelValueChanged(
+      1, reinterpret_cast<int8_t *>(value1.data()), 0, 0);
+  layer.sendChannelValueChanged(
+      2, reinterpret_cast<int8_t *>(value2.data()), 0, 0);
+  layer.sendChannelValueChanged(
+      4, reinterpret_cast<int8_t *>(value3.data()), 0, 0);
+  layer.sendExtendedChannelValueChanged(2, &extValue);
+  layer.sendActionTrigger(4, 1);
+  // channel without stored value doesn't affect the batch
+  layer.sendActionTrigger(3, 1);
+  layer.flushValueBatch();
+
+  auto stats = layer.getValueBatchStats();
+  EXPECT_EQ(stats.sent, 3);
+  EXPECT_EQ(stats.flushes, 1);
+}
@@ -0,0 +1,153 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include <gtest/gtest.h>
+#include <supla/tools.h>
+
+#include <gtest/gtest.h>
+#include <supla/crc16.h>
+#include <supla/crc8.h>
+#include <supla/crc_tables.h>
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> randomData(int size, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::vector<uint8_t> data(size);
+  for (auto &byte : data) {
+    byte = static_cast<uint8_t>(generator());
+  }
+  return data;
+}
+
+// Returns average time in ns of calculation over buffer
+int64_t measureNs(const std::function<int()> &calculate) {
+  constexpr int Rounds = 200;
+  volatile int sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < Rounds; i++) {
+    sink = sink + calculate();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+             .count() /
+         Rounds;
+}
+
+}  // namespace
+
+TEST(CrcTests, crc16KnownValues) {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  // CRC-16/MODBUS check value
+  EXPECT_EQ(calculateCrc16(check, sizeof(check)), 0x4B37);
+  EXPECT_EQ(calculateCrc16(check, 0), 0xFFFF);
+  EXPECT_EQ(calculateCrc16(nullptr, 5), 0);
+
+  uint16_t crc = 0xFFFF;
+  for (auto byte : check) {
+    crc = crc16_update(crc, byte);
+  }
+  EXPECT_EQ(crc, 0x4B37);
+  EXPECT_EQ(crc16_update(0xFFFF, check, sizeof(check)), 0x4B37);
+}
+
+TEST(CrcTests, crc8KnownValues) {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  // CRC-8/SMBUS check value
+  EXPECT_EQ(crc8(check, sizeof(check)), 0xF4);
+  EXPECT_EQ(crc8(check, 0), 0);
+}
+
+TEST(CrcTests, tablesMatchBitwiseCalculation) {
+  using Supla::Crc::CrcTables;
+  for (int n = 0; n < 256; n++) {
+    uint8_t byte = n;
+    EXPECT_EQ(CrcTables::crc16[n], Supla::Crc::crc16Bitwise(0, &byte, 1));
+    EXPECT_EQ(CrcTables::crc8[n], Supla::Crc::crc8Bitwise(0, &byte, 1));
+    uint8_t bytes[8] = {byte};
+    for (int slice = 1; slice < 8; slice++) {
+      EXPECT_EQ(CrcTables::crc16Slices[slice - 1][n],
+                Supla::Crc::crc16Bitwise(0, bytes, slice + 1));
+      EXPECT_EQ(CrcTables::crc8Slices[slice - 1][n],
+                Supla::Crc::crc8Bitwise(0, bytes, slice + 1));
+    }
+  }
+}
+
+TEST(CrcTests, implementationsAreBitExact) {
+  auto data = randomData(4096 + 7, 1234);
+  // all lengths up to 64 and unaligned start cover slice-by-8 tail handling
+  for (int offset = 0; offset < 8; offset++) {
+    for (int size = 0; size <= 64; size++) {
+      const uint8_t *ptr = data.data() + offset;
+      for (uint16_t init : {0x0000, 0xFFFF, 0x1D0F}) {
+        auto expected = Supla::Crc::crc16Bitwise(init, ptr, size);
+        ASSERT_EQ(Supla::Crc::crc16Table(init, ptr, size), expected);
+        ASSERT_EQ(Supla::Crc::crc16SliceBy8(init, ptr, size), expected);
+      }
+      for (uint8_t init : {0x00, 0xFF, 0x5A}) {
+        auto expected = Supla::Crc::crc8Bitwise(init, ptr, size);
+        ASSERT_EQ(Supla::Crc::crc8Table(init, ptr, size), expected);
+        ASSERT_EQ(Supla::Crc::crc8SliceBy8(init, ptr, size), expected);
+      }
+    }
+  }
+
+  for (unsigned seed = 0; seed < 20; seed++) {
+    auto buffer = randomData(4096, seed);
+    auto expected16 = Supla::Crc::crc16Bitwise(0xFFFF, buffer.data(), 4096);
+    EXPECT_EQ(Supla::Crc::crc16Table(0xFFFF, buffer.data(), 4096), expected16);
+    EXPECT_EQ(Supla::Crc::crc16SliceBy8(0xFFFF, buffer.data(), 4096),
+              expected16);
+    EXPECT_EQ(calculateCrc16(buffer.data(), 4096), expected16);
+
+    auto expected8 = Supla::Crc::crc8Bitwise(0, buffer.data(), 4096);
+    EXPECT_EQ(Supla::Crc::crc8Table(0, buffer.data(), 4096), expected8);
+    EXPECT_EQ(Supla::Crc::crc8SliceBy8(0, buffer.data(), 4096), expected8);
+    EXPECT_EQ(crc8(buffer.data(), 4096), expected8);
+  }
+}
+
+TEST(CrcTests, benchmark4KiB) {
+  auto buffer = randomData(4096, 42);
+  const uint8_t *data = buffer.data();
+  const int size = buffer.size();
+
+  RecordProperty("crc16BitwiseNs", std::to_string(measureNs([&]() {
+    return Supla::Crc::crc16Bitwise(0xFFFF, data, size);
+  })));
+  RecordProperty("crc16TableNs", std::to_string(measureNs([&]() {
+    return Supla::Crc::crc16Table(0xFFFF, data, size);
+  })));
+  RecordProperty("crc16SliceBy8Ns", std::to_string(measureNs([&]() {
+    return Supla::Crc::crc16SliceBy8(0xFFFF, data, size);
+  })));
+  RecordProperty("crc8BitwiseNs", std::to_string(measureNs([&]() {
+    return Supla::Crc::crc8Bitwise(0, data, size);
+  })));
+  RecordProperty("crc8TableNs", std::to_string(measureNs([&]() {
+    return Supla::Crc::crc8Table(0, data, size);
+  })));
+  RecordProperty("crc8SliceBy8Ns", std::to_string(measureNs([&]() {
+    return Supla::Crc::crc8SliceBy8(0, data, size);
+  })));
+}
@@ -19,8 +19,11 @@
 #include "srpc_mock.h"
 
 _supla_int_t srpc_ds_async_channel_extendedvalue_changed(
-    void *, unsigned char, TSuplaChannelExtendedValue *) {
-  return 0;
+    void *, unsigned char channelNumber, TSuplaChannelExtendedValue *value) {
+  if (SrpcInterface::instance == nullptr) {
+    return 0;
+  }
+  return SrpcInterface::instance->extendedValueChanged(channelNumber, value);
 }
 
 _supla_int_t srpc_ds_async_action_trigger(void *, TDS_ActionTrigger *at) {
@@ -38,6 +38,9 @@ class SrpcInterface {
   virtual _supla_int_t actionTrigger(unsigned char channel_number,
                                      int actionTrigger) = 0;
 
+  virtual _supla_int_t extendedValueChanged(
+      unsigned char channelNumber, TSuplaChannelExtendedValue *value) = 0;
+
   virtual _supla_int_t srpc_dcs_async_set_activity_timeout(
       void *_srpc, TDCS_SuplaSetActivityTimeout *dcs_set_activity_timeout) = 0;
   virtual void srpc_params_init(TsrpcParams *params) = 0;
@@ -153,6 +156,10 @@ class SrpcMock : public SrpcInterface {
               actionTrigger,
               (unsigned char channel_number, int actionTrigger),
               (override));
+  MOCK_METHOD(_supla_int_t,
+              extendedValueChanged,
+              (unsigned char, TSuplaChannelExtendedValue *),
+              (override));
   MOCK_METHOD(_supla_int_t,
               getChannelConfig,
               (unsigned char channelNumber, unsigned char configType),
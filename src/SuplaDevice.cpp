@@ -544,25 +544,7 @@ void SuplaDeviceClass::iterate(void) {
         delay(0);
       }
       if (iterateConnected) {
-        // Iterate all elements
-        // Iterate connected exits loop when method returns false, which means
-        // that element send message to server. In next iteration we'll start
-        // with next element instead of first one on the list.
-        if (Supla::Element::IsInvalidPtrSet()) {
-          iterateConnectedPtr = nullptr;
-          Supla::Element::ClearInvalidPtr();
-        }
-        if (iterateConnectedPtr == nullptr) {
-          iterateConnectedPtr = Supla::Element::begin();
-        }
-        for (; iterateConnectedPtr != nullptr;
-             iterateConnectedPtr = iterateConnectedPtr->next()) {
-          if (!iterateConnectedPtr->iterateConnected()) {
-            iterateConnectedPtr = iterateConnectedPtr->next();
-            break;
-          }
-          delay(0);
-        }
+        iterateConnectedElements();
         // check SW update availability
         if (swUpdate == nullptr && isAutomaticFirmwareUpdateEnabled()) {
           if (millis() - lastSwUpdateCheckTimestamp >
@@ -1799,6 +1781,80 @@ void SuplaDeviceClass::setShowUptimeInChannelState(bool value) {
   showUptimeInChannelState = value;
 }
 
+bool SuplaDeviceClass::iterateConnectedPendingChannels() {
+  // Only owners of channels with pending update are iterated. Polled elements
+  // are handled in iterateConnectedPolledElements()
+  auto last = Supla::Channel::PendingUpdateLast();
+  auto channel = Supla::Channel::PendingUpdateBegin();
+  while (channel != nullptr) {
+    auto next = channel->nextPendingUpdate();
+    bool isLast = (channel == last);
+    auto element =
+        Supla::Element::GetOwnerOfChannelNumber(channel->getChannelNumber());
+    if (element != nullptr && !element->isIterateConnectedPolled() &&
+        !element->iterateConnected() &&
+        iterateConnectedPolicy ==
+            Supla::IterateConnectedPolicy::OneElementUpdatePerIteration) {
+      // channel may still be queued (i.e. only secondary channel was send),
+      // so give other channels a chance in next iteration
+      channel->movePendingUpdateToEnd();
+      return false;
+    }
+    if (isLast) {
+      break;
+    }
+    channel = next;
+    delay(0);
+  }
+  return true;
+}
+
+bool SuplaDeviceClass::iterateConnectedPolledElements() {
+  // Iterate connected exits loop when method returns false, which means
+  // that element send message to server. In next iteration we'll start
+  // with next element instead of first one on the list.
+  if (iterateConnectedPtr == nullptr ||
+      !iterateConnectedPtr->isIterateConnectedPolled()) {
+    iterateConnectedPtr = Supla::Element::PollingBegin();
+  }
+  while (iterateConnectedPtr != nullptr) {
+    auto element = iterateConnectedPtr;
+    iterateConnectedPtr = element->nextPolling();
+    if (!element->iterateConnected() &&
+        iterateConnectedPolicy ==
+            Supla::IterateConnectedPolicy::OneElementUpdatePerIteration) {
+      return false;
+    }
+    delay(0);
+  }
+  return true;
+}
+
+void SuplaDeviceClass::iterateConnectedElements() {
+  if (Supla::Element::IsInvalidPtrSet()) {
+    iterateConnectedPtr = nullptr;
+    Supla::Element::ClearInvalidPtr();
+  }
+  // Order of pending channels and polled elements is swapped in each
+  // iteration, so with OneElementUpdatePerIteration policy none of them
+  // can starve the other one
+  iterateConnectedQueueFirst = !iterateConnectedQueueFirst;
+  if (iterateConnectedQueueFirst) {
+    if (iterateConnectedPendingChannels()) {
+      iterateConnectedPolledElements();
+    }
+  } else {
+    if (iterateConnectedPolledElements()) {
+      iterateConnectedPendingChannels();
+    }
+  }
+}
+
+void SuplaDeviceClass::setIterateConnectedPolicy(
+    Supla::IterateConnectedPolicy policy) {
+  iterateConnectedPolicy = policy;
+}
+
 void SuplaDeviceClass::setProtoVerboseLog(bool value) {
   createSrpcLayerIfNeeded();
   if (srpcLayer) {
@@ -111,6 +111,21 @@ enum class InitialMode : uint8_t {
   StartInNotConfiguredMode = 3
 };
 
+/**
+ * @enum IterateConnectedPolicy
+ */
+enum class IterateConnectedPolicy : uint8_t {
+  /** Element's iteration (iterateConnected) ends on first element which
+   *  communicated with server. Next SuplaDevice iteration continues with the
+   *  following element (default).
+   */
+  OneElementUpdatePerIteration = 0,
+  /** All elements are iterated in each SuplaDevice iteration, so each
+   *  element can send its update in the same iteration.
+   */
+  AllElementsPerIteration = 1,
+};
+
 enum class CfgModeState : uint8_t {
   NotSet = 0,
   CfgModeStartedFor1hPending = 1,
@@ -329,6 +344,13 @@ class SuplaDeviceClass : public Supla::ActionHandler,
    */
   void setPermanentWebInterface(bool value = true);
 
+  /**
+   * Sets how elements are iterated when device is connected to the server.
+   *
+   * @param policy see Supla::IterateConnectedPolicy
+   */
+  void setIterateConnectedPolicy(Supla::IterateConnectedPolicy policy);
+
   Supla::Mutex *getTimerAccessMutex();
 
   void setChannelConflictResolver(
@@ -460,6 +482,14 @@ class SuplaDeviceClass : public Supla::ActionHandler,
   bool initSwUpdateInstance(Supla::SwUpdateMode mode, int securityOnly = -1);
 
   void iterateAlwaysElements(uint32_t _millis);
+  /**
+   * Calls iterateConnected() on owners of channels with pending update and
+   * on elements which require polling (see Supla::Element).
+   */
+  void iterateConnectedElements();
+  // returns false when iteration was stopped due to iterateConnectedPolicy
+  bool iterateConnectedPendingChannels();
+  bool iterateConnectedPolledElements();
   bool iterateNetworkSetup();
   bool iterateSuplaProtocol(uint32_t _millis);
   void handleLocalActionTriggers();
@@ -493,6 +523,7 @@ class SuplaDeviceClass : public Supla::ActionHandler,
   // true even if initialization procedure failed for some reason
   bool initializationDone = false;
   bool goToConfigModeAsap = false;
+  bool iterateConnectedQueueFirst = false;
 
   // used for permanent web server
   bool startPermanentWebInterface = false;
@@ -504,6 +535,8 @@ class SuplaDeviceClass : public Supla::ActionHandler,
   uint8_t swUpdateAttempts = 0;
 
   Supla::InitialMode initialMode = Supla::InitialMode::StartInNotConfiguredMode;
+  Supla::IterateConnectedPolicy iterateConnectedPolicy =
+      Supla::IterateConnectedPolicy::OneElementUpdatePerIteration;
   Supla::CfgModeState cfgModeState = Supla::CfgModeState::NotSet;
   Supla::ConfigurationState configurationState = {};
 
@@ -60,12 +60,25 @@
 #define BUFFER_MAX_SIZE 131072
 #endif /*BUFFER_MAX_SIZE*/
 
+#ifdef SPROTO_IN_RING_BUFFER
+#ifndef SPROTO_IN_RING_BUFFER_SIZE
+#define SPROTO_IN_RING_BUFFER_SIZE BUFFER_MAX_SIZE
+#endif /*SPROTO_IN_RING_BUFFER_SIZE*/
+
+_Static_assert(SPROTO_IN_RING_BUFFER_SIZE >=
+                   sizeof(TSuplaDataPacket) + SUPLA_TAG_SIZE,
+               "SPROTO_IN_RING_BUFFER_SIZE is too small for max packet size");
+#endif /*SPROTO_IN_RING_BUFFER*/
+
 char sproto_tag[SUPLA_TAG_SIZE] = {'S', 'U', 'P', 'L', 'A'};
 
 typedef struct {
   unsigned char begin_tag;
   unsigned _supla_int_t size;
   unsigned _supla_int_t data_size;
+#ifdef SPROTO_IN_RING_BUFFER
+  unsigned _supla_int_t head;
+#endif /*SPROTO_IN_RING_BUFFER*/
 
   char *buffer;
 } TSuplaProtoInBuffer;
@@ -93,6 +106,14 @@ void *sproto_init(void) {
   if (spd) {
     memset(spd, 0, sizeof(TSuplaProtoData));
     spd->version = SUPLA_PROTO_VERSION;
+#ifdef SPROTO_IN_RING_BUFFER
+    spd->in.buffer = malloc(SPROTO_IN_RING_BUFFER_SIZE);
+    if (spd->in.buffer == NULL) {
+      free(spd);
+      return (NULL);
+    }
+    spd->in.size = SPROTO_IN_RING_BUFFER_SIZE;
+#endif /*SPROTO_IN_RING_BUFFER*/
     return (spd);
   }
 
@@ -154,8 +175,27 @@ unsigned char PROTO_ICACHE_FLASH sproto_buffer_append(
 char PROTO_ICACHE_FLASH sproto_in_buffer_append(
     void *spd_ptr, char *data, unsigned _supla_int_t data_size) {
   TSuplaProtoData *spd = (TSuplaProtoData *)spd_ptr;
+#ifdef SPROTO_IN_RING_BUFFER
+  TSuplaProtoInBuffer *in = &spd->in;
+  unsigned _supla_int_t tail;
+  unsigned _supla_int_t first;
+
+  if (data_size > in->size - in->data_size)
+    return (SUPLA_RESULT_BUFFER_OVERFLOW);
+
+  tail = (in->head + in->data_size) % in->size;
+  first = in->size - tail;
+  if (first > data_size) first = data_size;
+
+  memcpy(&in->buffer[tail], data, first);
+  if (data_size > first) memcpy(in->buffer, &data[first], data_size - first);
+
+  in->data_size += data_size;
+  return (SUPLA_RESULT_TRUE);
+#else
   return sproto_buffer_append(spd_ptr, &spd->in.buffer, &spd->in.size,
                               &spd->in.data_size, data, data_size);
+#endif /*SPROTO_IN_RING_BUFFER*/
 }
 
 #ifndef SPROTO_WITHOUT_OUT_BUFFER
@@ -239,20 +279,17 @@ char PROTO_ICACHE_FLASH sproto_in_dataexists(void *spd_ptr) {
 
 void PROTO_ICACHE_FLASH sproto_shrink_in_buffer(TSuplaProtoInBuffer *in,
                                                 unsigned _supla_int_t size) {
-  unsigned _supla_int_t old_size = in->size;
-  unsigned _supla_int_t a, b;
-
   in->begin_tag = 0;
 
   if (size > in->data_size) size = in->data_size;
 
-  b = 0;
-
-  for (a = size; a < in->data_size; a++) {
-    in->buffer[b] = in->buffer[a];
-    b++;
-  }
+#ifdef SPROTO_IN_RING_BUFFER
+  in->data_size -= size;
+  in->head = in->data_size == 0 ? 0 : (in->head + size) % in->size;
+#else
+  unsigned _supla_int_t old_size = in->size;
 
+  memmove(in->buffer, &in->buffer[size], in->data_size - size);
   in->data_size -= size;
 
   if (in->data_size < in->size) {
@@ -270,17 +307,63 @@ void PROTO_ICACHE_FLASH sproto_shrink_in_buffer(TSuplaProtoInBuffer *in,
       }
     }
   }
+#endif /*SPROTO_IN_RING_BUFFER*/
+}
+
+// Copies "size" bytes starting at "offset" of received data
+static void PROTO_ICACHE_FLASH sproto_in_buffer_copy(
+    TSuplaProtoInBuffer *in, unsigned _supla_int_t offset, char *dest,
+    unsigned _supla_int_t size) {
+#ifdef SPROTO_IN_RING_BUFFER
+  unsigned _supla_int_t pos = (in->head + offset) % in->size;
+  unsigned _supla_int_t first = in->size - pos;
+
+  if (first > size) first = size;
+
+  memcpy(dest, &in->buffer[pos], first);
+  if (size > first) memcpy(&dest[first], in->buffer, size - first);
+#else
+  memcpy(dest, &in->buffer[offset], size);
+#endif /*SPROTO_IN_RING_BUFFER*/
+}
+
+// Returns pointer to "size" bytes starting at "offset" of received data.
+// Data is accessed in place, unless it wraps around the end of ring buffer.
+// Then it is copied to "scratch".
+static const char *PROTO_ICACHE_FLASH sproto_in_buffer_view(
+    TSuplaProtoInBuffer *in, unsigned _supla_int_t offset,
+    unsigned _supla_int_t size, char *scratch) {
+#ifdef SPROTO_IN_RING_BUFFER
+  unsigned _supla_int_t pos = (in->head + offset) % in->size;
+
+  if (pos + size <= in->size) return &in->buffer[pos];
+
+  sproto_in_buffer_copy(in, offset, scratch, size);
+  return scratch;
+#else
+  (void)(size);
+  (void)(scratch);
+  return &in->buffer[offset];
+#endif /*SPROTO_IN_RING_BUFFER*/
+}
+
+static char PROTO_ICACHE_FLASH sproto_in_buffer_tag_at(
+    TSuplaProtoInBuffer *in, unsigned _supla_int_t offset) {
+  char tag[SUPLA_TAG_SIZE];
+  return memcmp(sproto_in_buffer_view(in, offset, SUPLA_TAG_SIZE, tag),
+                sproto_tag, SUPLA_TAG_SIZE) == 0;
 }
 
 char PROTO_ICACHE_FLASH sproto_pop_in_sdp(void *spd_ptr,
                                           TSuplaDataPacket *sdp) {
   unsigned _supla_int_t header_size;
-  TSuplaDataPacket *_sdp;
+  unsigned _supla_int_t packet_size;
+  const TSuplaDataPacket *_sdp;
 
   TSuplaProtoData *spd = (TSuplaProtoData *)spd_ptr;
 
   if (spd->in.begin_tag == 0 && spd->in.data_size >= SUPLA_TAG_SIZE) {
-    if (memcmp(spd->in.buffer, sproto_tag, SUPLA_TAG_SIZE) == 0) {
+    if (sproto_in_buffer_tag_at(&spd->in, 0)) {
       spd->in.begin_tag = 1;
     } else {
       sproto_shrink_in_buffer(&spd->in, spd->in.data_size);
@@ -291,7 +374,9 @@ char PROTO_ICACHE_FLASH sproto_pop_in_sdp(void *spd_ptr,
   if (spd->in.begin_tag == 1) {
     header_size = sizeof(TSuplaDataPacket) - SUPLA_MAX_DATA_SIZE;
     if ((spd->in.data_size - SUPLA_TAG_SIZE) >= header_size) {
-      _sdp = (TSuplaDataPacket *)spd->in.buffer;
+      // sdp is used as scratch only if header wraps around the ring buffer
+      _sdp = (const TSuplaDataPacket *)sproto_in_buffer_view(
+          &spd->in, 0, header_size, (char *)sdp);
 
       if (_sdp->version > SUPLA_PROTO_VERSION ||
           _sdp->version < SUPLA_PROTO_VERSION_MIN) {
@@ -306,20 +391,20 @@ char PROTO_ICACHE_FLASH sproto_pop_in_sdp(void *spd_ptr,
         return SUPLA_RESULT_DATA_ERROR;
       }
 
-      if ((header_size + _sdp->data_size + SUPLA_TAG_SIZE) > spd->in.data_size)
+      packet_size = header_size + _sdp->data_size;
+
+      if ((packet_size + SUPLA_TAG_SIZE) > spd->in.data_size)
         return SUPLA_RESULT_FALSE;
 
-      if (header_size + _sdp->data_size >= spd->in.size ||
-          memcmp(&spd->in.buffer[header_size + _sdp->data_size], sproto_tag,
-                 SUPLA_TAG_SIZE) != 0) {
+      if (packet_size >= spd->in.size ||
+          !sproto_in_buffer_tag_at(&spd->in, packet_size)) {
         sproto_shrink_in_buffer(&spd->in, spd->in.data_size);
 
         return SUPLA_RESULT_DATA_ERROR;
       }
 
-      memcpy(sdp, spd->in.buffer, header_size + _sdp->data_size);
-      sproto_shrink_in_buffer(&spd->in,
-                              header_size + _sdp->data_size + SUPLA_TAG_SIZE);
+      sproto_in_buffer_copy(&spd->in, 0, (char *)sdp, packet_size);
+      sproto_shrink_in_buffer(&spd->in, packet_size + SUPLA_TAG_SIZE);
 
       return (SUPLA_RESULT_TRUE);
     }
@@ -414,8 +499,13 @@ void PROTO_ICACHE_FLASH sproto_buffer_dump(void *spd_ptr, unsigned char in) {
 #endif /*SPROTO_WITHOUT_OUT_BUFFER*/
   }
 
-  for (a = 0; a < size; a++)
-    supla_log(LOG_DEBUG, "%c [%i]", buffer[a], buffer[a]);
+  for (a = 0; a < size; a++) {
+    _supla_int_t idx = a;
+#ifdef SPROTO_IN_RING_BUFFER
+    if (in != 0) idx = (spd->in.head + a) % spd->in.size;
+#endif /*SPROTO_IN_RING_BUFFER*/
+    supla_log(LOG_DEBUG, "%c [%i]", buffer[idx], buffer[idx]);
+  }
 }
 
 void PROTO_ICACHE_FLASH sproto_set_null_terminated_string(
@@ -105,6 +105,11 @@ struct _supla_timeval {
 #define PROTO_ICACHE_FLASH
 #endif /*PROTO_ICACHE_FLASH*/
 
+// SPROTO_IN_RING_BUFFER may be defined (i.e. in compiler flags) for any
+// target. Received data is then kept in a fixed size ring buffer
+// (SPROTO_IN_RING_BUFFER_SIZE bytes, allocated once in sproto_init) instead
+// of a buffer which is shifted and reallocated after each popped packet.
+
 #ifdef __cplusplus
 extern "C" {
 #endif
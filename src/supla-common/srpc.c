@@ -80,11 +80,19 @@
 #define SRPC_QUEUE_MIN_ALLOC_COUNT 0
 #endif /*SRPC_QUEUE_MIN_ALLOC_COUNT*/
 
+// Queue items are taken from a pool of SRPC_QUEUE_SIZE packets, which is
+// allocated with single malloc on first push and released in srpc_free.
+// Define SRPC_QUEUE_WITHOUT_POOL to allocate each item separately (items
+// above SRPC_QUEUE_MIN_ALLOC_COUNT are then released on pop).
 typedef struct {
   unsigned char item_count;
   unsigned char alloc_count;
 
   TSuplaDataPacket *item[SRPC_QUEUE_SIZE];
+#ifndef SRPC_QUEUE_WITHOUT_POOL
+  TSuplaDataPacket *pool;
+#endif /*SRPC_QUEUE_WITHOUT_POOL*/
+  TsrpcQueueStats stats;
 } Tsrpc_Queue;
 
 typedef struct {
@@ -99,6 +107,9 @@ typedef struct {
 
 #ifndef SRPC_WITHOUT_OUT_QUEUE
   Tsrpc_Queue out_queue;
+#elif !defined(PACKET_INTEGRITY_BUFFER_DISABLED)
+  // packet with end tag, allocated on first use
+  char *out_packet_buffer;
 #endif /*SRPC_WITHOUT_OUT_QUEUE*/
 
   void *lck;
@@ -148,12 +159,23 @@ void SRPC_ICACHE_FLASH srpc_unlock(void *_srpc) {
 }
 
 void SRPC_ICACHE_FLASH srpc_queue_free(Tsrpc_Queue *queue) {
+#ifdef SRPC_QUEUE_WITHOUT_POOL
   _supla_int_t a;
   for (a = 0; a < SRPC_QUEUE_SIZE; a++) {
     if (queue->item[a] != NULL) {
       free(queue->item[a]);
+      queue->item[a] = NULL;
+      queue->stats.free_count++;
     }
   }
+#else
+  if (queue->pool != NULL) {
+    free(queue->pool);
+    queue->pool = NULL;
+    queue->stats.free_count++;
+  }
+  memset(queue->item, 0, sizeof(queue->item));
+#endif /*SRPC_QUEUE_WITHOUT_POOL*/
 
   queue->item_count = 0;
   queue->alloc_count = 0;
@@ -171,6 +193,8 @@ void SRPC_ICACHE_FLASH srpc_free(void *_srpc) {
 
 #ifndef SRPC_WITHOUT_OUT_QUEUE
     srpc_queue_free(&srpc->out_queue);
+#elif !defined(PACKET_INTEGRITY_BUFFER_DISABLED)
+    if (srpc->out_packet_buffer) free(srpc->out_packet_buffer);
 #endif /*SRPC_WITHOUT_OUT_QUEUE*/
     lck_free(srpc->lck);
 
@@ -178,26 +202,59 @@ void SRPC_ICACHE_FLASH srpc_free(void *_srpc) {
   }
 }
 
+// Returns number of bytes used by packet (header and data)
+static unsigned _supla_int_t SRPC_ICACHE_FLASH
+srpc_sdp_size(const TSuplaDataPacket *sdp) {
+  if (sdp->data_size > SUPLA_MAX_DATA_SIZE) {
+    return sizeof(TSuplaDataPacket);
+  }
+  return sizeof(TSuplaDataPacket) - SUPLA_MAX_DATA_SIZE + sdp->data_size;
+}
+
 char SRPC_ICACHE_FLASH srpc_queue_push(Tsrpc_Queue *queue,
                                        TSuplaDataPacket *sdp) {
   if (queue->item_count >= SRPC_QUEUE_SIZE) {
+    queue->stats.push_fail_count++;
     return SUPLA_RESULT_FALSE;
   }
 
+#ifdef SRPC_QUEUE_WITHOUT_POOL
   if (queue->item[queue->item_count] == NULL) {
     queue->item[queue->item_count] =
         (TSuplaDataPacket *)malloc(sizeof(TSuplaDataPacket));
+    if (queue->item[queue->item_count] != NULL) {
+      queue->alloc_count++;
+      queue->stats.malloc_count++;
+    }
+  }
+#else
+  if (queue->pool == NULL) {
+    _supla_int_t a;
+    queue->pool =
+        (TSuplaDataPacket *)malloc(SRPC_QUEUE_SIZE * sizeof(TSuplaDataPacket));
+    if (queue->pool != NULL) {
+      for (a = 0; a < SRPC_QUEUE_SIZE; a++) {
+        queue->item[a] = &queue->pool[a];
+      }
+      queue->alloc_count = SRPC_QUEUE_SIZE;
+      queue->stats.malloc_count++;
+    }
   }
+#endif /*SRPC_QUEUE_WITHOUT_POOL*/
 
   if (queue->item[queue->item_count] == NULL) {
+    queue->stats.push_fail_count++;
     return SUPLA_RESULT_FALSE;
-  } else {
-    queue->alloc_count++;
   }
 
-  memcpy(queue->item[queue->item_count], sdp, sizeof(TSuplaDataPacket));
+  memcpy(queue->item[queue->item_count], sdp, srpc_sdp_size(sdp));
   queue->item_count++;
 
+  queue->stats.push_count++;
+  if (queue->item_count > queue->stats.max_item_count) {
+    queue->stats.max_item_count = queue->item_count;
+  }
+
   return SUPLA_RESULT_TRUE;
 }
 
@@ -207,13 +264,17 @@ char SRPC_ICACHE_FLASH srpc_queue_pop(Tsrpc_Queue *queue, TSuplaDataPacket *sdp,
 
   for (a = 0; a < queue->item_count; a++)
     if (rr_id == 0 || queue->item[a]->rr_id == rr_id) {
-      memcpy(sdp, queue->item[a], sizeof(TSuplaDataPacket));
+      memcpy(sdp, queue->item[a], srpc_sdp_size(queue->item[a]));
+      queue->stats.pop_count++;
 
+#ifdef SRPC_QUEUE_WITHOUT_POOL
       if (queue->alloc_count > SRPC_QUEUE_MIN_ALLOC_COUNT) {
         queue->alloc_count--;
         free(queue->item[a]);
         queue->item[a] = NULL;
+        queue->stats.free_count++;
       }
+#endif /*SRPC_QUEUE_WITHOUT_POOL*/
 
       TSuplaDataPacket *item = queue->item[a];
 
@@ -255,14 +316,17 @@ char SRPC_ICACHE_FLASH srpc_out_queue_push(Tsrpc *srpc, TSuplaDataPacket *sdp) {
     data_size -= SUPLA_MAX_DATA_SIZE - sdp->data_size;
   }
 #ifndef PACKET_INTEGRITY_BUFFER_DISABLED
-  char *buff = malloc(data_size + SUPLA_TAG_SIZE);
+  if (srpc->out_packet_buffer == NULL) {
+    srpc->out_packet_buffer =
+        (char *)malloc(sizeof(TSuplaDataPacket) + SUPLA_TAG_SIZE);
+  }
+  char *buff = srpc->out_packet_buffer;
   if (buff) {
     memcpy(buff, sdp, data_size);
     memcpy(&buff[data_size], sproto_tag, SUPLA_TAG_SIZE);
 
     srpc->params.data_write(buff, data_size + SUPLA_TAG_SIZE,
                             srpc->params.user_params);
-    free(buff);
   }
 #else
   srpc->params.data_write((char *)sdp, data_size, srpc->params.user_params);
@@ -290,6 +354,28 @@ unsigned char SRPC_ICACHE_FLASH srpc_out_queue_item_count(void *srpc) {
 #endif /*SRPC_WITHOUT_OUT_QUEUE*/
 }
 
+void SRPC_ICACHE_FLASH srpc_get_queue_stats(void *_srpc,
+                                             TsrpcQueueStats *in_stats,
+                                             TsrpcQueueStats *out_stats) {
+  Tsrpc *srpc = (Tsrpc *)_srpc;
+  lck_lock(srpc->lck);
+  if (in_stats) {
+#ifdef SRPC_WITHOUT_IN_QUEUE
+    memset(in_stats, 0, sizeof(TsrpcQueueStats));
+#else
+    memcpy(in_stats, &srpc->in_queue.stats, sizeof(TsrpcQueueStats));
+#endif /*SRPC_WITHOUT_IN_QUEUE*/
+  }
+  if (out_stats) {
+#ifdef SRPC_WITHOUT_OUT_QUEUE
+    memset(out_stats, 0, sizeof(TsrpcQueueStats));
+#else
+    memcpy(out_stats, &srpc->out_queue.stats, sizeof(TsrpcQueueStats));
+#endif /*SRPC_WITHOUT_OUT_QUEUE*/
+  }
+  lck_unlock(srpc->lck);
+}
+
 char SRPC_ICACHE_FLASH srpc_input_dataexists(void *_srpc) {
   int result = SUPLA_RESULT_FALSE;
   Tsrpc *srpc = (Tsrpc *)_srpc;
@@ -89,6 +89,15 @@ typedef struct {
   void *user_params;
 } TsrpcParams;
 
+typedef struct {
+  unsigned _supla_int_t push_count;
+  unsigned _supla_int_t push_fail_count;
+  unsigned _supla_int_t pop_count;
+  unsigned _supla_int_t malloc_count;
+  unsigned _supla_int_t free_count;
+  unsigned char max_item_count;
+} TsrpcQueueStats;
+
 union TsrpcDataPacketData {
   TDCS_SuplaPingServer *dcs_ping;
   TSDC_SuplaPingServerResult *sdc_ping_result;
@@ -213,6 +222,11 @@ void SRPC_ICACHE_FLASH srpc_unlock(void *_srpc);
 char SRPC_ICACHE_FLASH srpc_input_dataexists(void *_srpc);
 char SRPC_ICACHE_FLASH srpc_output_dataexists(void *_srpc);
 unsigned char SRPC_ICACHE_FLASH srpc_out_queue_item_count(void *srpc);
+// Copies allocation statistics of in/out queues. Stats of a queue which is
+// disabled (SRPC_WITHOUT_IN_QUEUE, SRPC_WITHOUT_OUT_QUEUE) are zeroed.
+void SRPC_ICACHE_FLASH srpc_get_queue_stats(void *_srpc,
+                                             TsrpcQueueStats *in_stats,
+                                             TsrpcQueueStats *out_stats);
 
 char SRPC_ICACHE_FLASH srpc_iterate(void *_srpc);
 char SRPC_ICACHE_FLASH srpc_iterate_device(void *_srpc);
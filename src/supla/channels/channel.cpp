@@ -24,6 +24,7 @@
 #include <supla/correction.h>
 #include <math.h>
 #include <supla/device/register_device.h>
+#include <supla/intrusive_list.h>
 
 #include <string.h>
 
@@ -35,7 +36,22 @@
 using Supla::Channel;
 
 Channel *Channel::firstPtr = nullptr;
+Channel *Channel::lastPtr = nullptr;
+Channel *Channel::pendingFirstPtr = nullptr;
+Channel *Channel::pendingLastPtr = nullptr;
 int Channel::startingChannelNumber = 0;
+uint32_t Channel::numberingGeneration = 0;
+
+namespace {
+// Channel number -> Channel lookup table. Channels with numbers outside of
+// [0, SUPLA_CHANNELMAXCOUNT) range are not indexed and are searched on the
+// list instead.
+Channel *channelByNumber[SUPLA_CHANNELMAXCOUNT] = {};
+
+bool isIndexableChannelNumber(int channelNumber) {
+  return channelNumber >= 0 && channelNumber < SUPLA_CHANNELMAXCOUNT;
+}
+}  // namespace
 
 #ifdef SUPLA_TEST
 // Method used in tests to restore default values for static members
@@ -54,11 +70,8 @@ int Supla::Channel::getStartingChannelNumber() {
 }
 
 Channel::Channel(int number) {
-  if (firstPtr == nullptr) {
-    firstPtr = this;
-  } else {
-    Last()->nextPtr = this;
-  }
+  IntrusiveList<Channel, &Channel::nextPtr, &Channel::prevPtr>::append(
+      &firstPtr, &lastPtr, this);
 
   if (number == -1) {
     int nextFreeNumber = Supla::RegisterDevice::getNextFreeChannelNumber();
@@ -76,29 +89,26 @@ Channel::Channel(int number) {
   }
 
   channelNumber = number;
+  addToIndex();
+  loadCorrections();
   Supla::RegisterDevice::addChannel(number);
 
   setFlag(SUPLA_CHANNEL_FLAG_CHANNELSTATE);
 }
 
 Channel::~Channel() {
+  removeFromIndex();
+  numberingGeneration++;
   Supla::RegisterDevice::removeChannel(channelNumber);
   if (initialCaption != nullptr) {
     delete[] initialCaption;
     initialCaption = nullptr;
   }
 
-  if (Begin() == this) {
-    firstPtr = next();
-    return;
-  }
-
-  auto ptr = Begin();
-  while (ptr->next() != this) {
-    ptr = ptr->next();
-  }
-
-  ptr->nextPtr = ptr->next()->next();
+  changedFields = 0;
+  updatePendingQueue();
+  IntrusiveList<Channel, &Channel::nextPtr, &Channel::prevPtr>::remove(
+      &firstPtr, &lastPtr, this);
 }
 
 Channel *Channel::Begin() {
@@ -106,14 +116,14 @@ Channel *Channel::Begin() {
 }
 
 Channel *Channel::Last() {
-  Channel *ptr = firstPtr;
-  while (ptr && ptr->nextPtr) {
-    ptr = ptr->nextPtr;
-  }
-  return ptr;
+  return lastPtr;
 }
 
 Channel *Channel::GetByChannelNumber(int channelNumber) {
+  if (isIndexableChannelNumber(channelNumber)) {
+    return channelByNumber[channelNumber];
+  }
+
   Channel *ptr = firstPtr;
   while (ptr && ptr->channelNumber != channelNumber) {
     ptr = ptr->nextPtr;
@@ -125,6 +135,62 @@ Channel *Channel::next() {
   return nextPtr;
 }
 
+uint32_t Channel::GetNumberingGeneration() {
+  return numberingGeneration;
+}
+
+Channel *Channel::PendingUpdateBegin() {
+  return pendingFirstPtr;
+}
+
+Channel *Channel::PendingUpdateLast() {
+  return pendingLastPtr;
+}
+
+bool Channel::IsAnyUpdatePending() {
+  return pendingFirstPtr != nullptr;
+}
+
+Channel *Channel::nextPendingUpdate() {
+  return nextPendingPtr;
+}
+
+void Channel::movePendingUpdateToEnd() {
+  if (!pendingQueued || pendingLastPtr == this) {
+    return;
+  }
+  IntrusiveList<Channel, &Channel::nextPendingPtr, &Channel::prevPendingPtr>::
+      remove(&pendingFirstPtr, &pendingLastPtr, this);
+  IntrusiveList<Channel, &Channel::nextPendingPtr, &Channel::prevPendingPtr>::
+      append(&pendingFirstPtr, &pendingLastPtr, this);
+}
+
+void Channel::updatePendingQueue() {
+  if (changedFields != 0 && !pendingQueued) {
+    IntrusiveList<Channel, &Channel::nextPendingPtr, &Channel::prevPendingPtr>::
+        append(&pendingFirstPtr, &pendingLastPtr, this);
+    pendingQueued = true;
+  } else if (changedFields == 0 && pendingQueued) {
+    IntrusiveList<Channel, &Channel::nextPendingPtr, &Channel::prevPendingPtr>::
+        remove(&pendingFirstPtr, &pendingLastPtr, this);
+    pendingQueued = false;
+  }
+}
+
+void Channel::addToIndex() {
+  numberingGeneration++;
+  if (isIndexableChannelNumber(channelNumber)) {
+    channelByNumber[channelNumber] = this;
+  }
+}
+
+void Channel::removeFromIndex() {
+  if (isIndexableChannelNumber(channelNumber) &&
+      channelByNumber[channelNumber] == this) {
+    channelByNumber[channelNumber] = nullptr;
+  }
+}
+
 bool Channel::setChannelNumber(int newChannelNumber) {
   int oldChannelNumber = channelNumber;
 
@@ -134,6 +200,7 @@ bool Channel::setChannelNumber(int newChannelNumber) {
   if (newChannelNumber == oldChannelNumber) {
     return true;
   }
+  removeFromIndex();
   if (!Supla::RegisterDevice::isChannelNumberFree(newChannelNumber)) {
     channelNumber = -1;
     auto conflictChannel = GetByChannelNumber(newChannelNumber);
@@ -143,6 +210,8 @@ bool Channel::setChannelNumber(int newChannelNumber) {
   }
 
   channelNumber = newChannelNumber;
+  addToIndex();
+  loadCorrections();
   return true;
 }
 
@@ -151,7 +220,7 @@ void Channel::setNewValue(double dbl) {
     // for thermometer value must be greater than -273
     if (dbl > -273) {
       // Apply channel value correction
-      dbl += Correction::get(getChannelNumber());
+      dbl += valueCorrection;
       if (dbl < -273) {
         dbl = -273;
       }
@@ -159,7 +228,7 @@ void Channel::setNewValue(double dbl) {
   } else {
     // For all other channels
     // Apply channel value correction
-    dbl += Correction::get(getChannelNumber());
+    dbl += valueCorrection;
   }
 
   char newValue[SUPLA_CHANNELVALUE_SIZE] = {};
@@ -186,13 +255,13 @@ void Channel::setNewValue(double temp, double humi) {
       channelType == ChannelType::HUMIDITYANDTEMPSENSOR) {
     if (temp > -273) {
       // Apply channel value corrections
-      temp += Correction::get(getChannelNumber());
+      temp += valueCorrection;
       if (temp < -273) {
         temp = -273;
       }
     }
     if (humi >= 0) {
-      double humiCorr = Correction::get(getChannelNumber(), true);
+      double humiCorr = secondaryValueCorrection;
       humi += humiCorr;
       if (humiCorr > 0.01 || humiCorr < -0.01) {
         if (humi < 0) {
@@ -385,18 +454,22 @@ int Channel::getChannelNumber() const {
 void Channel::setSendValue() {
   // set changedFiled
   changedFields |= CHANNEL_SEND_VALUE;
+  updatePendingQueue();
 }
 
 void Channel::clearSendValue() {
   changedFields &= ~CHANNEL_SEND_VALUE;
+  updatePendingQueue();
 }
 
 void Channel::setSendGetConfig() {
   changedFields |= CHANNEL_SEND_GET_CONFIG;
+  updatePendingQueue();
 }
 
 void Channel::clearSendGetConfig() {
   changedFields &= ~CHANNEL_SEND_GET_CONFIG;
+  updatePendingQueue();
 }
 
 bool Channel::isGetConfigRequested() const {
@@ -409,10 +482,12 @@ bool Channel::isValueUpdateReady() const {
 
 void Channel::setSendInitialCaption() {
   changedFields |= CHANNEL_SEND_INITIAL_CAPTION;
+  updatePendingQueue();
 }
 
 void Channel::clearSendInitialCaption() {
   changedFields &= ~CHANNEL_SEND_INITIAL_CAPTION;
+  updatePendingQueue();
 }
 
 bool Channel::isInitialCaptionUpdateReady() const {
@@ -421,10 +496,12 @@ bool Channel::isInitialCaptionUpdateReady() const {
 
 void Channel::setSendStateInfo() {
   changedFields |= CHANNEL_SEND_STATE_INFO;
+  updatePendingQueue();
 }
 
 void Channel::clearSendStateInfo() {
   changedFields &= ~CHANNEL_SEND_STATE_INFO;
+  updatePendingQueue();
 }
 
 bool Channel::isStateInfoUpdateReady() const {
@@ -765,6 +842,20 @@ void Channel::setCorrection(double correction, bool forSecondaryValue) {
   Correction::add(getChannelNumber(), correction, forSecondaryValue);
 }
 
+double Channel::getCorrection(bool forSecondaryValue) const {
+  return forSecondaryValue ? secondaryValueCorrection : valueCorrection;
+}
+
+void Channel::loadCorrections() {
+  if (channelNumber < 0) {
+    valueCorrection = 0;
+    secondaryValueCorrection = 0;
+    return;
+  }
+  valueCorrection = Correction::get(channelNumber);
+  secondaryValueCorrection = Correction::get(channelNumber, true);
+}
+
 bool Channel::isBatteryPowered() const {
   return batteryPowered == 1;
 }
@@ -39,7 +39,31 @@ class Channel : public LocalAction {
   static Channel *Begin();
   static Channel *Last();
   static Channel *GetByChannelNumber(int channelNumber);
+  /**
+   * Returns counter which is incremented each time when any channel is
+   * created, removed or renumbered. It allows to detect that cached
+   * channel number mappings (i.e. in Element) are outdated.
+   *
+   * @return channel numbering generation
+   */
+  static uint32_t GetNumberingGeneration();
+  /**
+   * Returns first channel from the queue of channels with pending updates
+   * (value, initial caption, get config or state info). Channels are queued
+   * in the order in which they got their first pending update.
+   *
+   * @return first channel with pending update, nullptr if there is none
+   */
+  static Channel *PendingUpdateBegin();
+  static Channel *PendingUpdateLast();
+  static bool IsAnyUpdatePending();
   Channel *next();
+  Channel *nextPendingUpdate();
+  /**
+   * Moves channel to the end of pending updates queue, so channels queued
+   * after it are handled first. Does nothing if channel isn't queued.
+   */
+  void movePendingUpdateToEnd();
 
 #ifdef SUPLA_TEST
   static void resetToDefaults();
@@ -291,6 +315,10 @@ class Channel : public LocalAction {
   virtual bool getExtValueAsElectricityMeter(
       TElectricityMeter_ExtendedValue_V3 *out);
   void setCorrection(double correction, bool forSecondaryValue = false);
+  double getCorrection(bool forSecondaryValue = false) const;
+  // Reloads cached value corrections from Supla::Correction. Called
+  // automatically when correction is changed or channel is renumbered.
+  void loadCorrections();
   bool isSleepingEnabled();
   bool isWeeklyScheduleAvailable();
 
@@ -376,9 +404,22 @@ class Channel : public LocalAction {
   void clearSendStateInfo();
   bool isStateInfoUpdateReady() const;
 
+  void addToIndex();
+  void removeFromIndex();
+  void updatePendingQueue();
+
   static Channel *firstPtr;
+  static Channel *lastPtr;
   static int startingChannelNumber;
+  static uint32_t numberingGeneration;
   Channel *nextPtr = nullptr;
+  Channel *prevPtr = nullptr;
+
+  // queue of channels with changedFields != 0
+  static Channel *pendingFirstPtr;
+  static Channel *pendingLastPtr;
+  Channel *nextPendingPtr = nullptr;
+  Channel *prevPendingPtr = nullptr;
 
   char *initialCaption = nullptr;
 
@@ -387,6 +428,10 @@ class Channel : public LocalAction {
   uint64_t channelFlags = 0;
   uint32_t validityTimeSec = 0;
 
+  // cached values from Supla::Correction
+  double valueCorrection = 0;
+  double secondaryValueCorrection = 0;
+
   int16_t channelNumber = -1;
 
   uint16_t defaultFunction =
@@ -394,6 +439,7 @@ class Channel : public LocalAction {
           // far that use more than 16 bits
 
   uint8_t changedFields = 0;  // keeps track of pending updates
+  bool pendingQueued = false;
 
   uint8_t batteryLevel = 255;          // 0 - 100%; 255 - not used
   uint8_t batteryPowered = 0;  // 0 - not used, 1 - true, 2 - false
@@ -249,11 +249,11 @@ void Button::enableAction(int32_t action,
 }
 
 void Button::evaluateMaxMulticlickValue() {
-  auto ptr = ActionHandlerClient::begin;
+  auto ptr = triggerClients;
   uint8_t clickCounterValueForEvent = 0;
   maxMulticlickValueConfigured = 0;
   while (ptr) {
-    if (ptr->trigger == this && ptr->isEnabled()) {
+    if (ptr->isEnabled()) {
       switch (ptr->onEvent) {
         case ON_LONG_CLICK_1:
         case ON_CLICK_1: {
@@ -308,7 +308,7 @@ void Button::evaluateMaxMulticlickValue() {
         }
       }
     }
-    ptr = ptr->next;
+    ptr = ptr->getNextForTrigger();
 
     if (clickCounterValueForEvent > maxMulticlickValueConfigured) {
       maxMulticlickValueConfigured = clickCounterValueForEvent;
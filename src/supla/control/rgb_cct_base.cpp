@@ -67,6 +67,7 @@ void GeometricBrightnessAdjuster::setMaxHwValue(int maxHwValue) {
 }
 
 RGBCCTBase::RGBCCTBase(RGBCCTBase *parent) : parent(parent) {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_DIMMERANDRGBLED);
   channel.setFlag(SUPLA_CHANNEL_FLAG_RGBW_COMMANDS_SUPPORTED);
   channel.setFlag(SUPLA_CHANNEL_FLAG_RUNTIME_CHANNEL_CONFIG_UPDATE);
@@ -55,6 +55,7 @@ struct RollerShutterWithTiltStateData {
 #pragma pack(pop)
 
 RollerShutterInterface::RollerShutterInterface(bool tiltFunctionsSupported) {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_RELAY);
   channel.setFuncList(SUPLA_BIT_FUNC_CONTROLLINGTHEROLLERSHUTTER |
                       SUPLA_BIT_FUNC_CONTROLLINGTHEROOFWINDOW |
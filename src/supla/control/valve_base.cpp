@@ -35,6 +35,7 @@ Supla::Control::ValveConfig::ValveConfig() {
 }
 
 ValveBase::ValveBase(bool openClose) {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setFlag(SUPLA_CHANNEL_FLAG_RUNTIME_CHANNEL_CONFIG_UPDATE);
   channel.setFlag(SUPLA_CHANNEL_FLAG_FLOOD_SENSORS_SUPPORTED);
   if (openClose) {
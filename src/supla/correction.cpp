@@ -16,6 +16,9 @@
 
 #include "correction.h"
 
+#include <supla/channels/channel.h>
+#include <supla/intrusive_list.h>
+
 using Supla::Correction;
 
 void Supla::Correction::add(uint8_t channelNumber,
@@ -27,6 +30,11 @@ void Supla::Correction::add(uint8_t channelNumber,
   } else {
     new Correction(channelNumber, correction, forSecondaryValue);
   }
+
+  auto channel = Supla::Channel::GetByChannelNumber(channelNumber);
+  if (channel) {
+    channel->loadCorrections();
+  }
 }
 
 Correction *Correction::getInstance(uint8_t channelNumber,
@@ -57,35 +65,25 @@ Supla::Correction::Correction(uint8_t channelNumber,
     : correction(correction),
       channelNumber(channelNumber),
       forSecondaryValue(forSecondaryValue) {
-  if (first == nullptr) {
-    first = this;
-  } else {
-    Correction *ptr = first;
-    while (ptr && ptr->next) {
-      ptr = ptr->next;
-    }
-    ptr->next = this;
-  }
+  Supla::IntrusiveList<Correction, &Correction::next, &Correction::prev>::
+      append(&first, &last, this);
 }
 
 Supla::Correction::~Correction() {
-  if (first == this) {
-    first = next;
-    return;
-  }
-
-  auto ptr = first;
-  while (ptr->next != this) {
-    ptr = ptr->next;
-  }
-
-  ptr->next = ptr->next->next;
+  Supla::IntrusiveList<Correction, &Correction::next, &Correction::prev>::
+      remove(&first, &last, this);
 }
 
 void Supla::Correction::clear() {
   while (first) {
     delete first;
   }
+
+  for (auto channel = Supla::Channel::Begin(); channel != nullptr;
+       channel = channel->next()) {
+    channel->loadCorrections();
+  }
 }
 
 Supla::Correction *Supla::Correction::first = nullptr;
+Supla::Correction *Supla::Correction::last = nullptr;
@@ -36,9 +36,11 @@ class Correction {
   ~Correction();
 
   static Correction *first;
+  static Correction *last;
 
   double correction = 0;
   Correction *next = nullptr;
+  Correction *prev = nullptr;
 
   uint8_t channelNumber = 0;
   bool forSecondaryValue = false;
@@ -16,32 +16,74 @@
  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
-
 #include "crc16.h"
 
-uint16_t crc16_update(uint16_t crc, uint8_t a) {
-  int i;
-
-  crc ^= a;
-  for (i = 0; i < 8; ++i) {
-    if (crc & 1)
-      crc = (crc >> 1) ^ 0xA001;
-    else
-      crc = (crc >> 1);
+#include "crc_tables.h"
+
+using Supla::Crc::CrcTables;
+
+uint16_t Supla::Crc::crc16Bitwise(uint16_t crc,
+                                  const uint8_t *data,
+                                  int size) {
+  for (int j = 0; j < size; j++) {
+    crc ^= data[j];
+    for (int i = 0; i < 8; ++i) {
+      if (crc & 1)
+        crc = (crc >> 1) ^ Crc16Polynomial;
+      else
+        crc = (crc >> 1);
+    }
   }
+  return crc;
+}
 
+uint16_t Supla::Crc::crc16Table(uint16_t crc, const uint8_t *data, int size) {
+  for (int i = 0; i < size; i++) {
+    crc = (crc >> 8) ^ CrcTables::crc16[(crc ^ data[i]) & 0xFF];
+  }
   return crc;
 }
 
-uint16_t calculateCrc16(const uint8_t *data, int size) {
+uint16_t Supla::Crc::crc16SliceBy8(uint16_t crc,
+                                   const uint8_t *data,
+                                   int size) {
+  const auto &slices = CrcTables::crc16Slices;
+  while (size >= 8) {
+    crc ^= data[0] | (data[1] << 8);
+    crc = slices[6][crc & 0xFF] ^ slices[5][crc >> 8] ^ slices[4][data[2]] ^
+          slices[3][data[3]] ^ slices[2][data[4]] ^ slices[1][data[5]] ^
+          slices[0][data[6]] ^ CrcTables::crc16[data[7]];
+    data += 8;
+    size -= 8;
+  }
+  return crc16Table(crc, data, size);
+}
+
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, int size) {
   if (data == nullptr) {
-    return 0;
+    return crc;
   }
+#if SUPLA_CRC_IMPLEMENTATION == SUPLA_CRC_SLICE_BY_8
+  return Supla::Crc::crc16SliceBy8(crc, data, size);
+#elif SUPLA_CRC_IMPLEMENTATION == SUPLA_CRC_TABLE
+  return Supla::Crc::crc16Table(crc, data, size);
+#else
+  return Supla::Crc::crc16Bitwise(crc, data, size);
+#endif
+}
 
-  uint16_t crc = 0xFFFF;
-  for (int i = 0; i < size; i++) {
-    crc = crc16_update(crc, data[i]);
+uint16_t crc16_update(uint16_t crc, uint8_t a) {
+#if SUPLA_CRC_IMPLEMENTATION == SUPLA_CRC_BITWISE
+  return Supla::Crc::crc16Bitwise(crc, &a, 1);
+#else
+  return Supla::Crc::crc16Table(crc, &a, 1);
+#endif
+}
+
+uint16_t calculateCrc16(const uint8_t *data, int size) {
+  if (data == nullptr) {
+    return 0;
   }
 
-  return crc;
+  return crc16_update(0xFFFF, data, size);
 }
@@ -22,6 +22,19 @@
 #include <stdint.h>
 
 uint16_t crc16_update(uint16_t crc, uint8_t a);
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, int size);
 uint16_t calculateCrc16(const uint8_t *data, int size);
 
+namespace Supla {
+namespace Crc {
+
+// CRC16 implementations, crc16_update() uses one of them depending on
+// SUPLA_CRC_IMPLEMENTATION (see crc_tables.h)
+uint16_t crc16Bitwise(uint16_t crc, const uint8_t *data, int size);
+uint16_t crc16Table(uint16_t crc, const uint8_t *data, int size);
+uint16_t crc16SliceBy8(uint16_t crc, const uint8_t *data, int size);
+
+}  // namespace Crc
+}  // namespace Supla
+
 #endif  // SRC_SUPLA_CRC16_H_
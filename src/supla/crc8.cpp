@@ -18,15 +18,17 @@
 
 #include "crc8.h"
 
-uint8_t crc8(uint8_t *bytes, int size) {
-  uint8_t crc = 0;
+#include "crc_tables.h"
 
+using Supla::Crc::CrcTables;
+
+uint8_t Supla::Crc::crc8Bitwise(uint8_t crc, const uint8_t *data, int size) {
   for (int j = 0; j < size; j++) {
-    crc ^= bytes[j];
+    crc ^= data[j];
 
     for (int i = 0; i < 8; i++) {
       if ((crc & 0x80) != 0)
-        crc = (crc << 1) ^ static_cast<uint8_t>(0x7);
+        crc = (crc << 1) ^ Crc8Polynomial;
       else
         crc <<= 1;
     }
@@ -34,3 +36,31 @@ uint8_t crc8(uint8_t *bytes, int size) {
   return crc;
 }
 
+uint8_t Supla::Crc::crc8Table(uint8_t crc, const uint8_t *data, int size) {
+  for (int i = 0; i < size; i++) {
+    crc = CrcTables::crc8[crc ^ data[i]];
+  }
+  return crc;
+}
+
+uint8_t Supla::Crc::crc8SliceBy8(uint8_t crc, const uint8_t *data, int size) {
+  const auto &slices = CrcTables::crc8Slices;
+  while (size >= 8) {
+    crc = slices[6][crc ^ data[0]] ^ slices[5][data[1]] ^ slices[4][data[2]] ^
+          slices[3][data[3]] ^ slices[2][data[4]] ^ slices[1][data[5]] ^
+          slices[0][data[6]] ^ CrcTables::crc8[data[7]];
+    data += 8;
+    size -= 8;
+  }
+  return crc8Table(crc, data, size);
+}
+
+uint8_t crc8(const uint8_t *data, int size) {
+#if SUPLA_CRC_IMPLEMENTATION == SUPLA_CRC_SLICE_BY_8
+  return Supla::Crc::crc8SliceBy8(0, data, size);
+#elif SUPLA_CRC_IMPLEMENTATION == SUPLA_CRC_TABLE
+  return Supla::Crc::crc8Table(0, data, size);
+#else
+  return Supla::Crc::crc8Bitwise(0, data, size);
+#endif
+}
@@ -21,6 +21,18 @@
 
 #include <stdint.h>
 
-uint8_t crc8(uint8_t *data, int size);
+uint8_t crc8(const uint8_t *data, int size);
+
+namespace Supla {
+namespace Crc {
+
+// CRC8 implementations, crc8() uses one of them depending on
+// SUPLA_CRC_IMPLEMENTATION (see crc_tables.h)
+uint8_t crc8Bitwise(uint8_t crc, const uint8_t *data, int size);
+uint8_t crc8Table(uint8_t crc, const uint8_t *data, int size);
+uint8_t crc8SliceBy8(uint8_t crc, const uint8_t *data, int size);
+
+}  // namespace Crc
+}  // namespace Supla
 
 #endif  // SRC_SUPLA_CRC8_H_
@@ -0,0 +1,137 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+
+#ifndef SRC_SUPLA_CRC_TABLES_H_
+#define SRC_SUPLA_CRC_TABLES_H_
+
+#include <stdint.h>
+
+/*
+ * CRC implementation used by crc16_update(), calculateCrc16() and crc8():
+ * SUPLA_CRC_BITWISE - no lookup tables, 8 steps per byte,
+ * SUPLA_CRC_TABLE - one 256 entry table (512 B for CRC16, 256 B for CRC8),
+ * SUPLA_CRC_SLICE_BY_8 - 8 tables, 8 bytes per step (4 KiB for CRC16,
+ *                        2 KiB for CRC8).
+ * Tables are generated at compile time and only tables of used
+ * implementation are linked.
+ */
+#define SUPLA_CRC_BITWISE 0
+#define SUPLA_CRC_TABLE 1
+#define SUPLA_CRC_SLICE_BY_8 2
+
+#ifndef SUPLA_CRC_IMPLEMENTATION
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_ESP8266)
+// const data is kept in RAM on these platforms
+#define SUPLA_CRC_IMPLEMENTATION SUPLA_CRC_BITWISE
+#else
+#define SUPLA_CRC_IMPLEMENTATION SUPLA_CRC_SLICE_BY_8
+#endif
+#endif
+
+namespace Supla {
+namespace Crc {
+
+// CRC16 with reflected 0x8005 polynomial (0xA001), used in storage
+constexpr uint16_t Crc16Polynomial = 0xA001;
+// CRC8 with 0x07 polynomial
+constexpr uint8_t Crc8Polynomial = 0x07;
+
+// Functions are written as single return statements, so tables can be
+// generated also by C++11 compilers.
+constexpr uint16_t crc16Bits(uint16_t crc, int bits) {
+  return bits == 0 ? crc
+                   : crc16Bits((crc & 1) ? static_cast<uint16_t>(
+                                               (crc >> 1) ^ Crc16Polynomial)
+                                         : static_cast<uint16_t>(crc >> 1),
+                               bits - 1);
+}
+
+// CRC of byte n followed by "slice" zero bytes, calculated from 0
+constexpr uint16_t crc16Entry(int slice, int n) {
+  return slice == 0 ? crc16Bits(static_cast<uint16_t>(n), 8)
+                    : crc16Bits(crc16Entry(slice - 1, n), 8);
+}
+
+constexpr uint8_t crc8Bits(uint8_t crc, int bits) {
+  return bits == 0 ? crc
+                   : crc8Bits((crc & 0x80) ? static_cast<uint8_t>(
+                                                 (crc << 1) ^ Crc8Polynomial)
+                                           : static_cast<uint8_t>(crc << 1),
+                              bits - 1);
+}
+
+constexpr uint8_t crc8Entry(int slice, int n) {
+  return slice == 0 ? crc8Bits(static_cast<uint8_t>(n), 8)
+                    : crc8Bits(crc8Entry(slice - 1, n), 8);
+}
+
+template <int... I>
+struct IndexSequence {};
+
+template <int N, int... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+
+template <int... I>
+struct MakeIndexSequence<0, I...> {
+  typedef IndexSequence<I...> Type;
+};
+
+template <typename Sequence>
+struct Tables;
+
+// crc16/crc8 are tables for byte-wise calculation. Slices tables contain
+// entries for byte followed by 1..7 zero bytes and are used together with
+// byte-wise table in slice-by-8 calculation.
+template <int... I>
+struct Tables<IndexSequence<I...>> {
+  static constexpr uint16_t crc16[sizeof...(I)] = {crc16Entry(0, I)...};
+  static constexpr uint16_t crc16Slices[7][sizeof...(I)] = {
+      {crc16Entry(1, I)...},
+      {crc16Entry(2, I)...},
+      {crc16Entry(3, I)...},
+      {crc16Entry(4, I)...},
+      {crc16Entry(5, I)...},
+      {crc16Entry(6, I)...},
+      {crc16Entry(7, I)...}};
+  static constexpr uint8_t crc8[sizeof...(I)] = {crc8Entry(0, I)...};
+  static constexpr uint8_t crc8Slices[7][sizeof...(I)] = {
+      {crc8Entry(1, I)...},
+      {crc8Entry(2, I)...},
+      {crc8Entry(3, I)...},
+      {crc8Entry(4, I)...},
+      {crc8Entry(5, I)...},
+      {crc8Entry(6, I)...},
+      {crc8Entry(7, I)...}};
+};
+
+template <int... I>
+constexpr uint16_t Tables<IndexSequence<I...>>::crc16[sizeof...(I)];
+template <int... I>
+constexpr uint16_t Tables<IndexSequence<I...>>::crc16Slices[7][sizeof...(I)];
+template <int... I>
+constexpr uint8_t Tables<IndexSequence<I...>>::crc8[sizeof...(I)];
+template <int... I>
+constexpr uint8_t Tables<IndexSequence<I...>>::crc8Slices[7][sizeof...(I)];
+
+typedef Tables<MakeIndexSequence<256>::Type> CrcTables;
+
+}  // namespace Crc
+}  // namespace Supla
+
+#endif  // SRC_SUPLA_CRC_TABLES_H_
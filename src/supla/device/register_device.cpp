@@ -267,16 +267,7 @@ int Supla::RegisterDevice::getNextFreeChannelNumber() {
   for (int candidate = Supla::Channel::getStartingChannelNumber();
        candidate < SUPLA_CHANNELMAXCOUNT;
        candidate++) {
-    bool candidateFree = true;
-    for (Supla::Channel *ch = Supla::Channel::Begin(); ch != nullptr;
-         ch = ch->next()) {
-      if (ch->getChannelNumber() == candidate) {
-        candidateFree = false;
-        break;
-      }
-    }
-
-    if (candidateFree) {
+    if (Supla::Channel::GetByChannelNumber(candidate) == nullptr) {
       return candidate;
     }
   }
@@ -290,14 +281,7 @@ bool Supla::RegisterDevice::isChannelNumberFree(int channelNumber) {
     return false;
   }
 
-  for (Supla::Channel *ch = Supla::Channel::Begin(); ch != nullptr;
-       ch = ch->next()) {
-    if (ch->getChannelNumber() == channelNumber) {
-      return false;
-    }
-  }
-
-  return true;
+  return Supla::Channel::GetByChannelNumber(channelNumber) == nullptr;
 }
 
 void Supla::RegisterDevice::addChannel(int channelNumber) {
@@ -18,9 +18,11 @@
 
 #include <supla-common/proto.h>
 #include <supla/channels/channel.h>
+#include <supla/intrusive_list.h>
 #include <supla/log_wrapper.h>
 #include <supla/storage/config.h>
 #include <supla/time.h>
+#include <string.h>
 
 namespace Supla {
 
@@ -29,29 +31,63 @@ class SuplaSrpc;
 }  // namespace Protocol
 
 Element *Element::firstPtr = nullptr;
+Element *Element::lastPtr = nullptr;
+Element *Element::pollingFirstPtr = nullptr;
+Element *Element::pollingLastPtr = nullptr;
 bool Element::invalidatePtr = false;
 
-Element::Element() {
-  if (firstPtr == nullptr) {
-    firstPtr = this;
-  } else {
-    last()->nextPtr = this;
+namespace {
+// Channel number -> Element lookup table. Element's channel is created after
+// Element's constructor is called and it can be renumbered later, so the
+// table is rebuilt lazily when elements list or channel numbering changes.
+// Secondary channels are stored in slots which aren't used as primary
+// channel.
+Element *elementByChannelNumber[SUPLA_CHANNELMAXCOUNT] = {};
+bool elementIndexValid = false;
+uint32_t elementIndexGeneration = 0;
+
+void rebuildElementIndex() {
+  memset(elementByChannelNumber, 0, sizeof(elementByChannelNumber));
+  for (auto element = Element::begin(); element != nullptr;
+       element = element->next()) {
+    int channelNumber = element->getChannelNumber();
+    if (channelNumber >= 0 && channelNumber < SUPLA_CHANNELMAXCOUNT &&
+        elementByChannelNumber[channelNumber] == nullptr) {
+      elementByChannelNumber[channelNumber] = element;
+    }
   }
+  for (auto element = Element::begin(); element != nullptr;
+       element = element->next()) {
+    int channelNumber = element->getSecondaryChannelNumber();
+    if (channelNumber >= 0 && channelNumber < SUPLA_CHANNELMAXCOUNT &&
+        elementByChannelNumber[channelNumber] == nullptr) {
+      elementByChannelNumber[channelNumber] = element;
+    }
+  }
+  elementIndexValid = true;
+  elementIndexGeneration = Channel::GetNumberingGeneration();
+}
+}  // namespace
+
+Element::Element() {
+  elementIndexValid = false;
+  IntrusiveList<Element, &Element::nextPtr, &Element::prevPtr>::append(
+      &firstPtr, &lastPtr, this);
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, true);
 }
 
 Element::~Element() {
   invalidatePtr = true;
-  if (begin() == this) {
-    firstPtr = next();
-    return;
-  }
-
-  auto ptr = begin();
-  while (ptr->next() != this) {
-    ptr = ptr->next();
+  elementIndexValid = false;
+  if (pollingReasons != 0) {
+    IntrusiveList<Element,
+                  &Element::nextPollingPtr,
+                  &Element::prevPollingPtr>::remove(&pollingFirstPtr,
+                                                    &pollingLastPtr,
+                                                    this);
   }
-
-  ptr->nextPtr = ptr->next()->next();
+  IntrusiveList<Element, &Element::nextPtr, &Element::prevPtr>::remove(
+      &firstPtr, &lastPtr, this);
 }
 
 Element *Element::begin() {
@@ -59,11 +95,7 @@ Element *Element::begin() {
 }
 
 Element *Element::last() {
-  Element *ptr = firstPtr;
-  while (ptr && ptr->nextPtr) {
-    ptr = ptr->nextPtr;
-  }
-  return ptr;
+  return lastPtr;
 }
 
 Element *Element::getElementByChannelNumber(int channelNumber) {
@@ -71,6 +103,26 @@ Element *Element::getElementByChannelNumber(int channelNumber) {
     return nullptr;
   }
 
+  if (channelNumber < SUPLA_CHANNELMAXCOUNT) {
+    if (!elementIndexValid ||
+        elementIndexGeneration != Channel::GetNumberingGeneration()) {
+      rebuildElementIndex();
+    }
+    Element *element = elementByChannelNumber[channelNumber];
+    if (element != nullptr && element->getChannelNumber() != channelNumber) {
+      if (element->getSecondaryChannelNumber() == channelNumber) {
+        return nullptr;
+      }
+      // element changed its channel without renumbering it
+      rebuildElementIndex();
+      element = elementByChannelNumber[channelNumber];
+      if (element != nullptr && element->getChannelNumber() != channelNumber) {
+        return nullptr;
+      }
+    }
+    return element;
+  }
+
   Element *element = begin();
   while (element != nullptr && element->getChannelNumber() != channelNumber) {
     element = element->next();
@@ -92,13 +144,54 @@ Element *Element::getOwnerOfSubDeviceId(int subDeviceId) {
   return element;
 }
 
-bool Element::IsAnyUpdatePending() {
+Element *Element::GetOwnerOfChannelNumber(int channelNumber) {
+  if (channelNumber < 0) {
+    return nullptr;
+  }
+
+  if (channelNumber < SUPLA_CHANNELMAXCOUNT) {
+    if (!elementIndexValid ||
+        elementIndexGeneration != Channel::GetNumberingGeneration()) {
+      rebuildElementIndex();
+    }
+    Element *element = elementByChannelNumber[channelNumber];
+    if (element != nullptr && element->getChannelNumber() != channelNumber &&
+        element->getSecondaryChannelNumber() != channelNumber) {
+      rebuildElementIndex();
+      element = elementByChannelNumber[channelNumber];
+    }
+    return element;
+  }
+
   Element *element = begin();
-  while (element != nullptr) {
+  while (element != nullptr && element->getChannelNumber() != channelNumber &&
+         element->getSecondaryChannelNumber() != channelNumber) {
+    element = element->next();
+  }
+
+  return element;
+}
+
+Element *Element::PollingBegin() {
+  return pollingFirstPtr;
+}
+
+bool Element::IsAnyUpdatePending() {
+  // Elements which aren't polled can have pending updates only on their
+  // channels, so only queued channels and polled elements are checked
+  for (auto channel = Channel::PendingUpdateBegin(); channel != nullptr;
+       channel = channel->nextPendingUpdate()) {
+    auto element = GetOwnerOfChannelNumber(channel->getChannelNumber());
+    if (element != nullptr && element->isAnyUpdatePending()) {
+      return true;
+    }
+  }
+
+  for (auto element = PollingBegin(); element != nullptr;
+       element = element->nextPolling()) {
     if (element->isAnyUpdatePending()) {
       return true;
     }
-    element = element->next();
   }
   return false;
 }
@@ -107,6 +200,37 @@ Element *Element::next() {
   return nextPtr;
 }
 
+Element *Element::nextPolling() {
+  return nextPollingPtr;
+}
+
+bool Element::isIterateConnectedPolled() const {
+  return pollingReasons != 0;
+}
+
+void Element::setIterateConnectedPolling(uint8_t reason, bool enabled) {
+  bool wasPolled = pollingReasons != 0;
+  if (enabled) {
+    pollingReasons |= reason;
+  } else {
+    pollingReasons &= ~reason;
+  }
+  bool isPolled = pollingReasons != 0;
+  if (isPolled && !wasPolled) {
+    IntrusiveList<Element,
+                  &Element::nextPollingPtr,
+                  &Element::prevPollingPtr>::append(&pollingFirstPtr,
+                                                    &pollingLastPtr,
+                                                    this);
+  } else if (!isPolled && wasPolled) {
+    IntrusiveList<Element,
+                  &Element::nextPollingPtr,
+                  &Element::prevPollingPtr>::remove(&pollingFirstPtr,
+                                                    &pollingLastPtr,
+                                                    this);
+  }
+}
+
 void Element::onInit() {}
 
 void Element::onLoadConfig(SuplaDeviceClass *) {}
@@ -117,6 +241,22 @@ void Element::onLoadState() {}
 
 void Element::onSaveState() {}
 
+void Element::markStateChanged() {
+  stateChanged = true;
+}
+
+bool Element::isStateChanged() const {
+  return !stateChangeTracking || stateChanged;
+}
+
+void Element::clearStateChanged() {
+  stateChanged = false;
+}
+
+void Element::enableStateChangeTracking() {
+  stateChangeTracking = true;
+}
+
 void Element::onRegistered(Supla::Protocol::SuplaSrpc *suplaSrpc) {
   if (suplaSrpc == nullptr) {
     return;
@@ -147,6 +287,10 @@ bool Element::iterateConnected(void *ptr) {
 
 bool Element::iterateConnected() {
   bool response = true;
+  if (!Channel::IsAnyUpdatePending()) {
+    return response;
+  }
+
   Channel *secondaryChannel = getSecondaryChannel();
   if (secondaryChannel && secondaryChannel->isUpdateReady()) {
     secondaryChannel->sendUpdate();
@@ -24,6 +24,13 @@
 
 class SuplaDeviceClass;
 
+// Reasons for iterating Element on each connected iteration, see
+// Element::setIterateConnectedPolling()
+// iterateConnected() does more than sending pending channel updates
+#define ELEMENT_POLLING_ITERATE_CONNECTED (1 << 0)
+// channel config exchange with server is in progress
+#define ELEMENT_POLLING_CONFIG_EXCHANGE (1 << 1)
+
 namespace Supla {
 
 class Channel;
@@ -61,6 +68,25 @@ class Element {
    */
   static Element *getElementByChannelNumber(int channelNumber);
 
+  /**
+   * Returns Element which uses given channel number as its primary or
+   * secondary channel
+   *
+   * @param channelNumber
+   *
+   * @return pointer to Element, nullptr if not found
+   */
+  static Element *GetOwnerOfChannelNumber(int channelNumber);
+
+  /**
+   * Returns first Element which is iterated on each connected iteration
+   * (see setIterateConnectedPolling()). Other elements are iterated only when
+   * one of their channels has a pending update.
+   *
+   * @return first polled Element
+   */
+  static Element *PollingBegin();
+
   /**
    * Returns Element which owns given subDeviceId
    *
@@ -112,6 +138,20 @@ class Element {
    */
   Element *next();
 
+  /**
+   * Returns next polled Element
+   *
+   * @return pointer to the next polled Element
+   */
+  Element *nextPolling();
+
+  /**
+   * Checks if Element is iterated on each connected iteration
+   *
+   * @return true if Element is polled
+   */
+  bool isIterateConnectedPolled() const;
+
   /**
    * First method called on element in SuplaDevice.begin().
    *
@@ -147,9 +187,38 @@ class Element {
    * Method called periodically during SuplaDevice iteration
    *
    * It should provide state saving for this elemnet to Storage
+   *
+   * If state change tracking is enabled (see enableStateChangeTracking()),
+   * this method is called only after markStateChanged(). Subclass which
+   * overrides it to save additional data has to call markStateChanged() on
+   * each change of that data, otherwise the change isn't saved.
    */
   virtual void onSaveState();
 
+  /**
+   * Marks data stored by onSaveState() as changed.
+   *
+   * Used only by elements which enabled state change tracking with
+   * enableStateChangeTracking(). Such element has to call this method each
+   * time data written in onSaveState() changes, so state storage can reuse
+   * element's state saved previously and skip onSaveState() call.
+   */
+  void markStateChanged();
+
+  /**
+   * Checks if element's state has to be saved.
+   *
+   * @return true if state changed since last save or element doesn't track
+   *         state changes, false otherwise
+   */
+  bool isStateChanged() const;
+
+  /**
+   * Clears state changed flag. Called by state storage after element's
+   * state was saved.
+   */
+  void clearStateChanged();
+
   /**
    * Method called after onInit() to check if state storage migration is needed.
    * WARNING: state storage migration is not done in a way that it guarantees
@@ -421,9 +490,45 @@ class Element {
   virtual void onFunctionChange(uint32_t currentFunction, uint32_t newFunction);
 
  protected:
+  /**
+   * Enables state change tracking. Element has to call markStateChanged()
+   * on every change of data stored in onSaveState().
+   *
+   * Tracking applies to subclasses too: data added to onSaveState() by a
+   * subclass isn't saved unless the subclass also calls markStateChanged().
+   * It is enabled i.e. by VirtualBinary and VirtualImpulseCounter.
+   */
+  void enableStateChangeTracking();
+
+  /**
+   * Sets or clears reason for calling iterateConnected() on each connected
+   * iteration. Element without any reason set is iterated only when its
+   * primary or secondary channel has a pending update.
+   *
+   * ELEMENT_POLLING_ITERATE_CONNECTED is set by default, so every element is
+   * iterated as before. Sensor and control base classes which only send
+   * channel updates from iterateConnected() (i.e. ThermHygroMeter,
+   * BinaryBase, ElectricityMeter) clear it. Their subclasses which override
+   * iterateConnected() with other work (timers, periodic requests) have to
+   * set it again.
+   *
+   * @param reason ELEMENT_POLLING_* bit
+   * @param enabled
+   */
+  void setIterateConnectedPolling(uint8_t reason, bool enabled);
+
   static Element *firstPtr;
+  static Element *lastPtr;
+  static Element *pollingFirstPtr;
+  static Element *pollingLastPtr;
   static bool invalidatePtr;
   Element *nextPtr = nullptr;
+  Element *prevPtr = nullptr;
+  Element *nextPollingPtr = nullptr;
+  Element *prevPollingPtr = nullptr;
+  uint8_t pollingReasons = 0;
+  bool stateChangeTracking = false;
+  bool stateChanged = true;
 };
 
 };  // namespace Supla
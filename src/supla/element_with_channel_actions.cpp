@@ -218,9 +218,9 @@ bool Supla::ElementWithChannelActions::loadConfigChangeFlag() {
     if (cfg->isChannelConfigChangeFlagSet(getChannelNumber())) {
       SUPLA_LOG_INFO("Channel[%d] config changed offline flag is set",
                      getChannelNumber());
-      channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+      setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     } else {
-      channelConfigState = Supla::ChannelConfigState::None;
+      setChannelConfigState(Supla::ChannelConfigState::None);
     }
     return true;
   }
@@ -263,17 +263,30 @@ bool Supla::ElementWithChannelActions::setAndSaveFunction(
   return false;
 }
 
+void Supla::ElementWithChannelActions::setChannelConfigState(
+    Supla::ChannelConfigState state) {
+  channelConfigState = state;
+  setIterateConnectedPolling(ELEMENT_POLLING_CONFIG_EXCHANGE,
+                             isConfigExchangePending());
+}
+
+bool Supla::ElementWithChannelActions::isConfigExchangePending() const {
+  return channelConfigState == Supla::ChannelConfigState::LocalChangePending ||
+         channelConfigState ==
+             Supla::ChannelConfigState::SetChannelConfigSend ||
+         channelConfigState == Supla::ChannelConfigState::LocalChangeSent ||
+         channelConfigState ==
+             Supla::ChannelConfigState::WaitForConfigFinished ||
+         channelConfigState == Supla::ChannelConfigState::ResendConfig;
+}
+
 bool Supla::ElementWithChannelActions::isAnyUpdatePending() const {
   auto channel = getChannel();
   if (!channel) {
     return false;
   }
 
-  if (channelConfigState == Supla::ChannelConfigState::LocalChangePending ||
-      channelConfigState == Supla::ChannelConfigState::SetChannelConfigSend ||
-      channelConfigState == Supla::ChannelConfigState::LocalChangeSent ||
-      channelConfigState == Supla::ChannelConfigState::WaitForConfigFinished ||
-      channelConfigState == Supla::ChannelConfigState::ResendConfig) {
+  if (isConfigExchangePending()) {
     return true;
   }
 
@@ -287,7 +300,7 @@ bool Supla::ElementWithChannelActions::isAnyUpdatePending() const {
 void Supla::ElementWithChannelActions::clearChannelConfigChangedFlag() {
   if (channelConfigState != Supla::ChannelConfigState::None &&
       channelConfigState != Supla::ChannelConfigState::SetChannelConfigFailed) {
-    channelConfigState = Supla::ChannelConfigState::None;
+    setChannelConfigState(Supla::ChannelConfigState::None);
     saveConfigChangeFlag();
   }
 }
@@ -300,14 +313,14 @@ void Supla::ElementWithChannelActions::onRegistered(
   switch (channelConfigState) {
     case Supla::ChannelConfigState::None:
     case Supla::ChannelConfigState::WaitForConfigFinished: {
-      channelConfigState = Supla::ChannelConfigState::WaitForConfigFinished;
+      setChannelConfigState(Supla::ChannelConfigState::WaitForConfigFinished);
       break;
     }
     case Supla::ChannelConfigState::LocalChangePending: {
       break;
     }
     default: {
-      channelConfigState = Supla::ChannelConfigState::ResendConfig;
+      setChannelConfigState(Supla::ChannelConfigState::ResendConfig);
       break;
     }
   }
@@ -317,7 +330,7 @@ void Supla::ElementWithChannelActions::handleChannelConfigFinished() {
   receivedConfigTypes.setConfigFinishedReceived();
   setChannelConfigAttempts = 0;
   if (channelConfigState == Supla::ChannelConfigState::WaitForConfigFinished) {
-    channelConfigState = Supla::ChannelConfigState::None;
+    setChannelConfigState(Supla::ChannelConfigState::None);
   }
   if (receivedConfigTypes != usedConfigTypes) {
     SUPLA_LOG_INFO(
@@ -326,7 +339,7 @@ void Supla::ElementWithChannelActions::handleChannelConfigFinished() {
         getChannelNumber(),
         receivedConfigTypes.getAll(),
         usedConfigTypes.getAll());
-    channelConfigState = Supla::ChannelConfigState::ResendConfig;
+    setChannelConfigState(Supla::ChannelConfigState::ResendConfig);
   }
 }
 
@@ -367,7 +380,7 @@ uint8_t Supla::ElementWithChannelActions::handleChannelConfig(
   // Channel disabled on server
   if (result->Func == 0) {
     SUPLA_LOG_DEBUG("Channel[%d] disabled on server", getChannelNumber());
-    channelConfigState = Supla::ChannelConfigState::None;
+    setChannelConfigState(Supla::ChannelConfigState::None);
     receivedConfigTypes = usedConfigTypes;
     return SUPLA_CONFIG_RESULT_TRUE;
   }
@@ -462,9 +475,9 @@ void Supla::ElementWithChannelActions::handleSetChannelConfigResult(
       setChannelConfigAttempts = 0;
       if (channelConfigState ==
           Supla::ChannelConfigState::SetChannelConfigSend) {
-        channelConfigState = Supla::ChannelConfigState::ResendConfig;
+        setChannelConfigState(Supla::ChannelConfigState::ResendConfig);
       } else {
-        channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+        setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
       }
     } else {
       clearChannelConfigChangedFlag();
@@ -473,7 +486,7 @@ void Supla::ElementWithChannelActions::handleSetChannelConfigResult(
 
   if (!success) {
     clearChannelConfigChangedFlag();
-    channelConfigState = Supla::ChannelConfigState::SetChannelConfigFailed;
+    setChannelConfigState(Supla::ChannelConfigState::SetChannelConfigFailed);
   }
 }
 
@@ -492,7 +505,7 @@ void Supla::ElementWithChannelActions::purgeConfig() {
 void Supla::ElementWithChannelActions::triggerSetChannelConfig(int configType) {
   // don't trigger setChannelConfig if it failed in previous attempt
   if (channelConfigState != Supla::ChannelConfigState::SetChannelConfigFailed) {
-    channelConfigState = Supla::ChannelConfigState::ResendConfig;
+    setChannelConfigState(Supla::ChannelConfigState::ResendConfig);
     receivedConfigTypes.clear(configType);
   }
 }
@@ -547,10 +560,10 @@ bool Supla::ElementWithChannelActions::iterateConfigExchange() {
                 nextConfigType);
             if (channelConfigState ==
                 Supla::ChannelConfigState::LocalChangePending) {
-              channelConfigState = Supla::ChannelConfigState::LocalChangeSent;
+              setChannelConfigState(Supla::ChannelConfigState::LocalChangeSent);
             } else {
-              channelConfigState =
-                  Supla::ChannelConfigState::SetChannelConfigSend;
+              setChannelConfigState(
+                  Supla::ChannelConfigState::SetChannelConfigSend);
             }
             sendResult = true;
           }
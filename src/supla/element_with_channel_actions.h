@@ -130,6 +130,10 @@ class ElementWithChannelActions : public Element, public LocalAction {
    * @return -1 if no more config types to be sent, otherwise the config type
    */
   int getNextConfigType() const;
+  // Sets channelConfigState and keeps element polled while config exchange
+  // is in progress
+  void setChannelConfigState(Supla::ChannelConfigState state);
+  bool isConfigExchangePending() const;
   Supla::ChannelConfigState channelConfigState =
       Supla::ChannelConfigState::None;
 
@@ -0,0 +1,90 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef SRC_SUPLA_INTRUSIVE_LIST_H_
+#define SRC_SUPLA_INTRUSIVE_LIST_H_
+
+namespace Supla {
+
+/**
+ * Helper for self-registering classes (Element, Channel, etc.), which keep
+ * all their instances on a global list in creation order.
+ *
+ * List head and tail pointers are owned by the class itself (usually as
+ * static members), and each instance provides "next" and "prev" pointers.
+ * Both append and remove are O(1).
+ *
+ * Example:
+ *   IntrusiveList<Foo, &Foo::nextPtr, &Foo::prevPtr>::append(
+ *       &firstPtr, &lastPtr, this);
+ *
+ * @tparam T class of list item
+ * @tparam NextPtr pointer to T's member which keeps next item
+ * @tparam PrevPtr pointer to T's member which keeps previous item
+ */
+template <typename T, T *T::*NextPtr, T *T::*PrevPtr>
+class IntrusiveList {
+ public:
+  /**
+   * Adds item at the end of the list
+   *
+   * @param first pointer to list head
+   * @param last pointer to list tail
+   * @param item item to be added
+   */
+  static void append(T **first, T **last, T *item) {
+    item->*NextPtr = nullptr;
+    item->*PrevPtr = *last;
+    if (*last == nullptr) {
+      *first = item;
+    } else {
+      (*last)->*NextPtr = item;
+    }
+    *last = item;
+  }
+
+  /**
+   * Removes item from the list. Item has to be on the list.
+   *
+   * @param first pointer to list head
+   * @param last pointer to list tail
+   * @param item item to be removed
+   */
+  static void remove(T **first, T **last, T *item) {
+    T *next = item->*NextPtr;
+    T *prev = item->*PrevPtr;
+    if (prev == nullptr) {
+      if (*first == item) {
+        *first = next;
+      }
+    } else {
+      prev->*NextPtr = next;
+    }
+    if (next == nullptr) {
+      if (*last == item) {
+        *last = prev;
+      }
+    } else {
+      next->*PrevPtr = prev;
+    }
+    item->*NextPtr = nullptr;
+    item->*PrevPtr = nullptr;
+  }
+};
+
+}  // namespace Supla
+
+#endif  // SRC_SUPLA_INTRUSIVE_LIST_H_
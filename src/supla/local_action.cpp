@@ -17,38 +17,29 @@
 #include "local_action.h"
 
 #include <supla/action_handler.h>
+#include <supla/intrusive_list.h>
 
 namespace Supla {
 
 ActionHandlerClient::ActionHandlerClient() {
-  if (begin == nullptr) {
-    begin = this;
-  } else {
-    auto ptr = begin;
-    while (ptr->next) {
-      ptr = ptr->next;
-    }
-    ptr->next = this;
-  }
+  IntrusiveList<ActionHandlerClient,
+                &ActionHandlerClient::next,
+                &ActionHandlerClient::prev>::append(&begin, &last, this);
 }
 
 ActionHandlerClient::~ActionHandlerClient() {
+  if (trigger) {
+    trigger->unlinkClient(this);
+  }
+
   if (client && client->deleteClient()) {
     delete client;
     client = nullptr;
   }
 
-  if (begin == this) {
-    begin = next;
-    return;
-  }
-
-  auto ptr = begin;
-  while (ptr->next != this) {
-    ptr = ptr->next;
-  }
-
-  ptr->next = ptr->next->next;
+  IntrusiveList<ActionHandlerClient,
+                &ActionHandlerClient::next,
+                &ActionHandlerClient::prev>::remove(&begin, &last, this);
 }
 
 bool ActionHandlerClient::isEnabled() {
@@ -74,12 +65,64 @@ bool ActionHandlerClient::isAlwaysEnabled() {
   return alwaysEnabled;
 }
 
+ActionHandlerClient *ActionHandlerClient::getNextForTrigger() const {
+  return nextForTrigger;
+}
+
 ActionHandlerClient *ActionHandlerClient::begin = nullptr;
+ActionHandlerClient *ActionHandlerClient::last = nullptr;
 
 LocalAction::~LocalAction() {
   DeleteActionsTriggeredBy(this);
 }
 
+void LocalAction::linkClient(ActionHandlerClient *handlerClient) {
+  handlerClient->nextForTrigger = nullptr;
+  if (triggerClients == nullptr) {
+    triggerClients = handlerClient;
+    return;
+  }
+
+  // insert after last client with the same event, or at the end
+  ActionHandlerClient *insertAfter = triggerClients;
+  bool eventFound = false;
+  for (auto ptr = triggerClients; ptr; ptr = ptr->nextForTrigger) {
+    if (ptr->onEvent == handlerClient->onEvent) {
+      eventFound = true;
+    } else if (eventFound) {
+      break;
+    }
+    insertAfter = ptr;
+  }
+
+  handlerClient->nextForTrigger = insertAfter->nextForTrigger;
+  insertAfter->nextForTrigger = handlerClient;
+}
+
+void LocalAction::unlinkClient(ActionHandlerClient *handlerClient) {
+  if (triggerClients == handlerClient) {
+    triggerClients = handlerClient->nextForTrigger;
+  } else {
+    auto ptr = triggerClients;
+    while (ptr && ptr->nextForTrigger != handlerClient) {
+      ptr = ptr->nextForTrigger;
+    }
+    if (ptr) {
+      ptr->nextForTrigger = handlerClient->nextForTrigger;
+    }
+  }
+  handlerClient->nextForTrigger = nullptr;
+}
+
+ActionHandlerClient *LocalAction::getFirstClientForEvent(
+    uint16_t event) const {
+  auto ptr = triggerClients;
+  while (ptr && ptr->onEvent != event) {
+    ptr = ptr->nextForTrigger;
+  }
+  return ptr;
+}
+
 void LocalAction::addAction(uint16_t action,
                             ActionHandler &client,
                             uint16_t event,
@@ -89,6 +132,7 @@ void LocalAction::addAction(uint16_t action,
   ptr->client = &client;
   ptr->onEvent = event;
   ptr->action = action;
+  linkClient(ptr);
   ptr->client->activateAction(action);
   if (alwaysEnabled) {
     ptr->setAlwaysEnabled();
@@ -103,13 +147,12 @@ void LocalAction::addAction(uint16_t action,
 }
 
 void LocalAction::runAction(uint16_t event) const {
-  auto ptr = ActionHandlerClient::begin;
-  while (ptr) {
-    if (ptr->client && ptr->trigger == this && ptr->onEvent == event &&
-        ptr->isEnabled()) {
+  auto ptr = getFirstClientForEvent(event);
+  while (ptr && ptr->onEvent == event) {
+    if (ptr->client && ptr->isEnabled()) {
       ptr->client->handleAction(event, ptr->action);
     }
-    ptr = ptr->next;
+    ptr = ptr->nextForTrigger;
   }
 }
 
@@ -118,13 +161,12 @@ ActionHandlerClient *LocalAction::getClientListPtr() {
 }
 
 bool LocalAction::isEventAlreadyUsed(uint16_t event, bool ignoreAlwaysEnabled) {
-  auto ptr = ActionHandlerClient::begin;
-  while (ptr) {
-    if (ptr->trigger == this && ptr->onEvent == event &&
-        (!ignoreAlwaysEnabled || !ptr->isAlwaysEnabled())) {
+  auto ptr = getFirstClientForEvent(event);
+  while (ptr && ptr->onEvent == event) {
+    if (!ignoreAlwaysEnabled || !ptr->isAlwaysEnabled()) {
       return true;
     }
-    ptr = ptr->next;
+    ptr = ptr->nextForTrigger;
   }
   return false;
 }
@@ -141,48 +183,38 @@ void LocalAction::enableOtherClients(const ActionHandler &client,
 
 void LocalAction::disableOtherClients(const ActionHandler *client,
                                       uint16_t event) {
-  auto ptr = ActionHandlerClient::begin;
-  while (ptr) {
-    if (ptr->trigger == this && ptr->onEvent == event &&
-        ptr->client != client) {
+  auto ptr = getFirstClientForEvent(event);
+  while (ptr && ptr->onEvent == event) {
+    if (ptr->client != client) {
       ptr->disable();
     }
-    ptr = ptr->next;
+    ptr = ptr->nextForTrigger;
   }
 }
 
 void LocalAction::enableOtherClients(const ActionHandler *client,
                                      uint16_t event) {
-  auto ptr = ActionHandlerClient::begin;
-  while (ptr) {
-    if (ptr->trigger == this && ptr->onEvent == event &&
-        ptr->client != client) {
+  auto ptr = getFirstClientForEvent(event);
+  while (ptr && ptr->onEvent == event) {
+    if (ptr->client != client) {
       ptr->enable();
     }
-    ptr = ptr->next;
+    ptr = ptr->nextForTrigger;
   }
 }
 
 ActionHandlerClient *LocalAction::getHandlerForFirstClient(uint16_t event) {
-  auto ptr = ActionHandlerClient::begin;
-  while (ptr) {
-    if (ptr->trigger == this && ptr->onEvent == event) {
-      return ptr;
-    }
-    ptr = ptr->next;
-  }
-  return nullptr;
+  return getFirstClientForEvent(event);
 }
 
 ActionHandlerClient *LocalAction::getHandlerForClient(ActionHandler *client,
                                                    uint16_t event) {
-  auto ptr = ActionHandlerClient::begin;
-  while (ptr) {
-    if (ptr->trigger == this && ptr->client == client
-        && ptr->onEvent == event) {
+  auto ptr = getFirstClientForEvent(event);
+  while (ptr && ptr->onEvent == event) {
+    if (ptr->client == client) {
       return ptr;
     }
-    ptr = ptr->next;
+    ptr = ptr->nextForTrigger;
   }
   return nullptr;
 }
@@ -194,7 +226,7 @@ bool LocalAction::disableActionsInConfigMode() {
 void LocalAction::disableAction(int32_t action,
                                 ActionHandler *client,
                                 int32_t event) {
-  auto ptr = ActionHandlerClient::begin;
+  auto ptr = triggerClients;
   bool allEvents = (event == -1);
   bool allActions = (action == -1);
   uint16_t eventToCheck = 0;
@@ -207,18 +239,18 @@ void LocalAction::disableAction(int32_t action,
   }
 
   while (ptr) {
-    if (ptr->trigger == this && (ptr->onEvent == eventToCheck || allEvents) &&
-        ptr->client == client && (ptr->action == actionToCheck || allActions)) {
+    if ((ptr->onEvent == eventToCheck || allEvents) && ptr->client == client &&
+        (ptr->action == actionToCheck || allActions)) {
       ptr->disable();
     }
-    ptr = ptr->next;
+    ptr = ptr->nextForTrigger;
   }
 }
 
 void LocalAction::enableAction(int32_t action,
                                ActionHandler *client,
                                int32_t event) {
-  auto ptr = ActionHandlerClient::begin;
+  auto ptr = triggerClients;
   bool allEvents = (event == -1);
   bool allActions = (action == -1);
   uint16_t eventToCheck = 0;
@@ -230,11 +262,11 @@ void LocalAction::enableAction(int32_t action,
     eventToCheck = static_cast<uint16_t>(event);
   }
   while (ptr) {
-    if (ptr->trigger == this && (ptr->onEvent == eventToCheck || allEvents) &&
-        ptr->client == client && (ptr->action == actionToCheck || allActions)) {
+    if ((ptr->onEvent == eventToCheck || allEvents) && ptr->client == client &&
+        (ptr->action == actionToCheck || allActions)) {
       ptr->enable();
     }
-    ptr = ptr->next;
+    ptr = ptr->nextForTrigger;
   }
 }
 
@@ -251,14 +283,12 @@ void LocalAction::DeleteActionsHandledBy(const ActionHandler *client) {
 }
 
 void LocalAction::DeleteActionsTriggeredBy(const LocalAction *trigger) {
-  auto ptr = ActionHandlerClient::begin;
-  while (ptr) {
-    auto next = ptr->next;
-    if (ptr->trigger == trigger) {
-      delete ptr;
-      next = ActionHandlerClient::begin;
-    }
-    ptr = next;
+  if (trigger == nullptr) {
+    return;
+  }
+  // ActionHandlerClient's destructor removes it from trigger's list
+  while (trigger->triggerClients) {
+    delete trigger->triggerClients;
   }
 }
 
@@ -44,7 +44,15 @@ class ActionHandlerClient {
   virtual void disable();
   virtual bool isAlwaysEnabled();
 
+  // Returns next client of the same trigger
+  ActionHandlerClient *getNextForTrigger() const;
+
  protected:
+  friend class LocalAction;
+  static ActionHandlerClient *last;
+  ActionHandlerClient *prev = nullptr;
+  // next client on trigger's list, see LocalAction::triggerClients
+  ActionHandlerClient *nextForTrigger = nullptr;
   bool enabled = true;
   bool alwaysEnabled = false;
 };
@@ -87,6 +95,17 @@ class LocalAction {
   virtual bool disableActionsInConfigMode();
 
   static ActionHandlerClient *getClientListPtr();
+
+ protected:
+  friend class ActionHandlerClient;
+  void linkClient(ActionHandlerClient *handlerClient);
+  void unlinkClient(ActionHandlerClient *handlerClient);
+  ActionHandlerClient *getFirstClientForEvent(uint16_t event) const;
+
+  // Clients created by this trigger (via addAction). Clients for the same
+  // event are kept next to each other in creation order, so event lookup
+  // doesn't have to iterate over actions of other triggers.
+  ActionHandlerClient *triggerClients = nullptr;
 };
 
 };  // namespace Supla
@@ -18,30 +18,21 @@
 
 #include "html_element.h"
 
+#include <supla/intrusive_list.h>
+
 namespace Supla {
 
 HtmlElement *HtmlElement::firstPtr = nullptr;
+HtmlElement *HtmlElement::lastPtr = nullptr;
 
 HtmlElement::HtmlElement(HtmlSection section) : section(section) {
-  if (firstPtr == nullptr) {
-    firstPtr = this;
-  } else {
-    last()->nextPtr = this;
-  }
+  IntrusiveList<HtmlElement, &HtmlElement::nextPtr, &HtmlElement::prevPtr>::
+      append(&firstPtr, &lastPtr, this);
 }
 
 HtmlElement::~HtmlElement() {
-  if (begin() == this) {
-    firstPtr = next();
-    return;
-  }
-
-  auto ptr = begin();
-  while (ptr->next() != this) {
-    ptr = ptr->next();
-  }
-
-  ptr->nextPtr = ptr->next()->next();
+  IntrusiveList<HtmlElement, &HtmlElement::nextPtr, &HtmlElement::prevPtr>::
+      remove(&firstPtr, &lastPtr, this);
 }
 
 HtmlElement *HtmlElement::begin() {
@@ -49,11 +40,7 @@ HtmlElement *HtmlElement::begin() {
 }
 
 HtmlElement *HtmlElement::last() {
-  auto ptr = firstPtr;
-  while (ptr && ptr->nextPtr) {
-    ptr = ptr->nextPtr;
-  }
-  return ptr;
+  return lastPtr;
 }
 
 HtmlElement *HtmlElement::next() {
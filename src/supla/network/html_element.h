@@ -53,7 +53,9 @@ class HtmlElement {
 
  protected:
   static HtmlElement *firstPtr;
+  static HtmlElement *lastPtr;
   HtmlElement *nextPtr = nullptr;
+  HtmlElement *prevPtr = nullptr;
 };
 
 };  // namespace Supla
@@ -17,6 +17,7 @@
  */
 
 #include <SuplaDevice.h>
+#include <supla/intrusive_list.h>
 
 #include "protocol_layer.h"
 
@@ -24,6 +25,7 @@ namespace Supla {
 namespace Protocol {
 
 ProtocolLayer *ProtocolLayer::firstPtr = nullptr;
+ProtocolLayer *ProtocolLayer::lastPtr = nullptr;
 
 bool ProtocolLayer::IsAnyUpdatePending() {
   auto *proto = first();
@@ -41,25 +43,15 @@ bool ProtocolLayer::isUpdatePending() {
 }
 
 ProtocolLayer::ProtocolLayer(SuplaDeviceClass *sdc) : sdc(sdc) {
-  if (firstPtr == nullptr) {
-    firstPtr = this;
-  } else {
-    last()->nextPtr = this;
-  }
+  IntrusiveList<ProtocolLayer,
+                &ProtocolLayer::nextPtr,
+                &ProtocolLayer::prevPtr>::append(&firstPtr, &lastPtr, this);
 }
 
 ProtocolLayer::~ProtocolLayer() {
-  if (first() == this) {
-    firstPtr = next();
-    return;
-  }
-
-  auto ptr = first();
-  while (ptr->next() != this) {
-    ptr = ptr->next();
-  }
-
-  ptr->nextPtr = ptr->next()->next();
+  IntrusiveList<ProtocolLayer,
+                &ProtocolLayer::nextPtr,
+                &ProtocolLayer::prevPtr>::remove(&firstPtr, &lastPtr, this);
 }
 
 ProtocolLayer *ProtocolLayer::first() {
@@ -67,11 +59,7 @@ ProtocolLayer *ProtocolLayer::first() {
 }
 
 ProtocolLayer *ProtocolLayer::last() {
-  ProtocolLayer *ptr = firstPtr;
-  while (ptr && ptr->nextPtr) {
-    ptr = ptr->nextPtr;
-  }
-  return ptr;
+  return lastPtr;
 }
 
 ProtocolLayer *ProtocolLayer::next() {
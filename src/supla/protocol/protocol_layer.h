@@ -92,7 +92,9 @@ class ProtocolLayer {
 
  protected:
   static ProtocolLayer *firstPtr;
+  static ProtocolLayer *lastPtr;
   ProtocolLayer *nextPtr = nullptr;
+  ProtocolLayer *prevPtr = nullptr;
   SuplaDeviceClass *sdc = nullptr;
   bool configEmpty = true;
   bool verboseLog = true;
@@ -43,6 +43,29 @@ struct CalCfgResultPendingItem {
 
   CalCfgResultPendingItem *next = nullptr;
 };
+
+struct ValueBatchItem {
+  uint8_t channelNumber = 0;
+  uint8_t offline = 0;
+  int8_t value[SUPLA_CHANNELVALUE_SIZE] = {};
+  uint32_t validityTimeSec = 0;
+  uint32_t queuedAtMs = 0;
+};
+
+struct ValueBatch {
+  static constexpr uint8_t NoSlot = 0xFF;
+
+  ValueBatch() {
+    memset(slotByChannel, NoSlot, sizeof(slotByChannel));
+  }
+
+  ValueBatchItem items[SUPLA_CHANNELMAXCOUNT];
+  uint8_t slotByChannel[SUPLA_CHANNELMAXCOUNT];
+  uint8_t count = 0;
+  bool flushInProgress = false;
+  uint16_t bufferUsed = 0;
+  uint8_t buffer[SUPLA_SRPC_VALUE_BATCH_BUFFER_SIZE];
+};
 }  // namespace Supla::Protocol
 
 bool Supla::Protocol::SuplaSrpc::isSuplaSSLEnabled = true;
@@ -56,6 +79,10 @@ Supla::Protocol::SuplaSrpc::SuplaSrpc(SuplaDeviceClass *sdc, int version)
 }
 
 Supla::Protocol::SuplaSrpc::~SuplaSrpc() {
+  if (valueBatch) {
+    delete valueBatch;
+    valueBatch = nullptr;
+  }
   if (client) {
     delete client;
     client = nullptr;
@@ -238,6 +265,9 @@ _supla_int_t Supla::dataRead(void *buf, _supla_int_t count, void *userParams) {
 
 _supla_int_t Supla::dataWrite(void *buf, _supla_int_t count, void *userParams) {
   auto srpcLayer = reinterpret_cast<Supla::Protocol::SuplaSrpc *>(userParams);
+  if (srpcLayer->appendToValueBatchBuffer(buf, count)) {
+    return count;
+  }
   _supla_int_t r =
       srpcLayer->client->write(reinterpret_cast<uint8_t *>(buf), count);
   if (r > 0) {
@@ -970,6 +1000,10 @@ bool Supla::Protocol::SuplaSrpc::iterate(uint32_t _millis) {
     }
   }
 
+  if (isRegisteredAndReady()) {
+    flushValueBatch();
+  }
+
   if (srpc_iterate_device(srpc) == SUPLA_RESULT_FALSE) {
     sdc->status(STATUS_ITERATE_FAIL, F("Communication failure"));
     disconnect();
@@ -1191,6 +1225,7 @@ void Supla::Protocol::SuplaSrpc::sendChannelStateResult(int32_t receiverId,
     element->handleGetChannelState(&state);
   }
 
+  flushValueBatchChannel(channelNo);
   srpc_csd_async_channel_state_result(srpc, &state);
 }
 
@@ -1204,6 +1239,9 @@ bool Supla::Protocol::SuplaSrpc::isUpdatePending() {
       return true;
     }
   }
+  if (valueBatch && valueBatch->count > 0) {
+    return true;
+  }
   return Supla::Element::IsAnyUpdatePending();
 }
 
@@ -1221,6 +1259,8 @@ void Supla::Protocol::SuplaSrpc::sendActionTrigger(uint8_t channelNumber,
   at.ChannelNumber = channelNumber;
   at.ActionTrigger = actionId;
 
+  flushValueBatchChannel(channelNumber);
+
   srpc_ds_async_action_trigger(srpc, &at);
 }
 
@@ -1279,6 +1319,25 @@ void Supla::Protocol::SuplaSrpc::sendChannelValueChanged(
   if (!isRegisteredAndReady()) {
     return;
   }
+  if (valueBatch && channelNumber < SUPLA_CHANNELMAXCOUNT) {
+    valueBatchStats.queued++;
+    uint8_t slot = valueBatch->slotByChannel[channelNumber];
+    if (slot == ValueBatch::NoSlot) {
+      slot = valueBatch->count++;
+      valueBatch->slotByChannel[channelNumber] = slot;
+      valueBatch->items[slot].channelNumber = channelNumber;
+      valueBatch->items[slot].queuedAtMs = millis();
+    } else {
+      // older value wasn't sent yet, so it is replaced, but we keep its
+      // position in the batch and its queue time
+      valueBatchStats.coalesced++;
+    }
+    auto &item = valueBatch->items[slot];
+    memcpy(item.value, value, SUPLA_CHANNELVALUE_SIZE);
+    item.offline = offline;
+    item.validityTimeSec = validityTimeSec;
+    return;
+  }
   srpc_ds_async_channel_value_changed_c(srpc,
                                         channelNumber,
                                         reinterpret_cast<char *>(value),
@@ -1291,6 +1350,7 @@ void Supla::Protocol::SuplaSrpc::sendExtendedChannelValueChanged(
   if (!isRegisteredAndReady()) {
     return;
   }
+  flushValueBatchChannel(channelNumber);
   srpc_ds_async_channel_extendedvalue_changed(srpc, channelNumber, value);
 }
 
@@ -1302,6 +1362,7 @@ void Supla::Protocol::SuplaSrpc::getChannelConfig(uint8_t channelNumber,
   TDS_GetChannelConfigRequest request = {};
   request.ChannelNumber = channelNumber;
   request.ConfigType = configType;
+  flushValueBatchChannel(channelNumber);
   srpc_ds_async_get_channel_config_request(srpc, &request);
 }
 
@@ -1325,6 +1386,7 @@ bool Supla::Protocol::SuplaSrpc::setChannelConfig(uint8_t channelNumber,
   request.ConfigType = configType;
   request.ConfigSize = size;
   memcpy(request.Config, channelConfig, size);
+  flushValueBatchChannel(channelNumber);
   srpc_ds_async_set_channel_config_request(srpc, &request);
   return true;
 }
@@ -1356,6 +1418,7 @@ bool Supla::Protocol::SuplaSrpc::setInitialCaption(uint8_t channelNumber,
   strncpy(request->Caption, caption, SUPLA_CAPTION_MAXSIZE);
   request->Caption[SUPLA_CAPTION_MAXSIZE - 1] = '\0';
   request->CaptionSize = strnlen(request->Caption, SUPLA_CAPTION_MAXSIZE) + 1;
+  flushValueBatchChannel(channelNumber);
   srpc_dcs_async_set_channel_caption(srpc, request);
   delete request;
   return true;
@@ -1487,6 +1550,7 @@ void Supla::Protocol::SuplaSrpc::sendRemainingTimeValue(uint8_t channelNumber,
                   timeMs,
                   channelNumber,
                   state);
+  flushValueBatchChannel(channelNumber);
   srpc_ds_async_channel_extendedvalue_changed(srpc, channelNumber, value);
   delete value;
 }
@@ -1525,6 +1589,7 @@ void Supla::Protocol::SuplaSrpc::sendRemainingTimeValue(
                   remainingTime,
                   useSecondsInsteadOfMs ? "s" : "ms",
                   channelNumber);
+  flushValueBatchChannel(channelNumber);
   srpc_ds_async_channel_extendedvalue_changed(srpc, channelNumber, value);
   delete value;
 }
@@ -1630,6 +1695,9 @@ void Supla::Protocol::SuplaSrpc::sendPendingCalCfgResult(int16_t channelNo,
   SUPLA_LOG_DEBUG("Sending CALCFG result: CMD %d result: %d",
                   result.Command,
                   result.Result);
+  if (channelNo >= 0) {
+    flushValueBatchChannel(channelNo);
+  }
   srpc_ds_async_device_calcfg_result(srpc, &result);
 }
 
@@ -1664,9 +1732,149 @@ void Supla::Protocol::SuplaSrpc::deinitializeSrpc() {
     srpc = nullptr;
   }
   setDeviceConfigReceivedAfterRegistration = false;
+  // all channel values are sent again during registration
+  clearValueBatch();
 }
 
 void Supla::Protocol::SuplaSrpc::setChannelConflictResolver(
     Supla::Device::ChannelConflictResolver *resolver) {
   channelConflictResolver = resolver;
 }
+
+void Supla::Protocol::SuplaSrpc::setValueBatching(bool enable) {
+  if (enable && valueBatch == nullptr) {
+    valueBatch = new ValueBatch;
+    // with one element update per iteration, batch is flushed after each
+    // value, so nothing would be coalesced
+    if (sdc) {
+      sdc->setIterateConnectedPolicy(
+          Supla::IterateConnectedPolicy::AllElementsPerIteration);
+    }
+  } else if (!enable && valueBatch != nullptr) {
+    flushValueBatch();
+    delete valueBatch;
+    valueBatch = nullptr;
+  }
+}
+
+bool Supla::Protocol::SuplaSrpc::isValueBatchingEnabled() const {
+  return valueBatch != nullptr;
+}
+
+void Supla::Protocol::SuplaSrpc::flushValueBatch() {
+  if (valueBatch == nullptr || valueBatch->count == 0 ||
+      valueBatch->flushInProgress) {
+    return;
+  }
+  if (!isRegisteredAndReady()) {
+    clearValueBatch();
+    return;
+  }
+
+  uint32_t now = millis();
+  valueBatch->flushInProgress = true;
+  for (int i = 0; i < valueBatch->count; i++) {
+    auto &item = valueBatch->items[i];
+    valueBatch->slotByChannel[item.channelNumber] = ValueBatch::NoSlot;
+    srpc_ds_async_channel_value_changed_c(srpc,
+                                          item.channelNumber,
+                                          reinterpret_cast<char *>(item.value),
+                                          item.offline,
+                                          item.validityTimeSec);
+    uint32_t latency = now - item.queuedAtMs;
+    valueBatchStats.sent++;
+    valueBatchStats.totalLatencyMs += latency;
+    if (latency > valueBatchStats.maxLatencyMs) {
+      valueBatchStats.maxLatencyMs = latency;
+    }
+  }
+  valueBatch->count = 0;
+  writeValueBatchBuffer();
+  valueBatch->flushInProgress = false;
+  valueBatchStats.flushes++;
+}
+
+void Supla::Protocol::SuplaSrpc::flushValueBatchChannel(
+    uint8_t channelNumber) {
+  if (valueBatch == nullptr || valueBatch->count == 0 ||
+      valueBatch->flushInProgress || channelNumber >= SUPLA_CHANNELMAXCOUNT ||
+      !isRegisteredAndReady()) {
+    return;
+  }
+  uint8_t slot = valueBatch->slotByChannel[channelNumber];
+  if (slot == ValueBatch::NoSlot) {
+    return;
+  }
+
+  auto &item = valueBatch->items[slot];
+  srpc_ds_async_channel_value_changed_c(srpc,
+                                        item.channelNumber,
+                                        reinterpret_cast<char *>(item.value),
+                                        item.offline,
+                                        item.validityTimeSec);
+  uint32_t latency = millis() - item.queuedAtMs;
+  valueBatchStats.sent++;
+  valueBatchStats.totalLatencyMs += latency;
+  if (latency > valueBatchStats.maxLatencyMs) {
+    valueBatchStats.maxLatencyMs = latency;
+  }
+
+  // remove sent value and keep order of remaining ones
+  valueBatch->slotByChannel[channelNumber] = ValueBatch::NoSlot;
+  valueBatch->count--;
+  for (int i = slot; i < valueBatch->count; i++) {
+    valueBatch->items[i] = valueBatch->items[i + 1];
+    valueBatch->slotByChannel[valueBatch->items[i].channelNumber] = i;
+  }
+}
+
+const Supla::Protocol::ValueBatchStats &
+Supla::Protocol::SuplaSrpc::getValueBatchStats() const {
+  return valueBatchStats;
+}
+
+void Supla::Protocol::SuplaSrpc::resetValueBatchStats() {
+  valueBatchStats = {};
+}
+
+bool Supla::Protocol::SuplaSrpc::appendToValueBatchBuffer(const void *buf,
+                                                          _supla_int_t count) {
+  if (valueBatch == nullptr || !valueBatch->flushInProgress || count <= 0) {
+    return false;
+  }
+  if (valueBatch->bufferUsed + count > SUPLA_SRPC_VALUE_BATCH_BUFFER_SIZE) {
+    writeValueBatchBuffer();
+    if (count > SUPLA_SRPC_VALUE_BATCH_BUFFER_SIZE) {
+      valueBatchStats.socketWrites++;
+      return false;
+    }
+  }
+  memcpy(valueBatch->buffer + valueBatch->bufferUsed, buf, count);
+  valueBatch->bufferUsed += count;
+  return true;
+}
+
+void Supla::Protocol::SuplaSrpc::writeValueBatchBuffer() {
+  if (valueBatch == nullptr || valueBatch->bufferUsed == 0) {
+    return;
+  }
+  if (client) {
+    if (client->write(valueBatch->buffer, valueBatch->bufferUsed) > 0) {
+      updateLastSentTime();
+    }
+  }
+  valueBatchStats.socketWrites++;
+  valueBatch->bufferUsed = 0;
+}
+
+void Supla::Protocol::SuplaSrpc::clearValueBatch() {
+  if (valueBatch == nullptr) {
+    return;
+  }
+  for (int i = 0; i < valueBatch->count; i++) {
+    valueBatch->slotByChannel[valueBatch->items[i].channelNumber] =
+        ValueBatch::NoSlot;
+  }
+  valueBatch->count = 0;
+  valueBatch->bufferUsed = 0;
+}
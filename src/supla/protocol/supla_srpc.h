@@ -26,6 +26,10 @@
 #define SUPLA_SRPC_CALCFG_RESULT_DONT_REPLY (-1)
 #define SUPLA_SRPC_CALCFG_RESULT_PENDING (-2)
 
+#ifndef SUPLA_SRPC_VALUE_BATCH_BUFFER_SIZE
+#define SUPLA_SRPC_VALUE_BATCH_BUFFER_SIZE 1024
+#endif
+
 namespace Supla {
 
 class Client;
@@ -38,6 +42,20 @@ class RemoteDeviceConfig;
 namespace Protocol {
 
 struct CalCfgResultPendingItem;
+struct ValueBatch;
+
+/**
+ * Counters of batched channel value updates.
+ */
+struct ValueBatchStats {
+  uint32_t queued = 0;          // values passed to sendChannelValueChanged
+  uint32_t coalesced = 0;       // values replaced by newer value before send
+  uint32_t sent = 0;            // values sent to the server
+  uint32_t flushes = 0;         // non-empty batch flushes
+  uint32_t socketWrites = 0;    // network client writes done during flushes
+  uint32_t maxLatencyMs = 0;    // max time between queueing and sending
+  uint32_t totalLatencyMs = 0;  // sum of latencies of all sent values
+};
 
 class CalCfgResultPending {
  public:
@@ -140,11 +158,56 @@ class SuplaSrpc : public ProtocolLayer {
   void setChannelConflictResolver(
       Supla::Device::ChannelConflictResolver *resolver);
 
+  /**
+   * Enables batching of channel value updates.
+   *
+   * When enabled, sendChannelValueChanged only stores the value (a newer value
+   * for the same channel replaces the older one) and all stored values are
+   * sent in order of their first change on the next iterate, or when
+   * flushValueBatch is called. Packets generated during flush are collected
+   * in a SUPLA_SRPC_VALUE_BATCH_BUFFER_SIZE buffer, so they are passed to the
+   * network client in as few writes as possible.
+   * Extended values and other messages are not batched. Stored value of a
+   * channel is sent before any other message for this channel, so server
+   * receives them in the same order as without batching.
+   *
+   * Enabling batching switches SuplaDevice to
+   * IterateConnectedPolicy::AllElementsPerIteration, because with one element
+   * update per iteration the batch is flushed after each value. Policy can be
+   * changed back with SuplaDeviceClass::setIterateConnectedPolicy().
+   *
+   * @param enable true to enable batching
+   */
+  void setValueBatching(bool enable);
+  bool isValueBatchingEnabled() const;
+
+  /**
+   * Sends all stored channel values to the server
+   */
+  void flushValueBatch();
+  const ValueBatchStats &getValueBatchStats() const;
+  void resetValueBatchStats();
+
+  /**
+   * Used by dataWrite callback. Stores data in the batch buffer when
+   * batch flush is in progress.
+   *
+   * @param buf data to be sent
+   * @param count size of data
+   *
+   * @return true if data was stored, false if it should be written directly
+   */
+  bool appendToValueBatchBuffer(const void *buf, _supla_int_t count);
+
  protected:
   bool ping();
   void initializeSrpc();
   void deinitializeSrpc();
   void addLastStateAdError(char *buf);
+  void clearValueBatch();
+  void writeValueBatchBuffer();
+  // sends stored value of the channel, if there is any
+  void flushValueBatchChannel(uint8_t channelNumber);
 
   uint8_t version = 0;
   uint8_t activityTimeoutS = 30;
@@ -171,6 +234,8 @@ class SuplaSrpc : public ProtocolLayer {
   const char *selectedCertificate = nullptr;
   void *srpc = nullptr;
   Supla::Device::ChannelConflictResolver *channelConflictResolver = nullptr;
+  ValueBatch *valueBatch = nullptr;
+  ValueBatchStats valueBatchStats;
 
  private:
   Supla::Device::RemoteDeviceConfig *remoteDeviceConfig = nullptr;
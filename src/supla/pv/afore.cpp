@@ -40,6 +40,8 @@ Afore::Afore(IPAddress ip, int port, const char *loginAndPass)
       dataIsReady(false),
       dataFetchInProgress(false),
       connectionTimeoutMs(0) {
+  // inverter is queried in iterateConnected()
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, true);
   refreshRateSec = 15;
   int len = strlen(loginAndPass);
   if (len > LOGIN_AND_PASSOWORD_MAX_LENGTH) {
@@ -37,6 +37,8 @@ Fronius::Fronius(IPAddress ip, int port, int deviceId, int deviceType)
     port(port),
     deviceType(deviceType),
     deviceId(deviceId) {
+  // inverter is queried in iterateConnected()
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, true);
   if (deviceType == FRONIUS_SINGLE_PHASE_INVERTER) {
     extChannel.setFlag(SUPLA_CHANNEL_FLAG_PHASE2_UNSUPPORTED);
     extChannel.setFlag(SUPLA_CHANNEL_FLAG_PHASE3_UNSUPPORTED);
@@ -43,6 +43,8 @@ SolarEdge::SolarEdge(const char *apiKeyValue,
                      const char *inverterSerialNumberValue,
                      Supla::Clock *clock)
     : clock(clock) {
+  // SolarEdge API is queried in iterateConnected()
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, true);
   // SolarEdge api allows 300 requests daily, so it is one request per almost 5
   // min
   refreshRateSec = 6 * 60;  // refresh every 6 min
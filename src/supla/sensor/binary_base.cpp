@@ -31,6 +31,7 @@ using Supla::Sensor::BinaryBase;
 
 
 BinaryBase::BinaryBase() {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_BINARYSENSOR);
   channel.setFlag(SUPLA_CHANNEL_FLAG_RUNTIME_CHANNEL_CONFIG_UPDATE);
   usedConfigTypes.set(SUPLA_CONFIG_TYPE_DEFAULT);
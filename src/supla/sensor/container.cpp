@@ -31,6 +31,7 @@
 using Supla::Sensor::Container;
 
 Container::Container() {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_CONTAINER);
   setFunction(SUPLA_CHANNELFNC_CONTAINER);
   channel.setContainerFillValue(-1);
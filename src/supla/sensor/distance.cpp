@@ -18,6 +18,7 @@
 #include <supla/time.h>
 
 Supla::Sensor::Distance::Distance() {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_DISTANCESENSOR);
   channel.setDefaultFunction(SUPLA_CHANNELFNC_DISTANCESENSOR);
   channel.setNewValue(DISTANCE_NOT_AVAILABLE);
@@ -32,6 +32,7 @@
 #include "electricity_meter.h"
 
 Supla::Sensor::ElectricityMeter::ElectricityMeter() {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   extChannel.setType(SUPLA_CHANNELTYPE_ELECTRICITY_METER);
   extChannel.setDefaultFunction(SUPLA_CHANNELFNC_ELECTRICITY_METER);
   extChannel.setFlag(SUPLA_CHANNEL_FLAG_CALCFG_RESET_COUNTERS);
@@ -40,10 +41,20 @@ Supla::Sensor::ElectricityMeter::ElectricityMeter() {
   usedConfigTypes.set(SUPLA_CONFIG_TYPE_DEFAULT);
 }
 
+Supla::Sensor::ElectricityMeter::~ElectricityMeter() {
+  delete aggregator;
+  delete deadband;
+}
+
 void Supla::Sensor::ElectricityMeter::updateChannelValues() {
   if (!valueChanged && lastChannelUpdateTime != 0) {
     return;
   }
+  if (deadband != nullptr && lastChannelUpdateTime != 0 &&
+      !isReportRequired()) {
+    // valueChanged is kept, so change is checked again on next update
+    return;
+  }
   valueChanged = false;
 
   // Update current messurement precision based on last updates
@@ -156,8 +167,16 @@ void Supla::Sensor::ElectricityMeter::updateChannelValues() {
 
   // Prepare extended channel value
   srpc_evtool_v3_emextended2extended(&emValue, extChannel.getExtValue());
-  if (lastChannelUpdateTime == 0 ||
-      millis() - lastChannelUpdateTime >= refreshRateSec * 1000) {
+  if (deadband != nullptr) {
+    lastChannelUpdateTime = millis();
+    extChannel.setNewValue(emValue);
+    deadband->setReported(emValue,
+                          rawCurrent,
+                          rawActivePower,
+                          rawReactivePower,
+                          rawApparentPower);
+  } else if (lastChannelUpdateTime == 0 ||
+             millis() - lastChannelUpdateTime >= refreshRateSec * 1000) {
     lastChannelUpdateTime = millis();
     extChannel.setNewValue(emValue);
   }
@@ -540,7 +559,7 @@ void Supla::Sensor::ElectricityMeter::onLoadConfig(SuplaDeviceClass *) {
     }
 
     if (configChange) {
-      channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+      setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
       saveConfigChangeFlag();
     }
 
@@ -735,13 +754,135 @@ void Supla::Sensor::ElectricityMeter::onInit() {
 }
 
 void Supla::Sensor::ElectricityMeter::iterateAlways() {
+  if (aggregator != nullptr && (lastSampleTime == 0 ||
+                                millis() - lastSampleTime >=
+                                    samplingIntervalMs)) {
+    lastSampleTime = millis();
+    readValuesFromDevice();
+    addSampleToAggregator();
+  }
   if (lastReadTime == 0 || millis() - lastReadTime > refreshRateSec * 1000) {
     lastReadTime = millis();
-    readValuesFromDevice();
+    if (aggregator != nullptr) {
+      applyAggregatedValues();
+    } else {
+      readValuesFromDevice();
+    }
     updateChannelValues();
   }
 }
 
+void Supla::Sensor::ElectricityMeter::setSamplingIntervalMs(
+    uint16_t intervalMs) {
+  SUPLA_LOG_INFO("EM[%d]: setSamplingIntervalMs: %d", getChannelNumber(),
+                 intervalMs);
+  samplingIntervalMs = intervalMs;
+  if (samplingIntervalMs == 0) {
+    delete aggregator;
+    aggregator = nullptr;
+  } else if (aggregator == nullptr) {
+    aggregator = new EmAggregator;
+    lastSampleTime = 0;
+  }
+}
+
+uint16_t Supla::Sensor::ElectricityMeter::getSamplingIntervalMs() const {
+  return samplingIntervalMs;
+}
+
+bool Supla::Sensor::ElectricityMeter::getAggregate(
+    EmMeasurement measurement, int phase, EmAggregate *result) const {
+  if (aggregator == nullptr) {
+    return false;
+  }
+  return aggregator->getAggregate(measurement, phase, result);
+}
+
+void Supla::Sensor::ElectricityMeter::setDeadband(EmDeadbandField field,
+                                                  uint32_t absolute,
+                                                  uint16_t relativePermille) {
+  getDeadband()->setDeadband(field, absolute, relativePermille);
+}
+
+void Supla::Sensor::ElectricityMeter::setReportIntervalMs(
+    uint32_t minIntervalMs, uint32_t maxIntervalMs) {
+  getDeadband()->setReportIntervalMs(minIntervalMs, maxIntervalMs);
+}
+
+Supla::Sensor::EmDeadband *Supla::Sensor::ElectricityMeter::getDeadband() {
+  if (deadband == nullptr) {
+    deadband = new EmDeadband;
+  }
+  return deadband;
+}
+
+bool Supla::Sensor::ElectricityMeter::isReportRequired() const {
+  uint32_t elapsed = millis() - lastChannelUpdateTime;
+  if (elapsed < deadband->getMinReportIntervalMs()) {
+    return false;
+  }
+  uint32_t maxInterval = deadband->getMaxReportIntervalMs();
+  if (maxInterval != 0 && elapsed >= maxInterval) {
+    return true;
+  }
+  return deadband->isChangeSignificant(emValue,
+                                       rawCurrent,
+                                       rawActivePower,
+                                       rawReactivePower,
+                                       rawApparentPower);
+}
+
+void Supla::Sensor::ElectricityMeter::addSampleToAggregator() {
+  if (emValue.m_count == 0) {
+    // no valid measurements (i.e. communication error)
+    return;
+  }
+  for (int i = 0; i < MAX_PHASES; i++) {
+    if (emValue.measured_values & EM_VAR_VOLTAGE) {
+      aggregator->addSample(
+          EmMeasurement::Voltage, i, emValue.m[0].voltage[i]);
+    }
+    if (currentMeasurementAvailable) {
+      aggregator->addSample(EmMeasurement::Current, i, rawCurrent[i]);
+    }
+    if (powerActiveMeasurementAvailable) {
+      aggregator->addSample(EmMeasurement::PowerActive, i, rawActivePower[i]);
+    }
+    if (powerReactiveMeasurementAvailable) {
+      aggregator->addSample(
+          EmMeasurement::PowerReactive, i, rawReactivePower[i]);
+    }
+    if (powerApparentMeasurementAvailable) {
+      aggregator->addSample(
+          EmMeasurement::PowerApparent, i, rawApparentPower[i]);
+    }
+  }
+}
+
+void Supla::Sensor::ElectricityMeter::applyAggregatedValues() {
+  aggregator->closeWindow();
+  EmAggregate aggregate;
+  for (int i = 0; i < MAX_PHASES; i++) {
+    if (aggregator->getAggregate(EmMeasurement::Voltage, i, &aggregate)) {
+      setVoltage(i, aggregate.mean);
+    }
+    if (aggregator->getAggregate(EmMeasurement::Current, i, &aggregate)) {
+      setCurrent(i, aggregate.mean);
+    }
+    if (aggregator->getAggregate(EmMeasurement::PowerActive, i, &aggregate)) {
+      setPowerActive(i, aggregate.mean);
+    }
+    if (aggregator->getAggregate(
+            EmMeasurement::PowerReactive, i, &aggregate)) {
+      setPowerReactive(i, aggregate.mean);
+    }
+    if (aggregator->getAggregate(
+            EmMeasurement::PowerApparent, i, &aggregate)) {
+      setPowerApparent(i, aggregate.mean);
+    }
+  }
+}
+
 // Implement this method to reset stored energy value (i.e. to set energy
 // counter back to 0 kWh
 void Supla::Sensor::ElectricityMeter::resetStorage() {
@@ -25,6 +25,8 @@
 
 #include "../channel_extended.h"
 #include "../local_action.h"
+#include "em_aggregator.h"
+#include "em_deadband.h"
 
 #define MAX_PHASES 3
 
@@ -67,6 +69,7 @@ class ElectricityMeter : public ElementWithChannelActions,
                          public ActionHandler {
  public:
   ElectricityMeter();
+  virtual ~ElectricityMeter();
 
   virtual void updateChannelValues();
 
@@ -379,6 +382,55 @@ class ElectricityMeter : public ElementWithChannelActions,
 
   void sendDataWithDelay(int delayMs = 0);
 
+  /**
+   * Enables sampling of the device with given interval. Voltage, current and
+   * powers of each phase are aggregated (min/max/mean) over reporting window
+   * (refresh rate) and channel value contains mean values of the window.
+   * Min and max values are available with getAggregate(), i.e. for
+   * EmAggregateMeasurement channels.
+   *
+   * @param intervalMs sampling interval in ms, 0 disables sampling (default),
+   *                   then device is read once per refresh rate
+   */
+  void setSamplingIntervalMs(uint16_t intervalMs);
+  uint16_t getSamplingIntervalMs() const;
+
+  /**
+   * Returns aggregate of measurement from last reporting window.
+   *
+   * @param measurement
+   * @param phase 0..2
+   * @param result
+   *
+   * @return false if sampling is disabled or measurement wasn't available
+   */
+  bool getAggregate(EmMeasurement measurement,
+                    int phase,
+                    EmAggregate *result) const;
+
+  /**
+   * Sets deadband of field. When any deadband or report interval is set,
+   * extended value is rebuilt and sent only when at least one field changed
+   * more than its deadband since last report. Fields without deadband are
+   * reported on any change.
+   *
+   * @param field
+   * @param absolute in units of field (i.e. 0.01 V for voltage)
+   * @param relativePermille in 0.1 % of last reported value
+   */
+  void setDeadband(EmDeadbandField field,
+                   uint32_t absolute,
+                   uint16_t relativePermille = 0);
+
+  /**
+   * Sets report intervals used with deadbands.
+   *
+   * @param minIntervalMs values are not reported more often
+   * @param maxIntervalMs change within deadband is reported after this time,
+   *                      0 - never
+   */
+  void setReportIntervalMs(uint32_t minIntervalMs, uint32_t maxIntervalMs);
+
   Channel *getChannel() override;
   const Channel *getChannel() const override;
   void purgeConfig() override;
@@ -396,6 +448,14 @@ class ElectricityMeter : public ElementWithChannelActions,
   bool isPhaseLedTypeSupported(uint64_t ledType) const;
 
  protected:
+  // Adds current measurements to aggregator
+  void addSampleToAggregator();
+  // Closes aggregation window and sets mean values on channel
+  void applyAggregatedValues();
+  // Returns true if values should be reported with deadbands in use
+  bool isReportRequired() const;
+  EmDeadband *getDeadband();
+
   TElectricityMeter_ExtendedValue_V3 emValue = {};
   ChannelExtended extChannel;
   uint32_t lastChannelUpdateTime = 0;
@@ -406,6 +466,10 @@ class ElectricityMeter : public ElementWithChannelActions,
 
   uint32_t lastReadTime = 0;
   uint16_t refreshRateSec = 5;
+  EmAggregator *aggregator = nullptr;
+  uint32_t lastSampleTime = 0;
+  uint16_t samplingIntervalMs = 0;
+  EmDeadband *deadband = nullptr;
   bool valueChanged = false;
   bool currentMeasurementAvailable = false;
   bool powerActiveMeasurementAvailable = false;
@@ -0,0 +1,106 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef SRC_SUPLA_SENSOR_EM_AGGREGATE_MEASUREMENT_H_
+#define SRC_SUPLA_SENSOR_EM_AGGREGATE_MEASUREMENT_H_
+
+#include <math.h>
+
+#include "electricity_meter.h"
+#include "general_purpose_measurement.h"
+
+namespace Supla {
+namespace Sensor {
+
+/**
+ * GPM channel with min, max or mean value of ElectricityMeter measurement
+ * from last reporting window. Sampling has to be enabled on meter with
+ * ElectricityMeter::setSamplingIntervalMs().
+ */
+class EmAggregateMeasurement : public GeneralPurposeMeasurement {
+ public:
+  EmAggregateMeasurement(ElectricityMeter *em,
+                         EmMeasurement measurement,
+                         int phase,
+                         EmAggregateType type)
+      : GeneralPurposeMeasurement(nullptr, false),
+        em(em),
+        measurement(measurement),
+        phase(phase),
+        type(type) {
+    switch (measurement) {
+      case EmMeasurement::Voltage: {
+        setDefaultUnitAfterValue("V");
+        setDefaultValuePrecision(2);
+        break;
+      }
+      case EmMeasurement::Current: {
+        setDefaultUnitAfterValue("A");
+        setDefaultValuePrecision(3);
+        break;
+      }
+      case EmMeasurement::PowerActive: {
+        setDefaultUnitAfterValue("W");
+        setDefaultValuePrecision(2);
+        break;
+      }
+      case EmMeasurement::PowerReactive: {
+        setDefaultUnitAfterValue("var");
+        setDefaultValuePrecision(2);
+        break;
+      }
+      case EmMeasurement::PowerApparent: {
+        setDefaultUnitAfterValue("VA");
+        setDefaultValuePrecision(2);
+        break;
+      }
+    }
+  }
+
+ protected:
+  double getValue() override {
+    EmAggregate aggregate;
+    if (em == nullptr || !em->getAggregate(measurement, phase, &aggregate)) {
+      return NAN;
+    }
+    int64_t value = aggregate.mean;
+    if (type == EmAggregateType::Min) {
+      value = aggregate.min;
+    } else if (type == EmAggregateType::Max) {
+      value = aggregate.max;
+    }
+    switch (measurement) {
+      case EmMeasurement::Voltage:
+        return value / 100.0;
+      case EmMeasurement::Current:
+        return value / 1000.0;
+      default:
+        return value / 100000.0;
+    }
+  }
+
+  ElectricityMeter *em = nullptr;
+  EmMeasurement measurement = EmMeasurement::Voltage;
+  int phase = 0;
+  EmAggregateType type = EmAggregateType::Mean;
+};
+
+}  // namespace Sensor
+}  // namespace Supla
+
+#endif  // SRC_SUPLA_SENSOR_EM_AGGREGATE_MEASUREMENT_H_
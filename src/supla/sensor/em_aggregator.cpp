@@ -0,0 +1,74 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "em_aggregator.h"
+
+using Supla::Sensor::EmAggregator;
+
+void EmAggregator::addSample(EmMeasurement measurement,
+                             int phase,
+                             int64_t value) {
+  int index = static_cast<int>(measurement);
+  if (index < 0 || index >= EM_AGGREGATOR_MEASUREMENTS || phase < 0 ||
+      phase >= EM_AGGREGATOR_PHASES) {
+    return;
+  }
+  auto &acc = current[index][phase];
+  if (acc.samples == UINT16_MAX) {
+    return;
+  }
+  if (acc.samples == 0 || value < acc.min) {
+    acc.min = value;
+  }
+  if (acc.samples == 0 || value > acc.max) {
+    acc.max = value;
+  }
+  acc.sum += value;
+  acc.samples++;
+}
+
+void EmAggregator::closeWindow() {
+  for (int i = 0; i < EM_AGGREGATOR_MEASUREMENTS; i++) {
+    for (int phase = 0; phase < EM_AGGREGATOR_PHASES; phase++) {
+      auto &acc = current[i][phase];
+      auto &result = last[i][phase];
+      result.samples = acc.samples;
+      if (acc.samples > 0) {
+        result.min = acc.min;
+        result.max = acc.max;
+        result.mean = acc.sum / acc.samples;
+      }
+      acc = {};
+    }
+  }
+}
+
+bool EmAggregator::getAggregate(EmMeasurement measurement,
+                                int phase,
+                                EmAggregate *result) const {
+  int index = static_cast<int>(measurement);
+  if (result == nullptr || index < 0 || index >= EM_AGGREGATOR_MEASUREMENTS ||
+      phase < 0 || phase >= EM_AGGREGATOR_PHASES) {
+    return false;
+  }
+  if (last[index][phase].samples == 0) {
+    return false;
+  }
+  *result = last[index][phase];
+  return true;
+}
@@ -0,0 +1,85 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef SRC_SUPLA_SENSOR_EM_AGGREGATOR_H_
+#define SRC_SUPLA_SENSOR_EM_AGGREGATOR_H_
+
+#include <stdint.h>
+
+#define EM_AGGREGATOR_PHASES 3
+
+namespace Supla {
+namespace Sensor {
+
+enum class EmMeasurement : uint8_t {
+  Voltage = 0,        // 0.01 V
+  Current = 1,        // 0.001 A
+  PowerActive = 2,    // 0.00001 W
+  PowerReactive = 3,  // 0.00001 var
+  PowerApparent = 4,  // 0.00001 VA
+};
+
+#define EM_AGGREGATOR_MEASUREMENTS 5
+
+enum class EmAggregateType : uint8_t {
+  Min,
+  Max,
+  Mean,
+};
+
+struct EmAggregate {
+  int64_t min = 0;
+  int64_t max = 0;
+  int64_t mean = 0;
+  uint16_t samples = 0;
+};
+
+/**
+ * Keeps min, max and mean of ElectricityMeter measurements per phase over
+ * reporting window. Samples are accumulated in place, so memory usage
+ * doesn't depend on the number of samples in window.
+ */
+class EmAggregator {
+ public:
+  void addSample(EmMeasurement measurement, int phase, int64_t value);
+
+  // Finishes current window. Its aggregates are returned by getAggregate()
+  // until next window is closed.
+  void closeWindow();
+
+  // Returns false if there were no samples of measurement in last window
+  bool getAggregate(EmMeasurement measurement,
+                    int phase,
+                    EmAggregate *result) const;
+
+ protected:
+  struct Accumulator {
+    int64_t min = 0;
+    int64_t max = 0;
+    int64_t sum = 0;
+    uint16_t samples = 0;
+  };
+
+  Accumulator current[EM_AGGREGATOR_MEASUREMENTS][EM_AGGREGATOR_PHASES] = {};
+  EmAggregate last[EM_AGGREGATOR_MEASUREMENTS][EM_AGGREGATOR_PHASES] = {};
+};
+
+}  // namespace Sensor
+}  // namespace Supla
+
+#endif  // SRC_SUPLA_SENSOR_EM_AGGREGATOR_H_
@@ -0,0 +1,170 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#include "em_deadband.h"
+
+using Supla::Sensor::EmDeadband;
+using Supla::Sensor::EmDeadbandField;
+
+void EmDeadband::setDeadband(EmDeadbandField field,
+                             uint32_t absolute,
+                             uint16_t relativePermille) {
+  int index = static_cast<int>(field);
+  if (index < 0 || index >= EM_DEADBAND_FIELDS) {
+    return;
+  }
+  deadbands[index].absolute = absolute;
+  deadbands[index].relativePermille = relativePermille;
+}
+
+void EmDeadband::setReportIntervalMs(uint32_t minIntervalMs,
+                                     uint32_t maxIntervalMs) {
+  minReportIntervalMs = minIntervalMs;
+  maxReportIntervalMs = maxIntervalMs;
+}
+
+uint32_t EmDeadband::getMinReportIntervalMs() const {
+  return minReportIntervalMs;
+}
+
+uint32_t EmDeadband::getMaxReportIntervalMs() const {
+  return maxReportIntervalMs;
+}
+
+bool EmDeadband::exceeds(EmDeadbandField field,
+                         int64_t reported,
+                         int64_t value) const {
+  if (value == reported) {
+    return false;
+  }
+  int index = static_cast<int>(field);
+  if (index < 0 || index >= EM_DEADBAND_FIELDS) {
+    return true;
+  }
+  const Deadband &deadband = deadbands[index];
+  int64_t diff = value > reported ? value - reported : reported - value;
+  if (diff <= deadband.absolute) {
+    return false;
+  }
+  if (deadband.relativePermille > 0) {
+    int64_t base = reported < 0 ? -reported : reported;
+    if (diff * 1000 <= base * deadband.relativePermille) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool EmDeadband::isChangeSignificant(
+    const TElectricityMeter_ExtendedValue_V3 &emValue,
+    const uint32_t *current,
+    const int64_t *powerActive,
+    const int64_t *powerReactive,
+    const int64_t *powerApparent) const {
+  if (!reportedValid) {
+    return true;
+  }
+  if (emValue.measured_values != reported.measuredValues ||
+      emValue.m_count != reported.measurementCount ||
+      emValue.phase_sequence != reported.phaseSequence ||
+      emValue.voltage_phase_angle_12 != reported.voltagePhaseAngle12 ||
+      emValue.voltage_phase_angle_13 != reported.voltagePhaseAngle13) {
+    return true;
+  }
+
+  if (exceeds(EmDeadbandField::Energy,
+              reported.fwdBalancedEnergy,
+              emValue.total_forward_active_energy_balanced) ||
+      exceeds(EmDeadbandField::Energy,
+              reported.rvrBalancedEnergy,
+              emValue.total_reverse_active_energy_balanced)) {
+    return true;
+  }
+
+  const TElectricityMeter_Measurement &m = emValue.m[0];
+  if (exceeds(EmDeadbandField::Frequency, reported.freq, m.freq)) {
+    return true;
+  }
+
+  for (int i = 0; i < EM_DEADBAND_PHASES; i++) {
+    if (exceeds(EmDeadbandField::Energy,
+                reported.fwdActEnergy[i],
+                emValue.total_forward_active_energy[i]) ||
+        exceeds(EmDeadbandField::Energy,
+                reported.rvrActEnergy[i],
+                emValue.total_reverse_active_energy[i]) ||
+        exceeds(EmDeadbandField::Energy,
+                reported.fwdReactEnergy[i],
+                emValue.total_forward_reactive_energy[i]) ||
+        exceeds(EmDeadbandField::Energy,
+                reported.rvrReactEnergy[i],
+                emValue.total_reverse_reactive_energy[i])) {
+      return true;
+    }
+    if (exceeds(EmDeadbandField::Voltage, reported.voltage[i], m.voltage[i]) ||
+        exceeds(EmDeadbandField::Current, reported.current[i], current[i]) ||
+        exceeds(EmDeadbandField::PowerActive,
+                reported.powerActive[i],
+                powerActive[i]) ||
+        exceeds(EmDeadbandField::PowerReactive,
+                reported.powerReactive[i],
+                powerReactive[i]) ||
+        exceeds(EmDeadbandField::PowerApparent,
+                reported.powerApparent[i],
+                powerApparent[i]) ||
+        exceeds(EmDeadbandField::PowerFactor,
+                reported.powerFactor[i],
+                m.power_factor[i]) ||
+        exceeds(EmDeadbandField::PhaseAngle,
+                reported.phaseAngle[i],
+                m.phase_angle[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void EmDeadband::setReported(const TElectricityMeter_ExtendedValue_V3 &emValue,
+                             const uint32_t *current,
+                             const int64_t *powerActive,
+                             const int64_t *powerReactive,
+                             const int64_t *powerApparent) {
+  const TElectricityMeter_Measurement &m = emValue.m[0];
+  for (int i = 0; i < EM_DEADBAND_PHASES; i++) {
+    reported.fwdActEnergy[i] = emValue.total_forward_active_energy[i];
+    reported.rvrActEnergy[i] = emValue.total_reverse_active_energy[i];
+    reported.fwdReactEnergy[i] = emValue.total_forward_reactive_energy[i];
+    reported.rvrReactEnergy[i] = emValue.total_reverse_reactive_energy[i];
+    reported.powerActive[i] = powerActive[i];
+    reported.powerReactive[i] = powerReactive[i];
+    reported.powerApparent[i] = powerApparent[i];
+    reported.current[i] = current[i];
+    reported.voltage[i] = m.voltage[i];
+    reported.powerFactor[i] = m.power_factor[i];
+    reported.phaseAngle[i] = m.phase_angle[i];
+  }
+  reported.fwdBalancedEnergy = emValue.total_forward_active_energy_balanced;
+  reported.rvrBalancedEnergy = emValue.total_reverse_active_energy_balanced;
+  reported.measuredValues = emValue.measured_values;
+  reported.measurementCount = emValue.m_count;
+  reported.freq = m.freq;
+  reported.voltagePhaseAngle12 = emValue.voltage_phase_angle_12;
+  reported.voltagePhaseAngle13 = emValue.voltage_phase_angle_13;
+  reported.phaseSequence = emValue.phase_sequence;
+  reportedValid = true;
+}
@@ -0,0 +1,128 @@
+/*
+ Copyright (C) AC SOFTWARE SP. Z O.O.
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*/
+
+#ifndef SRC_SUPLA_SENSOR_EM_DEADBAND_H_
+#define SRC_SUPLA_SENSOR_EM_DEADBAND_H_
+
+#include <stdint.h>
+#include <supla-common/proto.h>
+
+#define EM_DEADBAND_PHASES 3
+
+namespace Supla {
+namespace Sensor {
+
+enum class EmDeadbandField : uint8_t {
+  Energy = 0,          // 0.00001 kWh/kvarh, all energy counters
+  Voltage = 1,         // 0.01 V
+  Current = 2,         // 0.001 A
+  PowerActive = 3,     // 0.00001 W
+  PowerReactive = 4,   // 0.00001 var
+  PowerApparent = 5,   // 0.00001 VA
+  PowerFactor = 6,     // 0.001
+  PhaseAngle = 7,      // 0.1 degree
+  Frequency = 8,       // 0.01 Hz
+};
+
+#define EM_DEADBAND_FIELDS 9
+
+/**
+ * Decides if ElectricityMeter values differ enough from the last reported
+ * ones to be sent again.
+ *
+ * Change of a field is significant when it is larger than both its absolute
+ * and relative deadband. Fields without deadband are significant on any
+ * change. Change of measured values set, phase sequence or voltage phase
+ * angles between phases is always significant.
+ */
+class EmDeadband {
+ public:
+  /**
+   * Sets deadband of field.
+   *
+   * @param field
+   * @param absolute in units of field
+   * @param relativePermille in 0.1 % of last reported value
+   */
+  void setDeadband(EmDeadbandField field,
+                   uint32_t absolute,
+                   uint16_t relativePermille);
+
+  // Reports are not sent more often than min interval. Value changed within
+  // deadband is reported after max interval (0 - never).
+  void setReportIntervalMs(uint32_t minIntervalMs, uint32_t maxIntervalMs);
+  uint32_t getMinReportIntervalMs() const;
+  uint32_t getMaxReportIntervalMs() const;
+
+  // Returns true if change from reported to value is significant for field
+  bool exceeds(EmDeadbandField field, int64_t reported, int64_t value) const;
+
+  // Returns true if values differ from reported ones more than deadbands.
+  // Current and powers are passed in raw (unscaled) form.
+  bool isChangeSignificant(const TElectricityMeter_ExtendedValue_V3 &emValue,
+                           const uint32_t *current,
+                           const int64_t *powerActive,
+                           const int64_t *powerReactive,
+                           const int64_t *powerApparent) const;
+
+  // Stores values as last reported ones
+  void setReported(const TElectricityMeter_ExtendedValue_V3 &emValue,
+                   const uint32_t *current,
+                   const int64_t *powerActive,
+                   const int64_t *powerReactive,
+                   const int64_t *powerApparent);
+
+ protected:
+  struct Deadband {
+    uint32_t absolute = 0;
+    uint16_t relativePermille = 0;
+  };
+
+  struct ReportedValues {
+    uint64_t fwdActEnergy[EM_DEADBAND_PHASES] = {};
+    uint64_t rvrActEnergy[EM_DEADBAND_PHASES] = {};
+    uint64_t fwdReactEnergy[EM_DEADBAND_PHASES] = {};
+    uint64_t rvrReactEnergy[EM_DEADBAND_PHASES] = {};
+    uint64_t fwdBalancedEnergy = 0;
+    uint64_t rvrBalancedEnergy = 0;
+    int64_t powerActive[EM_DEADBAND_PHASES] = {};
+    int64_t powerReactive[EM_DEADBAND_PHASES] = {};
+    int64_t powerApparent[EM_DEADBAND_PHASES] = {};
+    uint32_t current[EM_DEADBAND_PHASES] = {};
+    int32_t measuredValues = 0;
+    int32_t measurementCount = 0;
+    uint16_t voltage[EM_DEADBAND_PHASES] = {};
+    int16_t powerFactor[EM_DEADBAND_PHASES] = {};
+    int16_t phaseAngle[EM_DEADBAND_PHASES] = {};
+    uint16_t freq = 0;
+    uint16_t voltagePhaseAngle12 = 0;
+    uint16_t voltagePhaseAngle13 = 0;
+    uint8_t phaseSequence = 0;
+  };
+
+  Deadband deadbands[EM_DEADBAND_FIELDS] = {};
+  ReportedValues reported;
+  uint32_t minReportIntervalMs = 0;
+  uint32_t maxReportIntervalMs = 0;
+  bool reportedValid = false;
+};
+
+}  // namespace Sensor
+}  // namespace Supla
+
+#endif  // SRC_SUPLA_SENSOR_EM_DEADBAND_H_
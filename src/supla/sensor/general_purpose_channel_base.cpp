@@ -35,6 +35,7 @@ using Supla::Sensor::GeneralPurposeChannelBase;
 GeneralPurposeChannelBase::GeneralPurposeChannelBase(
     MeasurementDriver *driver, bool addMemoryVariableDriver)
     : driver(driver) {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setFlag(SUPLA_CHANNEL_FLAG_RUNTIME_CHANNEL_CONFIG_UPDATE);
   usedConfigTypes.set(SUPLA_CONFIG_TYPE_DEFAULT);
 
@@ -146,7 +147,7 @@ void GeneralPurposeChannelBase::onLoadConfig(SuplaDeviceClass *sdc) {
     setUnitBeforeValue(unit, false);
     getDefaultUnitAfterValue(unit);
     setUnitAfterValue(unit, false);
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -330,7 +331,7 @@ void GeneralPurposeChannelBase::setRefreshIntervalMs(int32_t intervalMs,
   commonConfig.refreshIntervalMs = intervalMs;
   setChannelRefreshIntervalMs(intervalMs);
   if (static_cast<uint16_t>(intervalMs) != oldIntervalMs && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -340,7 +341,7 @@ void GeneralPurposeChannelBase::setValueDivider(int32_t divider, bool local) {
   auto oldDivider = getValueDivider();
   commonConfig.divider = divider;
   if (divider != oldDivider && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -351,7 +352,7 @@ void GeneralPurposeChannelBase::setValueMultiplier(int32_t multiplier,
   auto oldMultiplier = getValueMultiplier();
   commonConfig.multiplier = multiplier;
   if (multiplier != oldMultiplier && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -361,7 +362,7 @@ void GeneralPurposeChannelBase::setValueAdded(int64_t added, bool local) {
   auto oldAdded = getValueAdded();
   commonConfig.added = added;
   if (added != oldAdded && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -372,7 +373,7 @@ void GeneralPurposeChannelBase::setValuePrecision(uint8_t precision,
   auto oldPrecision = getValuePrecision();
   commonConfig.precision = precision;
   if (precision != oldPrecision && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -389,7 +390,7 @@ void GeneralPurposeChannelBase::setUnitBeforeValue(const char *unit,
             SUPLA_GENERAL_PURPOSE_UNIT_SIZE - 1);
     commonConfig.unitBeforeValue[SUPLA_GENERAL_PURPOSE_UNIT_SIZE - 1] = '\0';
     if (local) {
-      channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+      setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
       saveConfig();
       saveConfigChangeFlag();
     }
@@ -406,7 +407,7 @@ void GeneralPurposeChannelBase::setUnitAfterValue(const char *unit,
         commonConfig.unitAfterValue, unit, SUPLA_GENERAL_PURPOSE_UNIT_SIZE - 1);
     commonConfig.unitAfterValue[SUPLA_GENERAL_PURPOSE_UNIT_SIZE - 1] = '\0';
     if (local) {
-      channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+      setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
       saveConfig();
       saveConfigChangeFlag();
     }
@@ -418,7 +419,7 @@ void GeneralPurposeChannelBase::setNoSpaceBeforeValue(
   auto oldNoSpaceBeforeValue = getNoSpaceBeforeValue();
   commonConfig.noSpaceBeforeValue = noSpaceBeforeValue;
   if (noSpaceBeforeValue != oldNoSpaceBeforeValue && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -429,7 +430,7 @@ void GeneralPurposeChannelBase::setNoSpaceAfterValue(uint8_t noSpaceAfterValue,
   auto oldNoSpaceAfterValue = getNoSpaceAfterValue();
   commonConfig.noSpaceAfterValue = noSpaceAfterValue;
   if (noSpaceAfterValue != oldNoSpaceAfterValue && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -440,7 +441,7 @@ void GeneralPurposeChannelBase::setKeepHistory(uint8_t keepHistory,
   auto oldKeepHistory = getKeepHistory();
   commonConfig.keepHistory = keepHistory;
   if (keepHistory != oldKeepHistory && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -450,7 +451,7 @@ void GeneralPurposeChannelBase::setChartType(uint8_t chartType, bool local) {
   auto oldChartType = getChartType();
   commonConfig.chartType = chartType;
   if (chartType != oldChartType && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveConfig();
     saveConfigChangeFlag();
   }
@@ -499,7 +500,7 @@ Supla::ApplyConfigResult GeneralPurposeChannelBase::applyChannelConfig(
               defaultUnitAfterValue,
               SUPLA_GENERAL_PURPOSE_UNIT_SIZE)) {
     if (local) {
-      channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+      setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
       saveConfigChangeFlag();
     }
     return Supla::ApplyConfigResult::SetChannelConfigNeeded;
@@ -107,7 +107,7 @@ Supla::ApplyConfigResult GeneralPurposeMeter::applyChannelConfig(
               SUPLA_GENERAL_PURPOSE_UNIT_SIZE)) {
     SUPLA_LOG_INFO("GPM[%d]: meter config changed", getChannelNumber());
     if (local) {
-      channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+      setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
       saveConfigChangeFlag();
     }
 
@@ -177,7 +177,7 @@ void GeneralPurposeMeter::setCounterType(uint8_t counterType, bool local) {
   auto oldCounterType = getCounterType();
   meterSpecificConfig.counterType = counterType;
   if (counterType != oldCounterType && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveMeterSpecificConfig();
     saveConfigChangeFlag();
   }
@@ -188,7 +188,7 @@ void GeneralPurposeMeter::setIncludeValueAddedInHistory(
   auto oldIncludeValueAddedInHistory = getIncludeValueAddedInHistory();
   meterSpecificConfig.includeValueAddedInHistory = includeValueAddedInHistory;
   if (includeValueAddedInHistory != oldIncludeValueAddedInHistory && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveMeterSpecificConfig();
     saveConfigChangeFlag();
   }
@@ -199,7 +199,7 @@ void GeneralPurposeMeter::setFillMissingData(uint8_t fillMissingData,
   auto oldFillMissingData = getFillMissingData();
   meterSpecificConfig.fillMissingData = fillMissingData;
   if (fillMissingData != oldFillMissingData && local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
     saveMeterSpecificConfig();
     saveConfigChangeFlag();
   }
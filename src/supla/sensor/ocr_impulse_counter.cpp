@@ -41,6 +41,8 @@
 using Supla::Sensor::OcrImpulseCounter;
 
 OcrImpulseCounter::OcrImpulseCounter() {
+  // photos are taken in iterateConnected()
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, true);
   channel.setFlag(SUPLA_CHANNEL_FLAG_OCR);
   addAvailableLightingMode(OCR_LIGHTING_MODE_OFF | OCR_LIGHTING_MODE_ALWAYS_ON |
                            OCR_LIGHTING_MODE_AUTO);
@@ -29,6 +29,7 @@ namespace Sensor {
 class Pressure : public ChannelElement {
  public:
   Pressure() : lastReadTime(0) {
+    setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
     channel.setType(SUPLA_CHANNELTYPE_PRESSURESENSOR);
     channel.setDefaultFunction(SUPLA_CHANNELFNC_PRESSURESENSOR);
     channel.setNewValue(PRESSURE_NOT_AVAILABLE);
@@ -29,6 +29,7 @@ namespace Sensor {
 class Rain : public ChannelElement {
  public:
   Rain() : lastReadTime(0) {
+    setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
     channel.setType(SUPLA_CHANNELTYPE_RAINSENSOR);
     channel.setDefaultFunction(SUPLA_CHANNELFNC_RAINSENSOR);
     channel.setNewValue(RAIN_NOT_AVAILABLE);
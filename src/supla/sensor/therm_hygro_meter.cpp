@@ -25,6 +25,7 @@
 #include <stdio.h>
 
 Supla::Sensor::ThermHygroMeter::ThermHygroMeter() {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_HUMIDITYANDTEMPSENSOR);
   channel.setDefaultFunction(SUPLA_CHANNELFNC_HUMIDITYANDTEMPERATURE);
   channel.setFlag(SUPLA_CHANNEL_FLAG_RUNTIME_CHANNEL_CONFIG_UPDATE);
@@ -251,9 +252,9 @@ void Supla::Sensor::ThermHygroMeter::setHumidityCorrection(int32_t correction) {
 void Supla::Sensor::ThermHygroMeter::applyCorrectionsAndStoreIt(
     int32_t temperatureCorrection, int32_t humidityCorrection, bool local) {
   if (local) {
-    channelConfigState = Supla::ChannelConfigState::LocalChangePending;
+    setChannelConfigState(Supla::ChannelConfigState::LocalChangePending);
   } else {
-    channelConfigState = Supla::ChannelConfigState::None;
+    setChannelConfigState(Supla::ChannelConfigState::None);
   }
 
   setTemperatureCorrection(temperatureCorrection);
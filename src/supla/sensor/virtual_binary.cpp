@@ -24,10 +24,12 @@ namespace Sensor {
 
 VirtualBinary::VirtualBinary(bool keepStateInStorage)
     : keepStateInStorage(keepStateInStorage) {
+  enableStateChangeTracking();
 }
 
 void VirtualBinary::setKeepStateInStorage(bool keepStateInStorage) {
   this->keepStateInStorage = keepStateInStorage;
+  markStateChanged();
 }
 
 bool VirtualBinary::getValue() {
@@ -73,14 +75,17 @@ void VirtualBinary::handleAction(int event, int action) {
 
 void VirtualBinary::set() {
   state = true;
+  markStateChanged();
 }
 
 void VirtualBinary::clear() {
   state = false;
+  markStateChanged();
 }
 
 void VirtualBinary::toggle() {
   state = !state;
+  markStateChanged();
 }
 
 };  // namespace Sensor
@@ -28,11 +28,13 @@
 using Supla::Sensor::VirtualImpulseCounter;
 
 VirtualImpulseCounter::VirtualImpulseCounter() {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_IMPULSE_COUNTER);
   channel.setFlag(SUPLA_CHANNEL_FLAG_CALCFG_RESET_COUNTERS);
   channel.setFlag(SUPLA_CHANNEL_FLAG_RUNTIME_CHANNEL_CONFIG_UPDATE);
   channel.setDefaultFunction(SUPLA_CHANNELFNC_IC_WATER_METER);
   usedConfigTypes.set(SUPLA_CONFIG_TYPE_DEFAULT);
+  enableStateChangeTracking();
 }
 
 void VirtualImpulseCounter::onInit() {
@@ -55,6 +57,7 @@ void VirtualImpulseCounter::onLoadState() {
 
 void VirtualImpulseCounter::setCounter(uint64_t value) {
   counter = value;
+  markStateChanged();
   channel.setNewValue(value);
   SUPLA_LOG_DEBUG(
             "VirtualImpulseCounter[%d] - set counter to %d",
@@ -64,6 +67,7 @@ void VirtualImpulseCounter::setCounter(uint64_t value) {
 
 void VirtualImpulseCounter::incCounter() {
   counter++;
+  markStateChanged();
   runAction(Supla::ON_IMPULSE);
 }
 
@@ -23,6 +23,7 @@
 using Supla::Sensor::Weight;
 
 Weight::Weight() {
+  setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
   channel.setType(SUPLA_CHANNELTYPE_WEIGHTSENSOR);
   channel.setDefaultFunction(SUPLA_CHANNELFNC_WEIGHTSENSOR);
   channel.setNewValue(WEIGHT_NOT_AVAILABLE);
@@ -29,6 +29,7 @@ namespace Sensor {
 class Wind : public ChannelElement {
  public:
   Wind() {
+    setIterateConnectedPolling(ELEMENT_POLLING_ITERATE_CONNECTED, false);
     channel.setType(SUPLA_CHANNELTYPE_WINDSENSOR);
     channel.setDefaultFunction(SUPLA_CHANNELFNC_WINDSENSOR);
     channel.setNewValue(WIND_NOT_AVAILABLE);
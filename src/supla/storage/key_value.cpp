@@ -23,6 +23,21 @@
 #include <supla/log_wrapper.h>
 #include <supla/tools.h>
 
+namespace {
+constexpr uint16_t IndexMinBucketCount = 16;
+constexpr uint16_t IndexMaxBucketCount = 4096;
+
+// FNV-1a over key (up to SUPLA_STORAGE_KEY_SIZE characters)
+uint32_t calculateKeyHash(const char* key) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < SUPLA_STORAGE_KEY_SIZE && key[i] != '\0'; i++) {
+    hash ^= static_cast<uint8_t>(key[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+}  // namespace
+
 namespace Supla {
 KeyValue::~KeyValue() {
   removeAllMemory();
@@ -35,6 +50,63 @@ void KeyValue::removeAllMemory() {
     delete element;
     element = first;
   }
+  clearIndex();
+}
+
+void KeyValue::clearIndex() {
+  if (indexBuckets) {
+    delete[] indexBuckets;
+    indexBuckets = nullptr;
+  }
+  indexBucketCount = 0;
+  indexElementCount = 0;
+}
+
+void KeyValue::resizeIndex(uint16_t newBucketCount) {
+  auto newBuckets = new KeyValueElement*[newBucketCount]();
+  for (int i = 0; i < indexBucketCount; i++) {
+    auto element = indexBuckets[i];
+    while (element) {
+      auto nextElement = element->nextInBucket;
+      auto &bucket = newBuckets[element->keyHash & (newBucketCount - 1)];
+      element->nextInBucket = bucket;
+      bucket = element;
+      element = nextElement;
+    }
+  }
+  delete[] indexBuckets;
+  indexBuckets = newBuckets;
+  indexBucketCount = newBucketCount;
+}
+
+void KeyValue::addToIndex(KeyValueElement* element) {
+  if (indexBucketCount == 0) {
+    resizeIndex(IndexMinBucketCount);
+  } else if (indexElementCount >= indexBucketCount &&
+             indexBucketCount < IndexMaxBucketCount) {
+    resizeIndex(indexBucketCount * 2);
+  }
+  element->keyHash = calculateKeyHash(element->key);
+  auto &bucket = indexBuckets[element->keyHash & (indexBucketCount - 1)];
+  element->nextInBucket = bucket;
+  bucket = element;
+  indexElementCount++;
+}
+
+void KeyValue::removeFromIndex(KeyValueElement* element) {
+  if (indexBucketCount == 0) {
+    return;
+  }
+  auto ptr = &indexBuckets[element->keyHash & (indexBucketCount - 1)];
+  while (*ptr) {
+    if (*ptr == element) {
+      *ptr = element->nextInBucket;
+      element->nextInBucket = nullptr;
+      indexElementCount--;
+      return;
+    }
+    ptr = &(*ptr)->nextInBucket;
+  }
 }
 
 void KeyValue::removeAll() {
@@ -66,6 +138,7 @@ bool KeyValue::initFromMemory(uint8_t* input, size_t inputSize) {
   }
 
   auto endPtr = input + inputSize;
+  KeyValueElement* last = nullptr;
   while (input + SUPLA_STORAGE_KEY_SIZE + 1 + 2 < endPtr) {
     char key[SUPLA_STORAGE_KEY_SIZE + 1] = {};
     memcpy(key, input, SUPLA_STORAGE_KEY_SIZE);
@@ -167,8 +240,10 @@ bool KeyValue::initFromMemory(uint8_t* input, size_t inputSize) {
     if (!first) {
       first = element;
     } else {
-      first->add(element);
+      last->setNext(element);
     }
+    last = element;
+    addToIndex(element);
   }
 
   if (input < endPtr) {
@@ -195,12 +270,16 @@ size_t KeyValue::serializeToMemory(uint8_t* output, size_t outputMaxSize) {
 }
 
 KeyValueElement* KeyValue::find(const char* key) {
-  auto element = first;
+  if (indexBucketCount == 0 || key == nullptr) {
+    return nullptr;
+  }
+  auto hash = calculateKeyHash(key);
+  auto element = indexBuckets[hash & (indexBucketCount - 1)];
   while (element) {
-    if (element->isKeyEqual(key)) {
+    if (element->keyHash == hash && element->isKeyEqual(key)) {
       return element;
     }
-    element = element->getNext();
+    element = element->nextInBucket;
   }
   return nullptr;
 }
@@ -211,6 +290,7 @@ KeyValueElement* KeyValue::findOrCreate(const char* key) {
     element = new KeyValueElement(key);
     element->add(first);
     first = element;
+    addToIndex(element);
   }
   return element;
 }
@@ -608,6 +688,7 @@ bool KeyValue::eraseKey(const char* key) {
       previous = previous->getNext();
     }
   }
+  removeFromIndex(elementToDelete);
   delete elementToDelete;
   return true;
 }
@@ -63,6 +63,16 @@ class KeyValue : public Config {
   KeyValueElement* find(const char* key);
   KeyValueElement* findOrCreate(const char* key);
   KeyValueElement* first = nullptr;
+
+  // Hash index over keys of all elements from "first" list. It is used only
+  // for lookups, so list order (and serialization format) is not changed.
+  void addToIndex(KeyValueElement* element);
+  void removeFromIndex(KeyValueElement* element);
+  void resizeIndex(uint16_t newBucketCount);
+  void clearIndex();
+  KeyValueElement** indexBuckets = nullptr;
+  uint16_t indexBucketCount = 0;
+  uint16_t indexElementCount = 0;
 };
 
 enum DataType {
@@ -106,7 +116,10 @@ class KeyValueElement {
   bool setUInt32(const uint32_t value);
 
  protected:
+  friend class KeyValue;
   KeyValueElement* next = nullptr;
+  KeyValueElement* nextInBucket = nullptr;
+  uint32_t keyHash = 0;
   char key[SUPLA_STORAGE_KEY_SIZE] = {};
   enum DataType dataType = DATA_TYPE_NOT_SET;
   unsigned int size = 0;  // set only for blob and string
@@ -17,6 +17,7 @@
    */
 
 #include <supla/crc16.h>
+#include <supla/element.h>
 #include <supla/log_wrapper.h>
 
 #include "simple_state.h"
@@ -29,7 +30,9 @@ SimpleState::SimpleState(Storage *storage, uint32_t offset)
       sectionOffset(offset) {
 }
 
-SimpleState::~SimpleState() {}
+SimpleState::~SimpleState() {
+  delete[] segments;
+}
 
 void SimpleState::initSectionPreamble(Supla::SectionPreamble *preamble) {
   if (preamble) {
@@ -89,6 +92,7 @@ bool SimpleState::initFromStorage() {
   }
 
   crc = 0;
+  clearSegments();
 
   return true;
 }
@@ -99,6 +103,7 @@ void SimpleState::deleteAll() {
   elementStateCrcCValid = false;
   storedCrc = 0;
   crc = 0;
+  clearSegments();
 }
 
 bool SimpleState::prepareSaveState() {
@@ -106,6 +111,24 @@ bool SimpleState::prepareSaveState() {
   stateSectionNewSize = 0;
   currentStateOffset = elementStateOffset;
   crc = 0xFFFF;
+  segmentIndex = 0;
+  if (segmentsInvalid) {
+    segmentsCount = 0;
+    segmentsInvalid = false;
+  }
+  if (segments == nullptr) {
+    int count = 0;
+    for (auto element = Supla::Element::begin(); element != nullptr;
+         element = element->next()) {
+      count++;
+    }
+    if (count > 0) {
+      segments = new ElementSegment[count];
+      if (segments != nullptr) {
+        segmentsCapacity = count;
+      }
+    }
+  }
   return true;
 }
 
@@ -153,6 +176,7 @@ bool SimpleState::writeState(const unsigned char *buf, int size) {
         "Storage: rewriting element state section. All data will be lost.");
     elementStateSize = 0;
     elementStateOffset = 0;
+    clearSegments();
     return false;
   }
 
@@ -188,9 +212,9 @@ bool SimpleState::writeState(const unsigned char *buf, int size) {
         storageStartingOffset, (unsigned char *)&preamble, sizeof(preamble));
   }
    */
-  for (int i = 0; i < size; i++) {
-    crc = crc16_update(crc, buf[i]);
-  }
+  crc = crc16_update(crc, buf, size);
+  segmentCrc = crc16_update(segmentCrc, buf, size);
+  segmentSize += size;
 
   currentStateOffset += updateStorage(currentStateOffset, buf, size);
 
@@ -214,6 +238,7 @@ bool SimpleState::finalizeSizeCheck() {
         "configuration");
     elementStateOffset = 0;
     elementStateSize = 0;
+    clearSegments();
     return false;
   }
   return true;
@@ -222,3 +247,59 @@ bool SimpleState::finalizeSizeCheck() {
 bool SimpleState::finalizeLoadState() {
   return true;
 }
+
+bool SimpleState::beginElementState(Supla::Element *element) {
+  segmentSize = 0;
+  segmentCrc = 0;
+  if (dryRun || element == nullptr || element->isStateChanged() ||
+      segmentsInvalid || segmentIndex >= segmentsCount ||
+      elementStateOffset == 0) {
+    return true;
+  }
+
+  const auto &segment = segments[segmentIndex];
+  if (segment.element != element || segment.offset != currentStateOffset) {
+    return true;
+  }
+
+  // Element's state is already stored at current offset. CRC is linear, so
+  // CRC of section is updated with zeros and combined with segment's CRC.
+  for (uint16_t i = 0; i < segment.size; i++) {
+    crc = crc16_update(crc, 0);
+  }
+  crc ^= segment.crc;
+  currentStateOffset += segment.size;
+  stateSectionNewSize += segment.size;
+  segmentIndex++;
+  return false;
+}
+
+void SimpleState::endElementState(Supla::Element *element) {
+  if (dryRun || element == nullptr) {
+    return;
+  }
+
+  if (!segmentsInvalid && segmentIndex < segmentsCapacity) {
+    auto &segment = segments[segmentIndex];
+    if (segmentSize <= UINT16_MAX &&
+        currentStateOffset >= elementStateOffset + segmentSize) {
+      segment.element = element;
+      segment.offset = currentStateOffset - segmentSize;
+      segment.size = static_cast<uint16_t>(segmentSize);
+      segment.crc = segmentCrc;
+    } else {
+      segment.element = nullptr;
+    }
+    if (segmentIndex >= segmentsCount) {
+      segmentsCount = segmentIndex + 1;
+    }
+  }
+  segmentIndex++;
+  element->clearStateChanged();
+}
+
+void SimpleState::clearSegments() {
+  segmentsCount = 0;
+  segmentIndex = 0;
+  segmentsInvalid = true;
+}
@@ -43,8 +43,22 @@ class SimpleState : public StateStorageInterface {
   bool finalizeSaveState() override;
   bool finalizeSizeCheck() override;
   bool finalizeLoadState() override;
+  bool beginElementState(Supla::Element *element) override;
+  void endElementState(Supla::Element *element) override;
 
  private:
+  // Location of element's state saved in last save. CRC is calculated with
+  // 0 as initial value, so it can be combined with section CRC without
+  // reading data from storage.
+  struct ElementSegment {
+    const Supla::Element *element = nullptr;
+    uint32_t offset = 0;
+    uint16_t size = 0;
+    uint16_t crc = 0;
+  };
+
+  void clearSegments();
+
   uint32_t sectionOffset = 0;
   uint32_t elementStateOffset = 0;
   uint32_t elementStateSize = 0;
@@ -54,6 +68,14 @@ class SimpleState : public StateStorageInterface {
   uint16_t crc = 0;   // value calculated on each save/read
   bool elementStateCrcCValid = false;
   bool dryRun = false;
+
+  ElementSegment *segments = nullptr;
+  int segmentsCapacity = 0;
+  int segmentsCount = 0;
+  int segmentIndex = 0;
+  bool segmentsInvalid = false;
+  uint32_t segmentSize = 0;
+  uint16_t segmentCrc = 0;
 };
 
 }  // namespace Supla
@@ -155,6 +155,15 @@ void StateStorageInterface::eraseSector(unsigned int address, int size) {
 void StateStorageInterface::notifyUpdate() {
 }
 
+bool StateStorageInterface::beginElementState(Supla::Element *element) {
+  (void)(element);
+  return true;
+}
+
+void StateStorageInterface::endElementState(Supla::Element *element) {
+  (void)(element);
+}
+
 uint16_t StateStorageInterface::getSizeValue(uint16_t availableSize) {
   (void)(availableSize);
   return 0;
@@ -24,6 +24,7 @@
 namespace Supla {
 
 class Storage;
+class Element;
 struct SectionPreamble;
 
 class StateStorageInterface {
@@ -43,6 +44,12 @@ class StateStorageInterface {
   virtual bool finalizeSaveState() = 0;
   virtual bool finalizeSizeCheck() = 0;
   virtual bool finalizeLoadState() = 0;
+  // Called before element's state is written. Returns false when element's
+  // state didn't change and state saved previously was kept, so element's
+  // onSaveState() is not called.
+  virtual bool beginElementState(Supla::Element *element);
+  // Called after element's state was written
+  virtual void endElementState(Supla::Element *element);
   virtual void notifyUpdate();
 
  protected:
@@ -367,9 +367,7 @@ bool StateWearLevelingByte::writeState(const unsigned char *buf, int size) {
     return true;
   }
 
-  for (int i = 0; i < size; i++) {
-    crc = crc16_update(crc, buf[i]);
-  }
+  crc = crc16_update(crc, buf, size);
 
   if (stateSlotNewSize <= elementStateSize) {
     currentStateOffset += updateStorage(currentStateOffset, buf, size);
@@ -498,9 +498,7 @@ bool StateWearLevelingSector::writeState(const unsigned char *buf, int size) {
     return false;
   }
 
-  for (int i = 0; i < size; i++) {
-    crc = crc16_update(crc, buf[i]);
-  }
+  crc = crc16_update(crc, buf, size);
 
   if (stateSlotNewSize <= elementStateSize && elementStateSize != 0xFFFF) {
     memcpy(dataBuffer + currentStateBufferOffset, buf, size);
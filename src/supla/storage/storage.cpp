@@ -235,20 +235,34 @@ int Storage::updateStorage(unsigned int offset,
     return 0;
   }
 
-  unsigned char *currentData = new unsigned char[size];
-  readStorage(offset, currentData, size, false);
-
-  if (memcmp(currentData, buf, size)) {
-    delete[] currentData;
+  if (!isStorageDataEqual(offset, buf, size)) {
     if (stateStorage != nullptr) {
       stateStorage->notifyUpdate();
     }
     return writeStorage(offset, buf, size);
   }
-  delete[] currentData;
   return size;
 }
 
+bool Storage::isStorageDataEqual(unsigned int offset,
+                                 const unsigned char *buf,
+                                 int size) {
+  unsigned char currentData[32] = {};
+  while (size > 0) {
+    int chunkSize =
+        size < static_cast<int>(sizeof(currentData)) ? size
+                                                      : sizeof(currentData);
+    if (readStorage(offset, currentData, chunkSize, false) != chunkSize ||
+        memcmp(currentData, buf, chunkSize) != 0) {
+      return false;
+    }
+    offset += chunkSize;
+    buf += chunkSize;
+    size -= chunkSize;
+  }
+  return true;
+}
+
 void Storage::setStateSavePeriod(uint32_t periodMs) {
   if (periodMs < 500) {
     saveStatePeriod = 500;
@@ -356,10 +370,7 @@ bool Storage::readSection(int sectionId, unsigned char *data, int size) {
           uint16_t readCrc = 0;
           readStorage(offset + size,
               reinterpret_cast<unsigned char *>(&readCrc), sizeof(readCrc));
-          uint16_t calcCrc = 0xFFFF;
-          for (int i = 0; i < size; i++) {
-            calcCrc = crc16_update(calcCrc, buffer[i]);
-          }
+          uint16_t calcCrc = calculateCrc16(buffer, size);
           if (readCrc != calcCrc) {
             SUPLA_LOG_WARNING(
                 "Storage: special section crc check failed %d != %d",
@@ -414,10 +425,7 @@ bool Storage::writeSection(int sectionId, const unsigned char *data, int size) {
             return false;
           }
           if (ptr->addCrc) {
-            uint16_t calcCrc = 0xFFFF;
-            for (int i = 0; i < size; i++) {
-              calcCrc = crc16_update(calcCrc, data[i]);
-            }
+            uint16_t calcCrc = calculateCrc16(data, size);
             writeStorage(offset + size,
                 reinterpret_cast<unsigned char *>(&calcCrc), sizeof(calcCrc));
           }
@@ -552,25 +560,26 @@ void Storage::WriteStateStorage() {
 }
 
 void Storage::WriteElementsState() {
-  if (Instance()->isAddChannelNumbersEnabled()) {
-    for (auto element = Supla::Element::begin(); element != nullptr;
-        element = element->next()) {
-      auto channelNumber = element->getChannelNumber();
-      if (channelNumber >= 0 && channelNumber <= 255) {
+  auto stateStorage = Instance()->stateStorage;
+  bool addChannelNumbers = Instance()->isAddChannelNumbersEnabled();
+  for (auto element = Supla::Element::begin(); element != nullptr;
+      element = element->next()) {
+    auto channelNumber = element->getChannelNumber();
+    if (addChannelNumbers && (channelNumber < 0 || channelNumber > 255)) {
+      delay(0);
+      continue;
+    }
+    if (stateStorage->beginElementState(element)) {
+      if (addChannelNumbers) {
         uint8_t channelNumberByte = static_cast<uint8_t>(channelNumber);
         Supla::Storage::WriteState(
             reinterpret_cast<const unsigned char *>(&channelNumberByte),
             sizeof(channelNumberByte));
-        element->onSaveState();
       }
-      delay(0);
-    }
-  } else {
-    for (auto element = Supla::Element::begin(); element != nullptr;
-        element = element->next()) {
       element->onSaveState();
-      delay(0);
+      stateStorage->endElementState(element);
     }
+    delay(0);
   }
 }
 
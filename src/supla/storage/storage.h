@@ -123,6 +123,12 @@ class Storage {
   virtual void commit() = 0;
 
   virtual int updateStorage(unsigned int, const unsigned char *, int);
+  // Returns true if storage at given address contains the same data as buf.
+  // Default implementation reads storage in small chunks to a stack buffer.
+  // Storages which keep data in RAM can compare it directly.
+  virtual bool isStorageDataEqual(unsigned int address,
+                                  const unsigned char *buf,
+                                  int size);
 
   virtual bool saveStateAllowed(uint32_t);
   virtual void scheduleSave(uint32_t delayMsMax, uint32_t delayMsMin);